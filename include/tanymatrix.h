@@ -0,0 +1,263 @@
+// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Матрица с автоматическим выбором формата хранения
+//
+// При создании измеряется доля ненулевых элементов (плотность) и
+// заполненность блоков, и матрица хранится в том формате, ядра которого
+// для неё быстрее:
+//  - плотный (GEMM, GEMV), если плотность не меньше dense_density;
+//  - BSR с блоками 4 x 4 или 3 x 3, если ненулевые блоки заполнены не
+//    меньше чем на block_fill (значение хранится один раз на блок, а не
+//    вместе с номером столбца, поэтому BSR выгоднее CSR при заполнении
+//    выше 2/3);
+//  - CSR в остальных случаях.
+// Пороги задаются структурой TFormatPolicy, выбранный формат и
+// измеренные величины доступны через decision().
+
+#ifndef __TAnyMatrix_H__
+#define __TAnyMatrix_H__
+
+#include <memory>
+#include "tcsrmatrix.h"
+#include "tbsrmatrix.h"
+
+enum class TMatrixFormat { Dense, CSR, BSR3, BSR4 };
+
+inline const char* format_name(TMatrixFormat f)
+{
+    switch (f) {
+    case TMatrixFormat::Dense: return "dense";
+    case TMatrixFormat::CSR: return "csr";
+    case TMatrixFormat::BSR3: return "bsr3";
+    case TMatrixFormat::BSR4: return "bsr4";
+    }
+    return "unknown";
+}
+
+// Пороги выбора формата
+struct TFormatPolicy
+{
+    double dense_density = 0.25;  // доля ненулевых, начиная с которой матрица плотная
+    double block_fill = 0.7;      // заполненность блоков, начиная с которой берётся BSR
+};
+
+// Результат выбора: формат и измеренные величины
+struct TFormatDecision
+{
+    TMatrixFormat format;
+    double density;     // доля ненулевых элементов
+    double fill3;       // заполненность блоков 3 x 3 (0, если размер не кратен 3)
+    double fill4;       // то же для 4 x 4
+
+    friend ostream& operator<<(ostream& ostr, const TFormatDecision& d)
+    {
+        return ostr << format_name(d.format) << " (density " << d.density
+                    << ", fill3 " << d.fill3 << ", fill4 " << d.fill4 << ')';
+    }
+};
+
+template<typename T>
+class TAnyMatrix
+{
+    size_t nrows, ncols;
+    TFormatPolicy pol;
+    TFormatDecision dec;
+    // занят ровно один указатель - тот, что соответствует dec.format
+    std::unique_ptr<TDynamicMatrix<T>> pDense;
+    std::unique_ptr<TCSRMatrix<T>> pCSR;
+    std::unique_ptr<TBSRMatrix<T, 3>> pBSR3;
+    std::unique_ptr<TBSRMatrix<T, 4>> pBSR4;
+
+    static double block_fill(const TCSRMatrix<T>& m, size_t B)
+    {
+        if (m.rows() % B != 0 || m.cols() % B != 0 || m.nonzeros() == 0)
+            return 0.0;
+        const size_t blocks = kernels::csr_block_count(m.rows(), m.cols(), m.row_ptr(), m.col_index(), B);
+        return double(m.nonzeros()) / double(blocks * B * B);
+    }
+
+    // выбор среди разреженных форматов
+    void choose_sparse(TCSRMatrix<T>&& m)
+    {
+        dec.fill3 = block_fill(m, 3);
+        dec.fill4 = block_fill(m, 4);
+        if (dec.fill4 >= pol.block_fill && dec.fill4 >= dec.fill3) {
+            dec.format = TMatrixFormat::BSR4;
+            pBSR4.reset(new TBSRMatrix<T, 4>(m));
+        }
+        else if (dec.fill3 >= pol.block_fill) {
+            dec.format = TMatrixFormat::BSR3;
+            pBSR3.reset(new TBSRMatrix<T, 3>(m));
+        }
+        else {
+            dec.format = TMatrixFormat::CSR;
+            pCSR.reset(new TCSRMatrix<T>(std::move(m)));
+        }
+    }
+
+    void choose(TCSRMatrix<T>&& m)
+    {
+        dec.density = m.density();
+        dec.fill3 = dec.fill4 = 0.0;
+        if (dec.density >= pol.dense_density && nrows == ncols && nrows <= MAX_MATRIX_SIZE) {
+            dec.format = TMatrixFormat::Dense;
+            pDense.reset(new TDynamicMatrix<T>(m.dense()));
+        }
+        else
+            choose_sparse(std::move(m));
+    }
+
+    // состояние перемещённого объекта: 0 x 0, плотный формат без данных
+    void clear() noexcept
+    {
+        nrows = ncols = 0;
+        dec.format = TMatrixFormat::Dense;
+        dec.density = dec.fill3 = dec.fill4 = 0.0;
+    }
+    void check_not_empty() const
+    {
+        if (nrows == 0) throw logic_error("matrix is empty");
+    }
+public:
+    typedef T value_type;
+
+    template<typename A>
+    explicit TAnyMatrix(const TDynamicMatrix<T, A>& m, const TFormatPolicy& policy = TFormatPolicy())
+        : nrows(m.size()), ncols(m.size()), pol(policy)
+    {
+        const size_t n = m.size();
+        size_t nnz = 0;
+        for (size_t k = 0; k < n * n; k++)
+            nnz += m.data()[k] != T();
+        dec.density = double(nnz) / (double(n) * double(n));
+        dec.fill3 = dec.fill4 = 0.0;
+        if (dec.density >= pol.dense_density) {
+            dec.format = TMatrixFormat::Dense;
+            pDense.reset(new TDynamicMatrix<T>(m));
+        }
+        else
+            choose_sparse(TCSRMatrix<T>(m));
+    }
+    explicit TAnyMatrix(const TCOOBuilder<T>& b, const TFormatPolicy& policy = TFormatPolicy())
+        : nrows(b.rows()), ncols(b.cols()), pol(policy)
+    {
+        choose(TCSRMatrix<T>(b));
+    }
+    explicit TAnyMatrix(TCSRMatrix<T> m, const TFormatPolicy& policy = TFormatPolicy())
+        : nrows(m.rows()), ncols(m.cols()), pol(policy)
+    {
+        choose(std::move(m));
+    }
+    TAnyMatrix(const TAnyMatrix& m) : nrows(m.nrows), ncols(m.ncols), pol(m.pol), dec(m.dec)
+    {
+        if (m.pDense) pDense.reset(new TDynamicMatrix<T>(*m.pDense));
+        if (m.pCSR) pCSR.reset(new TCSRMatrix<T>(*m.pCSR));
+        if (m.pBSR3) pBSR3.reset(new TBSRMatrix<T, 3>(*m.pBSR3));
+        if (m.pBSR4) pBSR4.reset(new TBSRMatrix<T, 4>(*m.pBSR4));
+    }
+    TAnyMatrix(TAnyMatrix&& m) noexcept
+        : nrows(m.nrows), ncols(m.ncols), pol(m.pol), dec(m.dec), pDense(std::move(m.pDense)),
+          pCSR(std::move(m.pCSR)), pBSR3(std::move(m.pBSR3)), pBSR4(std::move(m.pBSR4))
+    {
+        m.clear();
+    }
+    TAnyMatrix& operator=(const TAnyMatrix& m)
+    {
+        TAnyMatrix tmp(m);
+        swap(*this, tmp);
+        return *this;
+    }
+    TAnyMatrix& operator=(TAnyMatrix&& m) noexcept
+    {
+        TAnyMatrix tmp(std::move(m));
+        swap(*this, tmp);
+        return *this;
+    }
+
+    size_t rows() const noexcept { return nrows; }
+    size_t cols() const noexcept { return ncols; }
+    // пуста только матрица, из которой перемещены данные
+    bool empty() const noexcept { return nrows == 0; }
+    TMatrixFormat format() const noexcept { return dec.format; }
+    const TFormatPolicy& policy() const noexcept { return pol; }
+    const TFormatDecision& decision() const noexcept { return dec; }
+
+    // доступ к выбранному представлению; nullptr для остальных форматов
+    const TDynamicMatrix<T>* as_dense() const noexcept { return pDense.get(); }
+    const TCSRMatrix<T>* as_csr() const noexcept { return pCSR.get(); }
+    const TBSRMatrix<T, 3>* as_bsr3() const noexcept { return pBSR3.get(); }
+    const TBSRMatrix<T, 4>* as_bsr4() const noexcept { return pBSR4.get(); }
+
+    T get(size_t i, size_t j) const
+    {
+        if (i >= nrows || j >= ncols) throw out_of_range("out of range");
+        switch (dec.format) {
+        case TMatrixFormat::Dense: return pDense->at(i).at(j);
+        case TMatrixFormat::CSR: return pCSR->get(i, j);
+        case TMatrixFormat::BSR3: return pBSR3->get(i, j);
+        default: return pBSR4->get(i, j);
+        }
+    }
+
+    // разреженное представление (для плотной матрицы - строится)
+    TCSRMatrix<T> csr() const
+    {
+        check_not_empty();
+        switch (dec.format) {
+        case TMatrixFormat::Dense: return TCSRMatrix<T>(*pDense);
+        case TMatrixFormat::CSR: return *pCSR;
+        case TMatrixFormat::BSR3: return pBSR3->csr();
+        default: return pBSR4->csr();
+        }
+    }
+
+    // y = alpha A x + beta y ядром выбранного формата
+    template<typename AX, typename AY>
+    void gemv(T alpha, const TDynamicVector<T, AX>& x, T beta, TDynamicVector<T, AY>& y) const
+    {
+        check_not_empty();
+        switch (dec.format) {
+        case TMatrixFormat::Dense: ::gemv(alpha, *pDense, x, beta, y); break;
+        case TMatrixFormat::CSR: spmv(alpha, *pCSR, x, beta, y); break;
+        case TMatrixFormat::BSR3: spmv(alpha, *pBSR3, x, beta, y); break;
+        default: spmv(alpha, *pBSR4, x, beta, y); break;
+        }
+    }
+
+    friend void swap(TAnyMatrix& lhs, TAnyMatrix& rhs) noexcept
+    {
+        std::swap(lhs.nrows, rhs.nrows);
+        std::swap(lhs.ncols, rhs.ncols);
+        std::swap(lhs.pol, rhs.pol);
+        std::swap(lhs.dec, rhs.dec);
+        lhs.pDense.swap(rhs.pDense);
+        lhs.pCSR.swap(rhs.pCSR);
+        lhs.pBSR3.swap(rhs.pBSR3);
+        lhs.pBSR4.swap(rhs.pBSR4);
+    }
+};
+
+// умножение на вектор
+template<typename T, typename R>
+TDynamicVector<T> operator*(const TAnyMatrix<T>& a, const TExpr<R, TVectorTag>& r)
+{
+    const auto& x = materialize(r.self());
+    if (a.cols() != x.size()) throw logic_error("different lengths");
+    TDynamicVector<T> res(a.rows(), uninitialized);
+    a.gemv(T(1), x, T(), res);
+    return res;
+}
+
+// Произведение: две плотные матрицы - GEMM, иначе SpGEMM в CSR; формат
+// результата выбирается заново по его плотности и порогам левого операнда
+template<typename T>
+TAnyMatrix<T> operator*(const TAnyMatrix<T>& a, const TAnyMatrix<T>& b)
+{
+    if (a.empty() || b.empty()) throw logic_error("matrix is empty");
+    if (a.cols() != b.rows()) throw logic_error("different lengths");
+    if (a.format() == TMatrixFormat::Dense && b.format() == TMatrixFormat::Dense)
+        return TAnyMatrix<T>(TDynamicMatrix<T>(*a.as_dense() * *b.as_dense()), a.policy());
+    return TAnyMatrix<T>(a.csr() * b.csr(), a.policy());
+}
+
+#endif
@@ -0,0 +1,220 @@
+// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Арена для временных объектов
+//
+// Память выделяется сдвигом указателя внутри больших блоков и по
+// отдельности не освобождается; вся арена (или её часть, начиная с
+// отметки) освобождается за O(1). Блоки не возвращаются системе до
+// release() или разрушения арены, поэтому повторные вычисления в той же
+// арене обходятся без обращений к системному распределителю.
+//
+// TArenaScope делает арену текущей для потока до конца области видимости
+// и при выходе возвращает её в прежнее состояние. Объекты с аллокатором
+// TArenaAllocator, созданные внутри области, не должны её переживать.
+// Арена не потокобезопасна: ею пользуется только создавший её поток.
+//
+// В арену попадают только объекты с аллокатором TArenaAllocator
+// (TArenaVector, TArenaMatrix) и результаты операций над ними: произведение
+// и переиспользованный временный операнд берут аллокатор операнда.
+// Обычные TDynamicVector и TDynamicMatrix, в том числе созданные внутри
+// области, и промежуточное вычисление операнда-выражения в произведении
+// (materialize) используют кучу: TAlignedAllocator не хранит состояния и
+// не отличил бы память арены от своей, а такие объекты могут пережить
+// область. Временные объекты, которые должны жить в арене, объявляются
+// с типами TArenaVector и TArenaMatrix.
+
+#ifndef __TArena_H__
+#define __TArena_H__
+
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+#include "tmemory.h"
+
+class TArena
+{
+    struct TBlock
+    {
+        char* mem;
+        size_t size;
+    };
+
+    std::vector<TBlock> blocks;
+    size_t cur;       // номер текущего блока
+    size_t offset;    // занято в текущем блоке
+    size_t blockSize;
+    size_t nAllocs;
+    size_t nBytes;
+    size_t peak;
+    size_t used;
+
+    static char* new_block(size_t size)
+    {
+        return TAlignedAllocator<char>().allocate(size);
+    }
+
+public:
+    // отметка состояния арены для отката
+    struct TMark
+    {
+        size_t block;
+        size_t offset;
+        size_t used;
+    };
+
+    explicit TArena(size_t block_size = 1 << 20)
+        : cur(0), offset(0), blockSize(block_size), nAllocs(0), nBytes(0), peak(0), used(0)
+    {
+        if (blockSize == 0)
+            throw std::length_error("Arena block size should be greater than zero");
+    }
+    TArena(const TArena&) = delete;
+    TArena& operator=(const TArena&) = delete;
+    ~TArena() { release(); }
+
+    // bytes байт с выравниванием align (степень двойки, не больше 64)
+    void* allocate(size_t bytes, size_t align = CACHE_LINE_SIZE)
+    {
+        if (align == 0 || (align & (align - 1)) != 0 || align > CACHE_LINE_SIZE)
+            throw std::invalid_argument("bad alignment");
+        if (bytes == 0)
+            bytes = 1;
+        for (;;) {
+            if (cur < blocks.size()) {
+                const size_t start = (offset + align - 1) & ~(align - 1);
+                if (start <= blocks[cur].size && bytes <= blocks[cur].size - start) {
+                    offset = start + bytes;
+                    nAllocs++;
+                    nBytes += bytes;
+                    used += bytes;
+                    if (used > peak)
+                        peak = used;
+                    return blocks[cur].mem + start;
+                }
+                if (cur + 1 < blocks.size() && blocks[cur + 1].size >= bytes) {
+                    cur++;
+                    offset = 0;
+                    continue;
+                }
+            }
+            // новый блок вставляется сразу за текущим, блоки за ним
+            // остаются для следующих выделений
+            const size_t size = bytes > blockSize ? (bytes + CACHE_LINE_SIZE - 1) / CACHE_LINE_SIZE * CACHE_LINE_SIZE : blockSize;
+            TBlock b = { new_block(size), size };
+            const size_t pos = blocks.empty() ? 0 : cur + 1;
+            blocks.insert(blocks.begin() + pos, b);
+            cur = pos;
+            offset = 0;
+        }
+    }
+
+    TMark mark() const noexcept
+    {
+        TMark m = { cur, offset, used };
+        return m;
+    }
+    // освобождение всего, что выделено после отметки m
+    void rewind(const TMark& m) noexcept
+    {
+        cur = m.block;
+        offset = m.offset;
+        used = m.used;
+    }
+    // освобождение всей памяти арены для повторного использования
+    void reset() noexcept
+    {
+        cur = 0;
+        offset = 0;
+        used = 0;
+    }
+    // возврат блоков системе
+    void release() noexcept
+    {
+        for (size_t i = 0; i < blocks.size(); i++)
+            TAlignedAllocator<char>().deallocate(blocks[i].mem, blocks[i].size);
+        blocks.clear();
+        reset();
+    }
+
+    // счётчики за всё время жизни арены
+    size_t allocations() const noexcept { return nAllocs; }
+    size_t bytes_allocated() const noexcept { return nBytes; }
+    // занято сейчас и наибольшая занятость
+    size_t bytes_in_use() const noexcept { return used; }
+    size_t peak_bytes() const noexcept { return peak; }
+    // запрошено у системы
+    size_t bytes_reserved() const noexcept
+    {
+        size_t res = 0;
+        for (size_t i = 0; i < blocks.size(); i++)
+            res += blocks[i].size;
+        return res;
+    }
+
+    // арена текущей области TArenaScope потока или nullptr
+    static TArena*& current() noexcept
+    {
+        thread_local TArena* arena = nullptr;
+        return arena;
+    }
+};
+
+// Область действия арены
+class TArenaScope
+{
+    TArena& arena;
+    TArena* prev;
+    TArena::TMark start;
+public:
+    explicit TArenaScope(TArena& a) : arena(a), prev(TArena::current()), start(a.mark())
+    {
+        TArena::current() = &arena;
+    }
+    TArenaScope(const TArenaScope&) = delete;
+    TArenaScope& operator=(const TArenaScope&) = delete;
+    ~TArenaScope()
+    {
+        arena.rewind(start);
+        TArena::current() = prev;
+    }
+};
+
+// Аллокатор, берущий память из арены. Созданный по умолчанию использует
+// арену текущей области, а вне областей - обычную выровненную память.
+template<typename T>
+class TArenaAllocator
+{
+    template<typename U> friend class TArenaAllocator;
+    static_assert(alignof(T) <= CACHE_LINE_SIZE, "over-aligned type");
+    TArena* arena;
+public:
+    typedef T value_type;
+    template<typename U>
+    struct rebind { typedef TArenaAllocator<U> other; };
+
+    TArenaAllocator() noexcept : arena(TArena::current()) {}
+    explicit TArenaAllocator(TArena& a) noexcept : arena(&a) {}
+    template<typename U>
+    TArenaAllocator(const TArenaAllocator<U>& a) noexcept : arena(a.arena) {}
+
+    T* allocate(size_t n)
+    {
+        if (arena == nullptr)
+            return TAlignedAllocator<T>().allocate(n);
+        if (n > size_t(-1) / sizeof(T))
+            throw std::bad_alloc();
+        return static_cast<T*>(arena->allocate(n * sizeof(T)));
+    }
+    void deallocate(T* p, size_t n) noexcept
+    {
+        if (arena == nullptr)
+            TAlignedAllocator<T>().deallocate(p, n);
+    }
+
+    TArena* get_arena() const noexcept { return arena; }
+
+    friend bool operator==(const TArenaAllocator& a, const TArenaAllocator& b) noexcept { return a.arena == b.arena; }
+    friend bool operator!=(const TArenaAllocator& a, const TArenaAllocator& b) noexcept { return a.arena != b.arena; }
+};
+
+#endif
@@ -0,0 +1,152 @@
+// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Ядра для ленточных матриц
+//
+// Матрица порядка n с kl поддиагоналями и ku наддиагоналями хранится
+// построчно по w = kl + ku + 1 элементов: элемент (i, j) лежит в
+// band[i * w + j - i + kl]. Это построчный аналог ленточного формата
+// LAPACK; ячейки ленты за пределами матрицы (в первых kl и последних ku
+// строках) хранят нули. Все ядра работают за O(n w).
+
+#ifndef __TBand_H__
+#define __TBand_H__
+
+#include <cmath>
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+#include "tmemory.h"
+#include "tsimd.h"
+
+namespace kernels
+{
+
+// столбцы строки i, попадающие в ленту: [first, last)
+inline size_t band_first(size_t i, size_t kl)
+{
+    return i > kl ? i - kl : 0;
+}
+inline size_t band_last(size_t n, size_t i, size_t ku)
+{
+    return n - i > ku ? i + ku + 1 : n;
+}
+
+// y = A x
+template<typename T>
+void gbmv(size_t n, size_t kl, size_t ku, const T* band, const T* x, T* y)
+{
+    const TKernelTable<T>& t = kernel_table<T>();
+    const size_t w = kl + ku + 1;
+    auto body = [&](size_t ib, size_t ie) {
+        for (size_t i = ib; i < ie; i++) {
+            const size_t j0 = band_first(i, kl), j1 = band_last(n, i, ku);
+            const T* row = band + i * w + j0 - i + kl;
+            // узкой ленте вызов ядра не окупается
+            if (w < 16) {
+                T s = T();
+                for (size_t j = j0; j < j1; j++)
+                    s += row[j - j0] * x[j];
+                y[i] = s;
+            }
+            else
+                y[i] = t.dot(j1 - j0, row, x + j0);
+        }
+    };
+    if (n * w < PARALLEL_MIN_ELEMENTS)
+        body(0, n);
+    else {
+        const size_t rows = PARALLEL_GRAIN / w;
+        TThreadPool::instance().parallel_for(0, n, rows < 4 ? 4 : rows, body);
+    }
+}
+
+template<typename T>
+inline double band_abs(const T& v)
+{
+    return v < T() ? -double(v) : double(v);
+}
+
+// LU-разложение с выбором ведущего элемента по столбцу.
+// lu - n строк по wf = 2 kl + ku + 1 элементов: элемент (i, j) в
+// lu[i * wf + j - i + kl], лента U расширяется на kl наддиагоналей из-за
+// перестановок. На входе - матрица в этом формате (лишние ячейки нулевые),
+// на выходе - множители L под диагональю и U на диагонали и над ней;
+// piv[k] - строка, переставленная с k на шаге k.
+template<typename T>
+void gbtrf(size_t n, size_t kl, size_t ku, T* lu, size_t* piv)
+{
+    const TKernelTable<T>& t = kernel_table<T>();
+    const size_t wf = 2 * kl + ku + 1;
+    const size_t ku2 = kl + ku;
+    for (size_t k = 0; k < n; k++) {
+        const size_t i1 = band_last(n, k, kl);
+        const size_t j1 = band_last(n, k, ku2);
+        size_t p = k;
+        for (size_t i = k + 1; i < i1; i++)
+            if (band_abs(lu[i * wf + k - i + kl]) > band_abs(lu[p * wf + k - p + kl]))
+                p = i;
+        piv[k] = p;
+        if (lu[p * wf + k - p + kl] == T())
+            throw std::runtime_error("matrix is singular");
+        if (p != k)
+            for (size_t j = k; j < j1; j++)
+                std::swap(lu[k * wf + j - k + kl], lu[p * wf + j - p + kl]);
+        const T* rowk = lu + k * wf + kl;   // элемент (k, k)
+        for (size_t i = k + 1; i < i1; i++) {
+            T* rowi = lu + i * wf + k - i + kl;   // элемент (i, k)
+            const T l = rowi[0] / rowk[0];
+            rowi[0] = l;
+            if (j1 - k > 1)
+                t.axpy(j1 - k - 1, T(-l), rowk + 1, rowi + 1);
+        }
+    }
+}
+
+// Решение A x = b по разложению gbtrf; b заменяется решением
+template<typename T>
+void gbtrs(size_t n, size_t kl, size_t ku, const T* lu, const size_t* piv, T* b)
+{
+    const size_t wf = 2 * kl + ku + 1;
+    const size_t ku2 = kl + ku;
+    for (size_t k = 0; k < n; k++) {
+        if (piv[k] != k)
+            std::swap(b[k], b[piv[k]]);
+        const size_t i1 = band_last(n, k, kl);
+        for (size_t i = k + 1; i < i1; i++)
+            b[i] -= lu[i * wf + k - i + kl] * b[k];
+    }
+    for (size_t i = n; i-- > 0; ) {
+        const T* row = lu + i * wf + kl;   // элемент (i, i)
+        const size_t j1 = band_last(n, i, ku2);
+        T s = b[i];
+        for (size_t j = i + 1; j < j1; j++)
+            s -= row[j - i] * b[j];
+        b[i] = s / row[0];
+    }
+}
+
+// Метод прогонки для трёхдиагональной матрицы (kl = ku = 1) без
+// перестановок: устойчив при диагональном преобладании. b заменяется
+// решением, work - n элементов.
+template<typename T>
+void gtsv(size_t n, const T* band, T* b, T* work)
+{
+    // строка i: band[3 i] = a(i, i - 1), band[3 i + 1] = a(i, i), band[3 i + 2] = a(i, i + 1)
+    T d = band[1];
+    if (d == T())
+        throw std::runtime_error("zero pivot");
+    b[0] /= d;
+    for (size_t i = 1; i < n; i++) {
+        work[i] = band[3 * (i - 1) + 2] / d;
+        d = band[3 * i + 1] - band[3 * i] * work[i];
+        if (d == T())
+            throw std::runtime_error("zero pivot");
+        b[i] = (b[i] - band[3 * i] * b[i - 1]) / d;
+    }
+    for (size_t i = n - 1; i-- > 0; )
+        b[i] -= work[i + 1] * b[i + 1];
+}
+
+} // namespace kernels
+
+#endif
@@ -0,0 +1,345 @@
+// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Ленточная матрица
+//
+// Хранятся только kl поддиагоналей, главная диагональ и ku наддиагоналей
+// (формат - см. tband.h), всего n (kl + ku + 1) элементов, поэтому порядок
+// ограничен не MAX_MATRIX_SIZE, а объёмом ленты (MAX_VECTOR_SIZE).
+// Умножение на вектор, поэлементные операции и решение систем занимают
+// O(n (kl + ku)) операций.
+
+#ifndef __TBandMatrix_H__
+#define __TBandMatrix_H__
+
+#include "tmatrix.h"
+#include "tband.h"
+
+// Вид операнда: ленточные матрицы смешиваются только между собой,
+// с одинаковой шириной ленты
+struct TBandTag
+{
+    static const char* mismatch() { return "different lengths or bandwidths"; }
+};
+// прибавление скаляра заполнило бы нули вне ленты
+template<>
+struct TExprScalarShift<TBandTag> : std::false_type {};
+
+// Строка i ленточной матрицы: доступны столбцы из ленты
+template<typename T>
+class TBandRow
+{
+    T* pMem;     // место элемента (i, i - kl)
+    size_t row;
+    size_t sz;
+    size_t kl, ku;
+public:
+    TBandRow(T* p, size_t i, size_t n, size_t lower, size_t upper) noexcept
+        : pMem(p), row(i), sz(n), kl(lower), ku(upper) {}
+
+    size_t size() const noexcept { return sz; }
+    bool in_band(size_t j) const noexcept
+    {
+        return j < sz && j + kl >= row && j <= row + ku;
+    }
+
+    // индексация: только элементы ленты
+    T& operator[](size_t j) const
+    {
+        assert(in_band(j) && "element outside of the band");
+        return pMem[j + kl - row];
+    }
+    // индексация с контролем
+    T& at(size_t j) const
+    {
+        if (!in_band(j)) throw out_of_range("out of range");
+        return pMem[j + kl - row];
+    }
+};
+
+template<typename T, typename Alloc = TAlignedAllocator<T>>
+class TBandMatrix : public TExpr<TBandMatrix<T, Alloc>, TBandTag>
+{
+    size_t sz;
+    size_t kl, ku;
+    TDynamicVector<T, Alloc> mem;
+
+    static size_t band(size_t s, size_t lower, size_t upper)
+    {
+        if (s == 0)
+            throw length_error("Matrix size should be greater than zero");
+        if (lower >= s || upper >= s)
+            throw length_error("Bandwidth should be less than matrix size");
+        if (s > MAX_VECTOR_SIZE / (lower + upper + 1))
+            throw length_error("Band should contain less than MAX_VECTOR_SIZE elements");
+        return s * (lower + upper + 1);
+    }
+    // обнуление ячеек хранения за пределами матрицы (углы ленты в первых
+    // kl и последних ku строках): они входят в elem() и count(), поэтому
+    // участвуют в поэлементных операциях и сравнении
+    void clear_padding()
+    {
+        const size_t w = kl + ku + 1;
+        for (size_t i = 0; i < sz && i < kl; i++)
+            mem_fill<T>(mem.data() + i * w, kl - i, T());
+        for (size_t i = sz > ku ? sz - ku : 0; i < sz; i++)
+            mem_fill<T>(mem.data() + i * w + sz - i + kl, i + ku + 1 - sz, T());
+    }
+public:
+    typedef T value_type;
+    typedef Alloc allocator_type;
+
+    TBandMatrix(size_t s = 1, size_t lower = 0, size_t upper = 0, const Alloc& a = Alloc())
+        : sz(s), kl(lower), ku(upper), mem(band(s, lower, upper), a) {}
+    TBandMatrix(size_t s, size_t lower, size_t upper, TUninitialized, const Alloc& a = Alloc())
+        : sz(s), kl(lower), ku(upper), mem(band(s, lower, upper), uninitialized, a)
+    {
+        clear_padding();
+    }
+    // лента плотной матрицы
+    template<typename A>
+    TBandMatrix(const TDynamicMatrix<T, A>& m, size_t lower, size_t upper, const Alloc& a = Alloc())
+        : TBandMatrix(m.size(), lower, upper, a)
+    {
+        for (size_t i = 0; i < sz; i++)
+            for (size_t j = kernels::band_first(i, kl); j < kernels::band_last(sz, i, ku); j++)
+                (*this)[i][j] = m.data()[i * sz + j];
+    }
+    // вычисление выражения за один проход
+    template<typename E>
+    TBandMatrix(const TExpr<E, TBandTag>& e, const Alloc& a = Alloc())
+        : TBandMatrix(e.self().size(), e.self().layout(), e.self().count() / e.self().size() - e.self().layout() - 1,
+            uninitialized, a)
+    {
+        static_assert(std::is_same<typename E::value_type, T>::value, "element types differ");
+        expr_assign(mem.data(), e.self());
+    }
+    TBandMatrix(const TBandMatrix& m) = default;
+    TBandMatrix(TBandMatrix&& m) noexcept : sz(m.sz), kl(m.kl), ku(m.ku), mem(std::move(m.mem))
+    {
+        m.sz = 0;
+    }
+    TBandMatrix& operator=(const TBandMatrix& m) = default;
+    TBandMatrix& operator=(TBandMatrix&& m) noexcept
+    {
+        sz = m.sz;
+        kl = m.kl;
+        ku = m.ku;
+        mem = std::move(m.mem);
+        m.sz = 0;
+        return *this;
+    }
+    template<typename E>
+    TBandMatrix& operator=(const TExpr<E, TBandTag>& e)
+    {
+        if (sz != e.self().size() || count() != e.self().count() || kl != e.self().layout()) {
+            TBandMatrix tmp(e);
+            swap(*this, tmp);
+        }
+        else
+            expr_assign(mem.data(), e.self());
+        return *this;
+    }
+
+    size_t size() const noexcept { return sz; }
+    size_t count() const noexcept { return sz * (kl + ku + 1); }
+    size_t layout() const noexcept { return kl; }
+    const T& elem(size_t i) const { return mem.data()[i]; }
+
+    size_t lower_bandwidth() const noexcept { return kl; }
+    size_t upper_bandwidth() const noexcept { return ku; }
+
+    // непосредственный доступ к ленте (построчно)
+    T* data() noexcept { return mem.data(); }
+    const T* data() const noexcept { return mem.data(); }
+
+    // заполнение элементов ленты; ячейки за пределами матрицы остаются нулями
+    void fill(const T& val)
+    {
+        for (size_t i = 0; i < sz; i++)
+            for (size_t j = kernels::band_first(i, kl); j < kernels::band_last(sz, i, ku); j++)
+                (*this)[i][j] = val;
+    }
+
+    // индексация
+    TBandRow<T> operator[](size_t ind)
+    {
+        return TBandRow<T>(mem.data() + ind * (kl + ku + 1), ind, sz, kl, ku);
+    }
+    TBandRow<const T> operator[](size_t ind) const
+    {
+        return TBandRow<const T>(mem.data() + ind * (kl + ku + 1), ind, sz, kl, ku);
+    }
+    // индексация с контролем
+    TBandRow<T> at(size_t ind)
+    {
+        if (ind >= sz) throw out_of_range("out of range");
+        return (*this)[ind];
+    }
+    TBandRow<const T> at(size_t ind) const
+    {
+        if (ind >= sz) throw out_of_range("out of range");
+        return (*this)[ind];
+    }
+    // значение любого элемента, включая нули вне ленты
+    T get(size_t i, size_t j) const
+    {
+        if (i >= sz || j >= sz) throw out_of_range("out of range");
+        return (*this)[i].in_band(j) ? (*this)[i][j] : T();
+    }
+
+    TDynamicMatrix<T, Alloc> dense() const
+    {
+        TDynamicMatrix<T, Alloc> res(sz, mem.get_allocator());
+        for (size_t i = 0; i < sz; i++)
+            for (size_t j = kernels::band_first(i, kl); j < kernels::band_last(sz, i, ku); j++)
+                res[i][j] = (*this)[i][j];
+        return res;
+    }
+
+    // поэлементные операции - см. texpr.h, произведения и решение
+    // систем - после определения класса
+
+    // операции с присваиванием, без выделения памяти
+    template<typename E>
+    TBandMatrix& operator+=(const TExpr<E, TBandTag>& e)
+    {
+        expr_assign(mem.data(), *this + e.self());
+        return *this;
+    }
+    template<typename E>
+    TBandMatrix& operator-=(const TExpr<E, TBandTag>& e)
+    {
+        expr_assign(mem.data(), *this - e.self());
+        return *this;
+    }
+    TBandMatrix& operator*=(const T& val)
+    {
+        expr_assign(mem.data(), *this * val);
+        return *this;
+    }
+
+    allocator_type get_allocator() const { return mem.get_allocator(); }
+
+    friend void swap(TBandMatrix& lhs, TBandMatrix& rhs) noexcept
+    {
+        std::swap(lhs.sz, rhs.sz);
+        std::swap(lhs.kl, rhs.kl);
+        std::swap(lhs.ku, rhs.ku);
+        swap(lhs.mem, rhs.mem);
+    }
+
+    // ввод элементов ленты построчно, вывод всей матрицы
+    friend istream& operator>>(istream& istr, TBandMatrix& v)
+    {
+        for (size_t i = 0; i < v.sz; i++)
+            for (size_t j = kernels::band_first(i, v.kl); j < kernels::band_last(v.sz, i, v.ku); j++)
+                istr >> v[i][j];
+        return istr;
+    }
+    friend ostream& operator<<(ostream& ostr, const TBandMatrix& v)
+    {
+        for (size_t i = 0; i < v.sz; i++) {
+            for (size_t j = 0; j < v.sz; j++)
+                ostr << v.get(i, j) << ' ';
+            ostr << endl;
+        }
+        return ostr;
+    }
+};
+
+template<typename T, typename A>
+struct TExprDense<TBandMatrix<T, A>> : std::true_type {};
+template<typename T, typename A>
+struct TExprOwner<TBandMatrix<T, A>> : std::true_type {};
+
+template<typename T, typename A>
+const TBandMatrix<T, A>& materialize(const TBandMatrix<T, A>& m) { return m; }
+template<typename E>
+TBandMatrix<typename E::value_type> materialize(const TExpr<E, TBandTag>& e)
+{
+    return TBandMatrix<typename E::value_type>(e);
+}
+
+// умножение на вектор
+template<typename L, typename R>
+TDynamicVector<typename L::value_type> operator*(const TExpr<L, TBandTag>& l, const TExpr<R, TVectorTag>& r)
+{
+    typedef typename L::value_type T;
+    const auto& a = materialize(l.self());
+    const auto& x = materialize(r.self());
+    const size_t sz = a.size();
+    if (sz != x.size()) throw logic_error("different lengths");
+    TDynamicVector<T> res(sz, uninitialized);
+    kernels::gbmv(sz, a.lower_bandwidth(), a.upper_bandwidth(), a.data(), x.data(), res.data());
+    return res;
+}
+
+// LU-разложение ленточной матрицы с выбором ведущего элемента.
+// Разложение строится один раз и используется для любого числа
+// правых частей.
+template<typename T>
+class TBandLU
+{
+    size_t sz;
+    size_t kl, ku;
+    TDynamicVector<T> lu;
+    TDynamicVector<size_t> piv;
+
+    // лента, расширенная на kl наддиагоналей для перестановок
+    static size_t factor_band(size_t s, size_t lower, size_t upper)
+    {
+        if (s > MAX_VECTOR_SIZE / (2 * lower + upper + 1))
+            throw length_error("Band LU factors should contain less than MAX_VECTOR_SIZE elements");
+        return s * (2 * lower + upper + 1);
+    }
+public:
+    template<typename A>
+    explicit TBandLU(const TBandMatrix<T, A>& m)
+        : sz(m.size()), kl(m.lower_bandwidth()), ku(m.upper_bandwidth()),
+          lu(factor_band(sz, kl, ku)), piv(sz, uninitialized)
+    {
+        const size_t w = kl + ku + 1, wf = w + kl;
+        for (size_t i = 0; i < sz; i++)
+            mem_copy(m.data() + i * w, w, lu.data() + i * wf);
+        kernels::gbtrf(sz, kl, ku, lu.data(), piv.data());
+    }
+
+    size_t size() const noexcept { return sz; }
+
+    // b заменяется решением
+    template<typename A>
+    void solve_in_place(TDynamicVector<T, A>& b) const
+    {
+        if (b.size() != sz) throw logic_error("different lengths");
+        kernels::gbtrs(sz, kl, ku, lu.data(), piv.data(), b.data());
+    }
+    template<typename A>
+    TDynamicVector<T, A> solve(const TDynamicVector<T, A>& b) const
+    {
+        TDynamicVector<T, A> x(b);
+        solve_in_place(x);
+        return x;
+    }
+};
+
+// решение A x = b
+template<typename T, typename AM, typename AV>
+TDynamicVector<T, AV> solve(const TBandMatrix<T, AM>& a, const TDynamicVector<T, AV>& b)
+{
+    return TBandLU<T>(a).solve(b);
+}
+
+// решение трёхдиагональной системы методом прогонки (без перестановок)
+template<typename T, typename AM, typename AV>
+TDynamicVector<T, AV> thomas_solve(const TBandMatrix<T, AM>& a, const TDynamicVector<T, AV>& b)
+{
+    if (a.lower_bandwidth() != 1 || a.upper_bandwidth() != 1)
+        throw logic_error("matrix is not tridiagonal");
+    if (a.size() != b.size()) throw logic_error("different lengths");
+    TDynamicVector<T, AV> x(b);
+    TDynamicVector<T> work(a.size(), uninitialized);
+    kernels::gtsv(a.size(), a.data(), x.data(), work.data());
+    return x;
+}
+
+#endif
@@ -0,0 +1,301 @@
+// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Двоичный формат файлов векторов и матриц
+//
+// Файл - заголовок TBinaryHeader (64 байта), нули до границы выравнивания
+// и элементы в машинном представлении, построчно. Заголовок хранит тип
+// элементов, размеры, порядок хранения, выравнивание данных и контрольную
+// сумму данных. Данные начинаются на границе страницы (по умолчанию
+// 4096 байт), поэтому файл можно не читать, а отображать в память
+// (tmapped.h) и работать с ним без копирования.
+//
+// Запись и чтение - по одной операции ввода-вывода на весь массив
+// данных, без разбора текста. Формат рассчитан на машину того же
+// порядка байтов, что и записавшая его; иное отвергается при загрузке.
+
+#ifndef __TBinary_H__
+#define __TBinary_H__
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include "tmapped.h"
+
+// Тип элементов в файле
+enum TBinaryType { BINARY_FLOAT32 = 1, BINARY_FLOAT64 = 2, BINARY_INT32 = 3, BINARY_INT64 = 4 };
+// Порядок хранения элементов
+enum TBinaryLayout { BINARY_ROW_MAJOR = 0 };
+
+template<typename T>
+struct TBinaryTypeOf;
+template<>
+struct TBinaryTypeOf<float> { static const TBinaryType value = BINARY_FLOAT32; };
+template<>
+struct TBinaryTypeOf<double> { static const TBinaryType value = BINARY_FLOAT64; };
+template<>
+struct TBinaryTypeOf<int32_t> { static const TBinaryType value = BINARY_INT32; };
+template<>
+struct TBinaryTypeOf<int64_t> { static const TBinaryType value = BINARY_INT64; };
+
+const uint32_t BINARY_VERSION = 1;
+const uint32_t BINARY_ENDIAN = 0x01020304;
+const size_t BINARY_ALIGNMENT = 4096;
+
+struct TBinaryHeader
+{
+    char magic[8];         // "TMATRIX\0"
+    uint32_t version;      // BINARY_VERSION
+    uint32_t endian;       // BINARY_ENDIAN в порядке байтов записавшей машины
+    uint32_t type;         // TBinaryType
+    uint32_t elemSize;     // sizeof элемента
+    uint32_t layout;       // TBinaryLayout
+    uint32_t alignment;    // выравнивание начала данных
+    uint64_t rows;         // вектор хранится столбцом: rows = n, cols = 1
+    uint64_t cols;
+    uint64_t dataOffset;   // начало данных от начала файла
+    uint64_t checksum;     // binary_checksum данных
+};
+static_assert(sizeof(TBinaryHeader) == 64, "binary header must be 64 bytes");
+
+namespace kernels
+{
+
+// Контрольная сумма: 64-битные слова перемешиваются в четырёх независимых
+// цепочках (умножение и циклический сдвиг), так что сумма считается со
+// скоростью, близкой к скорости чтения памяти
+inline uint64_t checksum_mix(uint64_t h, uint64_t w)
+{
+    h ^= w * 0x9E3779B97F4A7C15ull;
+    h = (h << 31) | (h >> 33);
+    return h * 0xC2B2AE3D27D4EB4Full;
+}
+
+inline uint64_t checksum_block(const unsigned char* p, size_t bytes)
+{
+    uint64_t h[4] = { 1, 2, 3, 4 };
+    size_t i = 0;
+    for (; i + 32 <= bytes; i += 32)
+        for (size_t k = 0; k < 4; k++) {
+            uint64_t w;
+            std::memcpy(&w, p + i + 8 * k, 8);
+            h[k] = checksum_mix(h[k], w);
+        }
+    // хвост короче 32 байт - по словам, последнее неполное слово
+    // дополняется нулями; длина хвоста отличает его от нулевых байтов
+    uint64_t res = checksum_mix(bytes, bytes - i);
+    for (; i < bytes; i += 8) {
+        uint64_t w = 0;
+        std::memcpy(&w, p + i, bytes - i < 8 ? bytes - i : 8);
+        res = checksum_mix(res, w);
+    }
+    for (size_t k = 0; k < 4; k++)
+        res = checksum_mix(res, h[k]);
+    return res;
+}
+
+// Сумма по фиксированным блокам CHECKSUM_BLOCK байт, сложенным по порядку:
+// блоки считаются параллельно, а результат не зависит от числа потоков
+const size_t CHECKSUM_BLOCK = 1 << 20;
+
+inline uint64_t checksum(const void* data, size_t bytes)
+{
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    const size_t blocks = (bytes + CHECKSUM_BLOCK - 1) / CHECKSUM_BLOCK;
+    std::vector<uint64_t> partial(blocks);
+    auto body = [&](size_t bb, size_t be) {
+        for (size_t k = bb; k < be; k++) {
+            const size_t off = k * CHECKSUM_BLOCK;
+            partial[k] = checksum_block(p + off, bytes - off < CHECKSUM_BLOCK ? bytes - off : CHECKSUM_BLOCK);
+        }
+    };
+    TThreadPool::instance().parallel_for(0, blocks, 1, body);
+    uint64_t res = checksum_mix(0, bytes);
+    for (size_t k = 0; k < blocks; k++)
+        res = checksum_mix(res, partial[k]);
+    return res;
+}
+
+} // namespace kernels
+
+// Запись rows x cols элементов data в файл path. alignment - степень
+// двойки не меньше 64. Пустые массивы не записываются.
+template<typename T>
+void save_binary(const std::string& path, const T* data, size_t rows, size_t cols, size_t alignment = BINARY_ALIGNMENT)
+{
+    if (rows == 0 || cols == 0)
+        throw std::length_error("cannot save empty data");
+    if (alignment < CACHE_LINE_SIZE || (alignment & (alignment - 1)) != 0 || alignment > (size_t(1) << 30))
+        throw std::invalid_argument("bad alignment");
+    const size_t bytes = rows * cols * sizeof(T);
+    TBinaryHeader h;
+    std::memset(&h, 0, sizeof(h));
+    std::memcpy(h.magic, "TMATRIX", 8);
+    h.version = BINARY_VERSION;
+    h.endian = BINARY_ENDIAN;
+    h.type = TBinaryTypeOf<T>::value;
+    h.elemSize = sizeof(T);
+    h.layout = BINARY_ROW_MAJOR;
+    h.alignment = uint32_t(alignment);
+    h.rows = rows;
+    h.cols = cols;
+    h.dataOffset = (sizeof(h) + alignment - 1) / alignment * alignment;
+    h.checksum = kernels::checksum(data, bytes);
+
+    std::ofstream out(path.c_str(), std::ios::binary | std::ios::trunc);
+    if (!out)
+        throw std::runtime_error("cannot open " + path);
+    std::vector<char> head(size_t(h.dataOffset), 0);
+    std::memcpy(head.data(), &h, sizeof(h));
+    out.write(head.data(), std::streamsize(head.size()));
+    out.write(reinterpret_cast<const char*>(data), std::streamsize(bytes));
+    if (!out.flush())
+        throw std::runtime_error("cannot write " + path);
+}
+
+template<typename T, typename A>
+void save_binary(const std::string& path, const TDynamicVector<T, A>& v, size_t alignment = BINARY_ALIGNMENT)
+{
+    save_binary(path, v.data(), v.size(), 1, alignment);
+}
+template<typename T, typename A>
+void save_binary(const std::string& path, const TDynamicMatrix<T, A>& m, size_t alignment = BINARY_ALIGNMENT)
+{
+    save_binary(path, m.data(), m.size(), m.size(), alignment);
+}
+template<typename T, typename A>
+void save_binary(const std::string& path, const TRectMatrix<T, A>& m, size_t alignment = BINARY_ALIGNMENT)
+{
+    save_binary(path, m.data(), m.rows(), m.cols(), alignment);
+}
+
+// Проверка заголовка для элементов типа T; fileSize - размер файла
+template<typename T>
+void check_binary_header(const TBinaryHeader& h, uint64_t fileSize)
+{
+    if (std::memcmp(h.magic, "TMATRIX", 8) != 0)
+        throw std::runtime_error("not a matrix file");
+    if (h.version != BINARY_VERSION)
+        throw std::runtime_error("unsupported format version");
+    if (h.endian != BINARY_ENDIAN)
+        throw std::runtime_error("file has different byte order");
+    if (h.type != uint32_t(TBinaryTypeOf<T>::value) || h.elemSize != sizeof(T))
+        throw logic_error("element types differ");
+    if (h.layout != BINARY_ROW_MAJOR)
+        throw std::runtime_error("unsupported layout");
+    if (h.rows == 0 || h.cols == 0 || h.dataOffset < sizeof(h) || h.dataOffset % alignof(T) != 0)
+        throw std::runtime_error("corrupted header");
+    if (h.alignment == 0 || (h.alignment & (h.alignment - 1)) != 0 || h.dataOffset % h.alignment != 0)
+        throw std::runtime_error("corrupted header");
+    if (fileSize < h.dataOffset || h.cols > (fileSize - h.dataOffset) / sizeof(T) / h.rows)
+        throw std::runtime_error("file is truncated");
+}
+
+// Чтение заголовка и данных файла одной операцией в память объекта
+template<typename T, typename C>
+void load_binary_data(std::ifstream& in, const std::string& path, const TBinaryHeader& h, C& dst, bool verify)
+{
+    const size_t bytes = size_t(h.rows * h.cols) * sizeof(T);
+    in.seekg(std::streamoff(h.dataOffset));
+    if (!in.read(reinterpret_cast<char*>(dst.data()), std::streamsize(bytes)))
+        throw std::runtime_error("cannot read " + path);
+    if (verify && kernels::checksum(dst.data(), bytes) != h.checksum)
+        throw std::runtime_error("checksum mismatch");
+}
+
+inline TBinaryHeader read_binary_header(std::ifstream& in, const std::string& path, uint64_t& fileSize)
+{
+    if (!in)
+        throw std::runtime_error("cannot open " + path);
+    in.seekg(0, std::ios::end);
+    fileSize = uint64_t(in.tellg());
+    in.seekg(0);
+    TBinaryHeader h;
+    if (fileSize < sizeof(h) || !in.read(reinterpret_cast<char*>(&h), sizeof(h)))
+        throw std::runtime_error("not a matrix file");
+    return h;
+}
+
+// Загрузка в обычную память. verify - сверить контрольную сумму.
+template<typename T>
+TDynamicVector<T> load_vector(const std::string& path, bool verify = true)
+{
+    std::ifstream in(path.c_str(), std::ios::binary);
+    uint64_t fileSize;
+    const TBinaryHeader h = read_binary_header(in, path, fileSize);
+    check_binary_header<T>(h, fileSize);
+    if (h.cols != 1) throw logic_error("not a vector");
+    TDynamicVector<T> v(size_t(h.rows), uninitialized);
+    load_binary_data<T>(in, path, h, v, verify);
+    return v;
+}
+
+template<typename T>
+TDynamicMatrix<T> load_matrix(const std::string& path, bool verify = true)
+{
+    std::ifstream in(path.c_str(), std::ios::binary);
+    uint64_t fileSize;
+    const TBinaryHeader h = read_binary_header(in, path, fileSize);
+    check_binary_header<T>(h, fileSize);
+    if (h.rows != h.cols) throw logic_error("matrix is not square");
+    TDynamicMatrix<T> m(size_t(h.rows), uninitialized);
+    load_binary_data<T>(in, path, h, m, verify);
+    return m;
+}
+
+template<typename T>
+TRectMatrix<T> load_rect_matrix(const std::string& path, bool verify = true)
+{
+    std::ifstream in(path.c_str(), std::ios::binary);
+    uint64_t fileSize;
+    const TBinaryHeader h = read_binary_header(in, path, fileSize);
+    check_binary_header<T>(h, fileSize);
+    TRectMatrix<T> m(size_t(h.rows), size_t(h.cols), uninitialized);
+    load_binary_data<T>(in, path, h, m, verify);
+    return m;
+}
+
+// Загрузка без копирования: данные остаются в отображённом файле.
+// Проверка контрольной суммы читает весь файл, поэтому по умолчанию
+// отключена.
+template<typename T>
+TBinaryHeader binary_header(const TMappedFile& f, bool verify = false)
+{
+    TBinaryHeader h;
+    if (f.size() < sizeof(h))
+        throw std::runtime_error("not a matrix file");
+    std::memcpy(&h, f.data(), sizeof(h));
+    check_binary_header<T>(h, f.size());
+    if (verify && kernels::checksum(f.data() + h.dataOffset, size_t(h.rows * h.cols) * sizeof(T)) != h.checksum)
+        throw std::runtime_error("checksum mismatch");
+    return h;
+}
+
+// Матрица над файлом изменяема, поэтому файл должен быть открыт не только
+// для чтения; для MAPPED_READ_ONLY - logic_error (см. map_binary_view)
+template<typename T>
+TRectMatrix<T, TMappedAllocator<T>> map_binary_matrix(const std::shared_ptr<TMappedFile>& f, bool verify = false)
+{
+    if (f->mode() == MAPPED_READ_ONLY)
+        throw logic_error("read-only file: map it copy-on-write or use map_binary_view with const elements");
+    const TBinaryHeader h = binary_header<T>(*f, verify);
+    return map_rect_matrix<T>(f, size_t(h.rows), size_t(h.cols), size_t(h.dataOffset));
+}
+
+// Файл path отображается с копированием при записи: страницы общие с
+// кэшем ОС, пока их не изменят, а изменения в файл не попадают
+template<typename T>
+TRectMatrix<T, TMappedAllocator<T>> map_binary_matrix(const std::string& path, bool verify = false)
+{
+    return map_binary_matrix<T>(std::make_shared<TMappedFile>(path, MAPPED_COPY_ON_WRITE), verify);
+}
+
+// Представление без ограничения размера; для файла только для чтения
+// T - константный тип
+template<typename T>
+TMatrixView<T> map_binary_view(const TMappedFile& f, bool verify = false)
+{
+    const TBinaryHeader h = binary_header<typename std::remove_const<T>::type>(f, verify);
+    return map_view<T>(f, size_t(h.rows), size_t(h.cols), size_t(h.dataOffset));
+}
+
+#endif
@@ -0,0 +1,205 @@
+// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Блочная разреженная матрица (формат BSR)
+//
+// Матрица делится на плотные блоки B x B (B задаётся при компиляции),
+// хранятся только ненулевые блоки (формат - см. tsparse.h). По сравнению
+// с CSR один номер столбца приходится на B * B значений, а умножение
+// блока на вектор идёт развёрнутым циклом постоянной длины. Подходит для
+// матриц МКЭ с 3 x 3 и 4 x 4 блоками.
+
+#ifndef __TBSRMatrix_H__
+#define __TBSRMatrix_H__
+
+#include "tcsrmatrix.h"
+
+template<typename T, size_t B, typename Alloc = TAlignedAllocator<T>>
+class TBSRMatrix
+{
+    static_assert(B > 0, "block size should be greater than zero");
+public:
+    typedef T value_type;
+    typedef Alloc allocator_type;
+    typedef uint32_t index_type;
+    static const size_t block_size = B;
+private:
+    typedef typename std::allocator_traits<Alloc>::template rebind_alloc<size_t> TPtrAlloc;
+    typedef typename std::allocator_traits<Alloc>::template rebind_alloc<index_type> TIndexAlloc;
+
+    size_t nrows, ncols;
+    std::vector<size_t, TPtrAlloc> ptr;       // по блочным строкам
+    std::vector<index_type, TIndexAlloc> ind; // блочные столбцы
+    std::vector<T, Alloc> val;                // блоки по B * B элементов
+
+    static size_t checked(size_t size)
+    {
+        if (size == 0 || size > MAX_VECTOR_SIZE)
+            throw length_error("Matrix size should be greater than zero and less than MAX_VECTOR_SIZE");
+        if (size % B != 0)
+            throw length_error("Matrix size should be a multiple of the block size");
+        return size;
+    }
+
+    // блочные строки: для каждой - отсортированные номера ненулевых
+    // блочных столбцов, затем значения копирует fill(i, j, k, block)
+    template<typename F>
+    void build(const std::vector<std::vector<index_type>>& cols, const F& fill)
+    {
+        size_t nnzb = 0;
+        for (size_t i = 0; i < cols.size(); i++) {
+            nnzb += cols[i].size();
+            ptr[i + 1] = nnzb;
+        }
+        ind.resize(nnzb);
+        val.assign(nnzb * B * B, T());
+        for (size_t i = 0; i < cols.size(); i++)
+            for (size_t k = 0; k < cols[i].size(); k++) {
+                ind[ptr[i] + k] = cols[i][k];
+                fill(i, size_t(cols[i][k]), val.data() + (ptr[i] + k) * B * B);
+            }
+    }
+public:
+    // нулевая матрица
+    TBSRMatrix(size_t s = B, const Alloc& a = Alloc()) : TBSRMatrix(s, s, a) {}
+    TBSRMatrix(size_t rows, size_t cols, const Alloc& a = Alloc())
+        : nrows(checked(rows)), ncols(checked(cols)), ptr(nrows / B + 1, 0, TPtrAlloc(a)),
+          ind(TIndexAlloc(a)), val(a) {}
+    // блоки плотной матрицы, в которых есть ненулевые элементы
+    template<typename A>
+    explicit TBSRMatrix(const TDynamicMatrix<T, A>& m, const Alloc& a = Alloc())
+        : TBSRMatrix(m.size(), m.size(), a)
+    {
+        const size_t n = nrows, nb = n / B;
+        std::vector<std::vector<index_type>> cols(nb);
+        for (size_t i = 0; i < nb; i++)
+            for (size_t j = 0; j < nb; j++) {
+                bool nz = false;
+                for (size_t r = 0; r < B && !nz; r++)
+                    for (size_t c = 0; c < B && !nz; c++)
+                        nz = m.data()[(i * B + r) * n + j * B + c] != T();
+                if (nz)
+                    cols[i].push_back(index_type(j));
+            }
+        build(cols, [&](size_t i, size_t j, T* block) {
+            for (size_t r = 0; r < B; r++)
+                mem_copy(m.data() + (i * B + r) * n + j * B, B, block + r * B);
+        });
+    }
+    // блоки, в которые попадают элементы матрицы CSR
+    template<typename A>
+    explicit TBSRMatrix(const TCSRMatrix<T, A>& m, const Alloc& a = Alloc())
+        : TBSRMatrix(m.rows(), m.cols(), a)
+    {
+        const size_t mb = nrows / B;
+        const size_t* mptr = m.row_ptr();
+        const typename TCSRMatrix<T, A>::index_type* mind = m.col_index();
+        std::vector<std::vector<index_type>> cols(mb);
+        std::vector<size_t> mark(ncols / B, size_t(-1));
+        for (size_t i = 0; i < mb; i++) {
+            for (size_t k = mptr[i * B]; k < mptr[(i + 1) * B]; k++) {
+                const size_t j = mind[k] / B;
+                if (mark[j] != i) {
+                    mark[j] = i;
+                    cols[i].push_back(index_type(j));
+                }
+            }
+            std::sort(cols[i].begin(), cols[i].end());
+        }
+        // строки CSR отсортированы, поэтому блоки строки идут по порядку
+        build(cols, [&](size_t i, size_t j, T* block) {
+            for (size_t r = 0; r < B; r++) {
+                const size_t row = i * B + r;
+                const size_t* first = mptr + row;
+                const auto* p = std::lower_bound(mind + first[0], mind + first[1], j * B);
+                for (; p != mind + first[1] && *p < (j + 1) * B; p++)
+                    block[r * B + *p - j * B] = m.values()[p - mind];
+            }
+        });
+    }
+
+    size_t rows() const noexcept { return nrows; }
+    size_t cols() const noexcept { return ncols; }
+    size_t block_rows() const noexcept { return nrows / B; }
+    size_t block_cols() const noexcept { return ncols / B; }
+    size_t nonzero_blocks() const noexcept { return ind.size(); }
+
+    // непосредственный доступ к массивам BSR
+    const size_t* row_ptr() const noexcept { return ptr.data(); }
+    const index_type* col_index() const noexcept { return ind.data(); }
+    T* values() noexcept { return val.data(); }
+    const T* values() const noexcept { return val.data(); }
+
+    // значение любого элемента, включая нулевые
+    T get(size_t i, size_t j) const
+    {
+        if (i >= nrows || j >= ncols) throw out_of_range("out of range");
+        const index_type* first = ind.data() + ptr[i / B];
+        const index_type* last = ind.data() + ptr[i / B + 1];
+        const index_type* p = std::lower_bound(first, last, index_type(j / B));
+        return p != last && *p == j / B ? val[(p - ind.data()) * B * B + i % B * B + j % B] : T();
+    }
+
+    TDynamicMatrix<T, Alloc> dense() const
+    {
+        if (nrows != ncols) throw logic_error("matrix is not square");
+        TDynamicMatrix<T, Alloc> res(nrows, val.get_allocator());
+        for (size_t i = 0; i < nrows / B; i++)
+            for (size_t k = ptr[i]; k < ptr[i + 1]; k++)
+                for (size_t r = 0; r < B; r++)
+                    mem_copy(val.data() + k * B * B + r * B, B, res.data() + (i * B + r) * ncols + size_t(ind[k]) * B);
+        return res;
+    }
+
+    // ненулевые элементы в формате CSR
+    TCSRMatrix<T, Alloc> csr() const
+    {
+        TCOOBuilder<T> b(nrows, ncols);
+        for (size_t i = 0; i < nrows / B; i++)
+            for (size_t k = ptr[i]; k < ptr[i + 1]; k++)
+                for (size_t r = 0; r < B; r++)
+                    for (size_t c = 0; c < B; c++)
+                        if (val[k * B * B + r * B + c] != T())
+                            b.add(i * B + r, size_t(ind[k]) * B + c, val[k * B * B + r * B + c]);
+        return TCSRMatrix<T, Alloc>(b, val.get_allocator());
+    }
+
+    TBSRMatrix& operator*=(const T& s)
+    {
+        if (!val.empty())
+            kernels::scale(val.size(), val.data(), s, val.data());
+        return *this;
+    }
+
+    allocator_type get_allocator() const { return val.get_allocator(); }
+
+    friend void swap(TBSRMatrix& lhs, TBSRMatrix& rhs) noexcept
+    {
+        std::swap(lhs.nrows, rhs.nrows);
+        std::swap(lhs.ncols, rhs.ncols);
+        lhs.ptr.swap(rhs.ptr);
+        lhs.ind.swap(rhs.ind);
+        lhs.val.swap(rhs.val);
+    }
+};
+
+// умножение на вектор
+template<typename T, size_t B, typename A, typename R>
+TDynamicVector<T, A> operator*(const TBSRMatrix<T, B, A>& a, const TExpr<R, TVectorTag>& r)
+{
+    const auto& x = materialize(r.self());
+    if (a.cols() != x.size()) throw logic_error("different lengths");
+    TDynamicVector<T, A> res(a.rows(), uninitialized, a.get_allocator());
+    kernels::bsr_spmv<B>(a.block_rows(), T(1), a.row_ptr(), a.col_index(), a.values(), x.data(), T(), res.data());
+    return res;
+}
+
+// y = alpha A x + beta y
+template<typename T, size_t B, typename AA, typename AX, typename AY>
+void spmv(T alpha, const TBSRMatrix<T, B, AA>& a, const TDynamicVector<T, AX>& x, T beta, TDynamicVector<T, AY>& y)
+{
+    if (a.cols() != x.size() || a.rows() != y.size()) throw logic_error("different lengths");
+    if (x.data() == y.data()) throw logic_error("result must not alias an operand");
+    kernels::bsr_spmv<B>(a.block_rows(), alpha, a.row_ptr(), a.col_index(), a.values(), x.data(), beta, y.data());
+}
+
+#endif
@@ -0,0 +1,250 @@
+// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Разреженная матрица в формате CSR
+//
+// Хранятся только ненулевые элементы (формат - см. tsparse.h), поэтому
+// размеры ограничены не MAX_MATRIX_SIZE, а длиной векторов
+// (MAX_VECTOR_SIZE), и матрица может быть прямоугольной. Матрица
+// собирается из троек (i, j, значение) построителем TCOOBuilder.
+// Умножение на вектор требует O(nnz) операций, произведение разреженных
+// матриц - порядка числа ненулевых попарных произведений.
+
+#ifndef __TCSRMatrix_H__
+#define __TCSRMatrix_H__
+
+#include <cstdint>
+#include <vector>
+#include "tmatrix.h"
+#include "tsparse.h"
+
+// Построитель: тройки добавляются в любом порядке, повторяющиеся
+// элементы при сборке матрицы складываются
+template<typename T>
+class TCOOBuilder
+{
+public:
+    struct TTriplet
+    {
+        size_t row;
+        size_t col;
+        T val;
+    };
+private:
+    size_t nrows, ncols;
+    std::vector<TTriplet> items;
+public:
+    TCOOBuilder(size_t rows, size_t cols) : nrows(rows), ncols(cols)
+    {
+        if (rows == 0 || cols == 0 || rows > MAX_VECTOR_SIZE || cols > MAX_VECTOR_SIZE)
+            throw length_error("Matrix size should be greater than zero and less than MAX_VECTOR_SIZE");
+    }
+
+    size_t rows() const noexcept { return nrows; }
+    size_t cols() const noexcept { return ncols; }
+    size_t count() const noexcept { return items.size(); }
+    const TTriplet* data() const noexcept { return items.data(); }
+
+    void reserve(size_t n) { items.reserve(n); }
+    void clear() noexcept { items.clear(); }
+
+    void add(size_t i, size_t j, const T& val)
+    {
+        if (i >= nrows || j >= ncols) throw out_of_range("out of range");
+        items.push_back(TTriplet{ i, j, val });
+    }
+};
+
+template<typename T, typename Alloc = TAlignedAllocator<T>>
+class TCSRMatrix
+{
+public:
+    typedef T value_type;
+    typedef Alloc allocator_type;
+    typedef uint32_t index_type;   // номера столбцов: вдвое меньше трафика, чем size_t
+private:
+    typedef typename std::allocator_traits<Alloc>::template rebind_alloc<size_t> TPtrAlloc;
+    typedef typename std::allocator_traits<Alloc>::template rebind_alloc<index_type> TIndexAlloc;
+
+    size_t nrows, ncols;
+    std::vector<size_t, TPtrAlloc> ptr;
+    std::vector<index_type, TIndexAlloc> ind;
+    std::vector<T, Alloc> val;
+
+    static size_t checked(size_t size)
+    {
+        if (size == 0 || size > MAX_VECTOR_SIZE)
+            throw length_error("Matrix size should be greater than zero and less than MAX_VECTOR_SIZE");
+        return size;
+    }
+public:
+    // нулевая матрица
+    TCSRMatrix(size_t s = 1, const Alloc& a = Alloc()) : TCSRMatrix(s, s, a) {}
+    TCSRMatrix(size_t rows, size_t cols, const Alloc& a = Alloc())
+        : nrows(checked(rows)), ncols(checked(cols)), ptr(nrows + 1, 0, TPtrAlloc(a)),
+          ind(TIndexAlloc(a)), val(a) {}
+    // место под nnz элементов; вызывающий код обязан заполнить row_ptr(),
+    // col_index() и values()
+    TCSRMatrix(size_t rows, size_t cols, size_t nnz, TUninitialized, const Alloc& a = Alloc())
+        : nrows(checked(rows)), ncols(checked(cols)), ptr(nrows + 1, 0, TPtrAlloc(a)),
+          ind(nnz, 0, TIndexAlloc(a)), val(nnz, T(), a) {}
+    // сборка из троек: сортировка подсчётом по строкам, затем по столбцам
+    // внутри строки, повторы складываются
+    explicit TCSRMatrix(const TCOOBuilder<T>& b, const Alloc& a = Alloc())
+        : TCSRMatrix(b.rows(), b.cols(), a)
+    {
+        const size_t n = b.count();
+        const typename TCOOBuilder<T>::TTriplet* items = b.data();
+        std::vector<size_t> next(nrows + 1, 0);
+        for (size_t k = 0; k < n; k++)
+            next[items[k].row + 1]++;
+        for (size_t i = 0; i < nrows; i++)
+            next[i + 1] += next[i];
+        std::vector<std::pair<index_type, T>> sorted(n);
+        for (size_t k = 0; k < n; k++)
+            sorted[next[items[k].row]++] = std::make_pair(index_type(items[k].col), items[k].val);
+
+        ind.reserve(n);
+        val.reserve(n);
+        size_t begin = 0;
+        for (size_t i = 0; i < nrows; i++) {
+            const size_t end = next[i];
+            // устойчивая сортировка: повторы складываются в порядке добавления
+            std::stable_sort(sorted.begin() + begin, sorted.begin() + end,
+                [](const std::pair<index_type, T>& l, const std::pair<index_type, T>& r) { return l.first < r.first; });
+            for (size_t k = begin; k < end; k++) {
+                if (k > begin && sorted[k].first == ind.back())
+                    val.back() += sorted[k].second;
+                else {
+                    ind.push_back(sorted[k].first);
+                    val.push_back(sorted[k].second);
+                }
+            }
+            ptr[i + 1] = ind.size();
+            begin = end;
+        }
+    }
+    // ненулевые элементы плотной матрицы
+    template<typename A>
+    explicit TCSRMatrix(const TDynamicMatrix<T, A>& m, const Alloc& a = Alloc())
+        : TCSRMatrix(m.size(), m.size(), a)
+    {
+        for (size_t i = 0; i < nrows; i++) {
+            const T* row = m.data() + i * ncols;
+            for (size_t j = 0; j < ncols; j++)
+                if (row[j] != T()) {
+                    ind.push_back(index_type(j));
+                    val.push_back(row[j]);
+                }
+            ptr[i + 1] = ind.size();
+        }
+    }
+
+    size_t rows() const noexcept { return nrows; }
+    size_t cols() const noexcept { return ncols; }
+    size_t nonzeros() const noexcept { return val.size(); }
+    // доля ненулевых элементов
+    double density() const noexcept { return double(val.size()) / (double(nrows) * double(ncols)); }
+
+    // непосредственный доступ к массивам CSR
+    size_t* row_ptr() noexcept { return ptr.data(); }
+    const size_t* row_ptr() const noexcept { return ptr.data(); }
+    index_type* col_index() noexcept { return ind.data(); }
+    const index_type* col_index() const noexcept { return ind.data(); }
+    T* values() noexcept { return val.data(); }
+    const T* values() const noexcept { return val.data(); }
+
+    // значение любого элемента, включая нулевые; поиск делением пополам
+    T get(size_t i, size_t j) const
+    {
+        if (i >= nrows || j >= ncols) throw out_of_range("out of range");
+        const index_type* first = ind.data() + ptr[i];
+        const index_type* last = ind.data() + ptr[i + 1];
+        const index_type* p = std::lower_bound(first, last, index_type(j));
+        return p != last && *p == j ? val[p - ind.data()] : T();
+    }
+
+    TDynamicMatrix<T, Alloc> dense() const
+    {
+        if (nrows != ncols) throw logic_error("matrix is not square");
+        TDynamicMatrix<T, Alloc> res(nrows, val.get_allocator());
+        for (size_t i = 0; i < nrows; i++)
+            for (size_t k = ptr[i]; k < ptr[i + 1]; k++)
+                res.data()[i * ncols + ind[k]] = val[k];
+        return res;
+    }
+
+    // сравнение: одинаковые размеры, структура и значения
+    bool operator==(const TCSRMatrix& m) const noexcept
+    {
+        return nrows == m.nrows && ncols == m.ncols && ptr == m.ptr && ind == m.ind && val == m.val;
+    }
+    bool operator!=(const TCSRMatrix& m) const noexcept
+    {
+        return !(*this == m);
+    }
+
+    TCSRMatrix& operator*=(const T& s)
+    {
+        if (!val.empty())
+            kernels::scale(val.size(), val.data(), s, val.data());
+        return *this;
+    }
+
+    allocator_type get_allocator() const { return val.get_allocator(); }
+
+    friend void swap(TCSRMatrix& lhs, TCSRMatrix& rhs) noexcept
+    {
+        std::swap(lhs.nrows, rhs.nrows);
+        std::swap(lhs.ncols, rhs.ncols);
+        lhs.ptr.swap(rhs.ptr);
+        lhs.ind.swap(rhs.ind);
+        lhs.val.swap(rhs.val);
+    }
+
+    // вывод: по строке "i j значение" на каждый ненулевой элемент
+    friend ostream& operator<<(ostream& ostr, const TCSRMatrix& m)
+    {
+        for (size_t i = 0; i < m.nrows; i++)
+            for (size_t k = m.ptr[i]; k < m.ptr[i + 1]; k++)
+                ostr << i << ' ' << m.ind[k] << ' ' << m.val[k] << endl;
+        return ostr;
+    }
+};
+
+// умножение на вектор
+template<typename T, typename A, typename R>
+TDynamicVector<T, A> operator*(const TCSRMatrix<T, A>& a, const TExpr<R, TVectorTag>& r)
+{
+    const auto& x = materialize(r.self());
+    if (a.cols() != x.size()) throw logic_error("different lengths");
+    TDynamicVector<T, A> res(a.rows(), uninitialized, a.get_allocator());
+    kernels::csr_spmv(a.rows(), T(1), a.row_ptr(), a.col_index(), a.values(), x.data(), T(), res.data());
+    return res;
+}
+
+// произведение разреженных матриц, без перехода к плотному формату
+template<typename T, typename A, typename AB>
+TCSRMatrix<T, A> operator*(const TCSRMatrix<T, A>& a, const TCSRMatrix<T, AB>& b)
+{
+    if (a.cols() != b.rows()) throw logic_error("different lengths");
+    const size_t m = a.rows(), n = b.cols();
+    std::vector<size_t> flops(m + 1), ptr(m + 1);
+    kernels::csr_spgemm_symbolic(m, n, a.row_ptr(), a.col_index(), b.row_ptr(), b.col_index(),
+        flops.data(), ptr.data());
+    TCSRMatrix<T, A> res(m, n, ptr[m], uninitialized, a.get_allocator());
+    std::copy(ptr.begin(), ptr.end(), res.row_ptr());
+    kernels::csr_spgemm_numeric(m, n, a.row_ptr(), a.col_index(), a.values(),
+        b.row_ptr(), b.col_index(), b.values(), flops.data(), res.row_ptr(), res.col_index(), res.values());
+    return res;
+}
+
+// y = alpha A x + beta y
+template<typename T, typename AA, typename AX, typename AY>
+void spmv(T alpha, const TCSRMatrix<T, AA>& a, const TDynamicVector<T, AX>& x, T beta, TDynamicVector<T, AY>& y)
+{
+    if (a.cols() != x.size() || a.rows() != y.size()) throw logic_error("different lengths");
+    if (x.data() == y.data()) throw logic_error("result must not alias an operand");
+    kernels::csr_spmv(a.rows(), alpha, a.row_ptr(), a.col_index(), a.values(), x.data(), beta, y.data());
+}
+
+#endif
@@ -0,0 +1,97 @@
+// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Ядра для диагональных матриц и матриц перестановки
+//
+// Диагональная матрица задаётся вектором d, матрица перестановки -
+// массивом p: в строке i единица стоит в столбце p[i], так что
+// (P x)[i] = x[p[i]]. Произведения с вектором требуют O(n), с плотной
+// матрицей - O(n^2) операций.
+
+#ifndef __TDiag_H__
+#define __TDiag_H__
+
+#include <cstddef>
+#include "tmemory.h"
+#include "tsimd.h"
+
+namespace kernels
+{
+
+// body(ib, ie) над строками [0, n) длины len, параллельно для больших матриц
+template<typename F>
+void for_rows(size_t n, size_t len, const F& body)
+{
+    if (n * len < PARALLEL_MIN_ELEMENTS)
+        body(0, n);
+    else {
+        const size_t rows = PARALLEL_GRAIN / len;
+        TThreadPool::instance().parallel_for(0, n, rows < 4 ? 4 : rows, body);
+    }
+}
+
+// y = D x
+template<typename T>
+void diag_mul(size_t n, const T* d, const T* x, T* y)
+{
+    for_rows(n, 1, [&](size_t ib, size_t ie) {
+        for (size_t i = ib; i < ie; i++)
+            y[i] = d[i] * x[i];
+    });
+}
+
+// C = D A: строка i умножается на d[i]
+template<typename T>
+void diag_scale_rows(size_t n, const T* d, const T* a, T* c)
+{
+    const TKernelTable<T>& t = kernel_table<T>();
+    for_rows(n, n, [&](size_t ib, size_t ie) {
+        for (size_t i = ib; i < ie; i++)
+            t.scale(n, a + i * n, d[i], c + i * n);
+    });
+}
+
+// C = A D: столбец j умножается на d[j]
+template<typename T>
+void diag_scale_cols(size_t n, const T* d, const T* a, T* c)
+{
+    for_rows(n, n, [&](size_t ib, size_t ie) {
+        for (size_t i = ib; i < ie; i++)
+            for (size_t j = 0; j < n; j++)
+                c[i * n + j] = a[i * n + j] * d[j];
+    });
+}
+
+// y = P x
+template<typename T>
+void perm_gather(size_t n, const size_t* p, const T* x, T* y)
+{
+    for_rows(n, 1, [&](size_t ib, size_t ie) {
+        for (size_t i = ib; i < ie; i++)
+            y[i] = x[p[i]];
+    });
+}
+
+// C = P A: строка i результата - строка p[i] из A
+template<typename T>
+void perm_rows(size_t n, const size_t* p, const T* a, T* c)
+{
+    for_rows(n, n, [&](size_t ib, size_t ie) {
+        for (size_t i = ib; i < ie; i++)
+            mem_copy(a + p[i] * n, n, c + i * n);
+    });
+}
+
+// C = A P: столбец k из A становится столбцом p[k]
+template<typename T>
+void perm_cols(size_t n, const size_t* p, const T* a, T* c)
+{
+    for_rows(n, n, [&](size_t ib, size_t ie) {
+        for (size_t i = ib; i < ie; i++)
+            for (size_t k = 0; k < n; k++)
+                c[i * n + p[k]] = a[i * n + k];
+    });
+}
+
+} // namespace kernels
+
+#endif
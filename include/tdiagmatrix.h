@@ -0,0 +1,265 @@
+// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Диагональная и единичная матрицы
+//
+// Диагональная матрица хранит только n элементов диагонали, единичная -
+// только порядок. Произведения с векторами и плотными матрицами
+// считаются ядрами из tdiag.h за O(n) и O(n^2) операций, плотная форма
+// не строится.
+
+#ifndef __TDiagonalMatrix_H__
+#define __TDiagonalMatrix_H__
+
+#include "tmatrix.h"
+#include "tdiag.h"
+
+// Вид операнда: диагональные матрицы смешиваются только между собой
+struct TDiagonalTag
+{
+    static const char* mismatch() { return "different lengths"; }
+};
+// прибавление скаляра заполнило бы нули вне диагонали
+template<>
+struct TExprScalarShift<TDiagonalTag> : std::false_type {};
+
+template<typename T, typename Alloc = TAlignedAllocator<T>>
+class TDiagonalMatrix : public TExpr<TDiagonalMatrix<T, Alloc>, TDiagonalTag>
+{
+    TDynamicVector<T, Alloc> diag;
+public:
+    typedef T value_type;
+    typedef Alloc allocator_type;
+
+    TDiagonalMatrix(size_t s = 1, const Alloc& a = Alloc()) : diag(s, a) {}
+    TDiagonalMatrix(size_t s, TUninitialized, const Alloc& a = Alloc()) : diag(s, uninitialized, a) {}
+    // диагональ из вектора
+    template<typename A>
+    explicit TDiagonalMatrix(const TDynamicVector<T, A>& d, const Alloc& a = Alloc())
+        : diag(d.data(), d.size(), a) {}
+    // вычисление выражения за один проход
+    template<typename E>
+    TDiagonalMatrix(const TExpr<E, TDiagonalTag>& e, const Alloc& a = Alloc())
+        : diag(e.self().size(), uninitialized, a)
+    {
+        static_assert(std::is_same<typename E::value_type, T>::value, "element types differ");
+        expr_assign(diag.data(), e.self());
+    }
+    TDiagonalMatrix(const TDiagonalMatrix& m) = default;
+    TDiagonalMatrix(TDiagonalMatrix&& m) = default;
+    TDiagonalMatrix& operator=(const TDiagonalMatrix& m) = default;
+    TDiagonalMatrix& operator=(TDiagonalMatrix&& m) = default;
+    template<typename E>
+    TDiagonalMatrix& operator=(const TExpr<E, TDiagonalTag>& e)
+    {
+        if (size() != e.self().size()) {
+            TDiagonalMatrix tmp(e);
+            swap(*this, tmp);
+        }
+        else
+            expr_assign(diag.data(), e.self());
+        return *this;
+    }
+
+    size_t size() const noexcept { return diag.size(); }
+    size_t count() const noexcept { return diag.size(); }
+    const T& elem(size_t i) const { return diag.data()[i]; }
+
+    T* data() noexcept { return diag.data(); }
+    const T* data() const noexcept { return diag.data(); }
+
+    // индексация: i-й элемент диагонали
+    T& operator[](size_t ind) { return diag[ind]; }
+    const T& operator[](size_t ind) const { return diag[ind]; }
+    T& at(size_t ind) { return diag.at(ind); }
+    const T& at(size_t ind) const { return diag.at(ind); }
+    // значение любого элемента
+    T get(size_t i, size_t j) const
+    {
+        if (i >= size() || j >= size()) throw out_of_range("out of range");
+        return i == j ? diag[i] : T();
+    }
+
+    TDynamicMatrix<T, Alloc> dense() const
+    {
+        TDynamicMatrix<T, Alloc> res(size(), diag.get_allocator());
+        for (size_t i = 0; i < size(); i++)
+            res[i][i] = diag[i];
+        return res;
+    }
+
+    // операции с присваиванием, без выделения памяти
+    template<typename E>
+    TDiagonalMatrix& operator+=(const TExpr<E, TDiagonalTag>& e)
+    {
+        expr_assign(diag.data(), *this + e.self());
+        return *this;
+    }
+    template<typename E>
+    TDiagonalMatrix& operator-=(const TExpr<E, TDiagonalTag>& e)
+    {
+        expr_assign(diag.data(), *this - e.self());
+        return *this;
+    }
+    TDiagonalMatrix& operator*=(const T& val)
+    {
+        expr_assign(diag.data(), *this * val);
+        return *this;
+    }
+
+    allocator_type get_allocator() const { return diag.get_allocator(); }
+
+    friend void swap(TDiagonalMatrix& lhs, TDiagonalMatrix& rhs) noexcept
+    {
+        swap(lhs.diag, rhs.diag);
+    }
+
+    // ввод/вывод: вводится диагональ, выводится вся матрица
+    friend istream& operator>>(istream& istr, TDiagonalMatrix& v)
+    {
+        return istr >> v.diag;
+    }
+    friend ostream& operator<<(ostream& ostr, const TDiagonalMatrix& v)
+    {
+        for (size_t i = 0; i < v.size(); i++) {
+            for (size_t j = 0; j < v.size(); j++)
+                ostr << v.get(i, j) << ' ';
+            ostr << endl;
+        }
+        return ostr;
+    }
+};
+
+template<typename T, typename A>
+struct TExprDense<TDiagonalMatrix<T, A>> : std::true_type {};
+template<typename T, typename A>
+struct TExprOwner<TDiagonalMatrix<T, A>> : std::true_type {};
+
+template<typename T, typename A>
+const TDiagonalMatrix<T, A>& materialize(const TDiagonalMatrix<T, A>& m) { return m; }
+template<typename E>
+TDiagonalMatrix<typename E::value_type> materialize(const TExpr<E, TDiagonalTag>& e)
+{
+    return TDiagonalMatrix<typename E::value_type>(e);
+}
+
+// Произведения. Результат получает аллокатор левого операнда.
+
+// D x
+template<typename L, typename R>
+TDynamicVector<typename L::value_type, typename TExprAllocator<L>::type>
+operator*(const TExpr<L, TDiagonalTag>& l, const TExpr<R, TVectorTag>& r)
+{
+    typedef typename L::value_type T;
+    const auto& d = materialize(l.self());
+    const auto& x = materialize(r.self());
+    if (d.size() != x.size()) throw logic_error("different lengths");
+    TDynamicVector<T, typename TExprAllocator<L>::type> res(d.size(), uninitialized, d.get_allocator());
+    kernels::diag_mul(d.size(), d.data(), x.data(), res.data());
+    return res;
+}
+
+// D1 D2
+template<typename L, typename R>
+TDiagonalMatrix<typename L::value_type, typename TExprAllocator<L>::type>
+operator*(const TExpr<L, TDiagonalTag>& l, const TExpr<R, TDiagonalTag>& r)
+{
+    typedef typename L::value_type T;
+    const auto& a = materialize(l.self());
+    const auto& b = materialize(r.self());
+    if (a.size() != b.size()) throw logic_error("different lengths");
+    TDiagonalMatrix<T, typename TExprAllocator<L>::type> res(a.size(), uninitialized, a.get_allocator());
+    kernels::diag_mul(a.size(), a.data(), b.data(), res.data());
+    return res;
+}
+
+// D A - масштабирование строк
+template<typename L, typename R>
+TDynamicMatrix<typename L::value_type, typename TExprAllocator<L>::type>
+operator*(const TExpr<L, TDiagonalTag>& l, const TExpr<R, TMatrixTag>& r)
+{
+    typedef typename L::value_type T;
+    const auto& d = materialize(l.self());
+    const auto& a = materialize(r.self());
+    if (d.size() != a.size()) throw logic_error("different lengths");
+    TDynamicMatrix<T, typename TExprAllocator<L>::type> res(a.size(), uninitialized, d.get_allocator());
+    kernels::diag_scale_rows(a.size(), d.data(), a.data(), res.data());
+    return res;
+}
+
+// A D - масштабирование столбцов
+template<typename L, typename R>
+TDynamicMatrix<typename L::value_type, typename TExprAllocator<L>::type>
+operator*(const TExpr<L, TMatrixTag>& l, const TExpr<R, TDiagonalTag>& r)
+{
+    typedef typename L::value_type T;
+    const auto& a = materialize(l.self());
+    const auto& d = materialize(r.self());
+    if (d.size() != a.size()) throw logic_error("different lengths");
+    TDynamicMatrix<T, typename TExprAllocator<L>::type> res(a.size(), uninitialized, a.get_allocator());
+    kernels::diag_scale_cols(a.size(), d.data(), a.data(), res.data());
+    return res;
+}
+
+// Единичная матрица: хранится только порядок, произведение с ней -
+// копия второго операнда
+class TIdentityMatrix
+{
+    size_t sz;
+public:
+    explicit TIdentityMatrix(size_t s = 1) : sz(s)
+    {
+        if (s == 0 || s > MAX_VECTOR_SIZE)
+            throw length_error("Matrix size should be greater than zero");
+    }
+
+    size_t size() const noexcept { return sz; }
+    // элемент (i, j) типа T, как у dense<T>() и других форматов
+    template<typename T = double>
+    T get(size_t i, size_t j) const
+    {
+        if (i >= sz || j >= sz) throw out_of_range("out of range");
+        return i == j ? T(1) : T();
+    }
+
+    template<typename T>
+    TDynamicMatrix<T> dense() const
+    {
+        TDynamicMatrix<T> res(sz);
+        for (size_t i = 0; i < sz; i++)
+            res[i][i] = T(1);
+        return res;
+    }
+    template<typename T>
+    TDiagonalMatrix<T> diagonal() const
+    {
+        TDiagonalMatrix<T> res(sz, uninitialized);
+        mem_fill(res.data(), sz, T(1));
+        return res;
+    }
+
+    bool operator==(const TIdentityMatrix& m) const noexcept { return sz == m.sz; }
+    bool operator!=(const TIdentityMatrix& m) const noexcept { return sz != m.sz; }
+};
+
+template<typename R>
+TDynamicVector<typename R::value_type> operator*(const TIdentityMatrix& e, const TExpr<R, TVectorTag>& r)
+{
+    if (e.size() != r.self().size()) throw logic_error("different lengths");
+    return TDynamicVector<typename R::value_type>(r);
+}
+
+template<typename R>
+TDynamicMatrix<typename R::value_type> operator*(const TIdentityMatrix& e, const TExpr<R, TMatrixTag>& r)
+{
+    if (e.size() != r.self().size()) throw logic_error("different lengths");
+    return TDynamicMatrix<typename R::value_type>(r);
+}
+
+template<typename L>
+TDynamicMatrix<typename L::value_type> operator*(const TExpr<L, TMatrixTag>& l, const TIdentityMatrix& e)
+{
+    if (e.size() != l.self().size()) throw logic_error("different lengths");
+    return TDynamicMatrix<typename L::value_type>(l);
+}
+
+#endif
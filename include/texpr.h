@@ -0,0 +1,377 @@
+// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Шаблоны выражений
+//
+// Поэлементные операции (+, - над операндами одной формы, +, -, * со
+// скаляром) не вычисляются сразу, а возвращают лёгкий узел выражения.
+// Выражение целиком вычисляется за один проход при присваивании или
+// конструировании результата, без промежуточных временных объектов.
+// Узлы хранят листья (векторы, матрицы) по ссылке, поэтому выражение
+// нельзя сохранять дольше, чем живут его операнды.
+
+#ifndef __TExpr_H__
+#define __TExpr_H__
+
+#include <cstddef>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include "tsimd.h"
+#include "tthreadpool.h"
+
+// Вид операнда: выражения разных видов не смешиваются
+struct TVectorTag
+{
+    static const char* mismatch() { return "vectors have different lengths"; }
+};
+struct TMatrixTag
+{
+    static const char* mismatch() { return "different lengths"; }
+};
+
+// Базовый класс выражения (CRTP). Выражение E предоставляет
+//   value_type, size() - длину или порядок, count() - число элементов,
+//   elem(i) - i-й элемент в порядке хранения (для матриц - построчно).
+template<typename E, typename Kind>
+struct TExpr
+{
+    typedef Kind expr_kind;
+    const E& self() const noexcept { return static_cast<const E&>(*this); }
+};
+
+// Признак промежуточного узла: узлы хранятся по значению, листья - по ссылке
+struct TExprNode {};
+
+template<typename E>
+struct TExprStore
+{
+    typedef typename std::conditional<std::is_base_of<TExprNode, E>::value, const E, const E&>::type type;
+};
+
+// Лист с непрерывным хранением (есть data()): для него работают SIMD-ядра
+template<typename E>
+struct TExprDense : std::false_type {};
+
+// Можно ли прибавлять скаляр ко всем элементам. У видов с неявными нулями
+// (треугольные, ленточные матрицы) результат вышел бы за пределы формата.
+template<typename Kind>
+struct TExprScalarShift : std::true_type {};
+
+// Дополнительный параметр формы (например, ширина ленты), который должен
+// совпадать у операндов: лист объявляет метод layout(), узлы берут его
+// у левого операнда
+template<typename E>
+auto expr_layout(const E& e, int) -> decltype(e.layout())
+{
+    return e.layout();
+}
+template<typename E>
+size_t expr_layout(const E&, long)
+{
+    return 0;
+}
+
+struct TOpAdd
+{
+    template<typename T>
+    static T apply(const T& a, const T& b) { return a + b; }
+};
+struct TOpSub
+{
+    template<typename T>
+    static T apply(const T& a, const T& b) { return a - b; }
+};
+struct TOpMul
+{
+    template<typename T>
+    static T apply(const T& a, const T& b) { return a * b; }
+};
+
+// Поэлементная операция над двумя выражениями
+template<typename L, typename R, typename Op>
+class TBinaryExpr : public TExpr<TBinaryExpr<L, R, Op>, typename L::expr_kind>, public TExprNode
+{
+    typename TExprStore<L>::type l;
+    typename TExprStore<R>::type r;
+public:
+    typedef typename L::value_type value_type;
+
+    TBinaryExpr(const L& lhs, const R& rhs) : l(lhs), r(rhs) {}
+
+    const L& lhs() const noexcept { return l; }
+    const R& rhs() const noexcept { return r; }
+    size_t size() const noexcept { return l.size(); }
+    size_t count() const noexcept { return l.count(); }
+    size_t layout() const { return expr_layout(l, 0); }
+    value_type elem(size_t i) const { return Op::apply(l.elem(i), r.elem(i)); }
+};
+
+// Поэлементная операция выражения со скаляром
+template<typename L, typename Op>
+class TScalarExpr : public TExpr<TScalarExpr<L, Op>, typename L::expr_kind>, public TExprNode
+{
+public:
+    typedef typename L::value_type value_type;
+private:
+    typename TExprStore<L>::type l;
+    value_type val;
+public:
+    TScalarExpr(const L& lhs, const value_type& v) : l(lhs), val(v) {}
+
+    const L& lhs() const noexcept { return l; }
+    const value_type& value() const noexcept { return val; }
+    size_t size() const noexcept { return l.size(); }
+    size_t count() const noexcept { return l.count(); }
+    size_t layout() const { return expr_layout(l, 0); }
+    value_type elem(size_t i) const { return Op::apply(l.elem(i), val); }
+};
+
+template<typename L, typename R>
+void expr_check_shape(const L& l, const R& r)
+{
+    static_assert(std::is_same<typename L::value_type, typename R::value_type>::value,
+        "operands must have the same element type");
+    if (l.size() != r.size() || l.count() != r.count() || expr_layout(l, 0) != expr_layout(r, 0))
+        throw std::logic_error(L::expr_kind::mismatch());
+}
+
+// Вычисление выражения в буфер dst из e.count() элементов.
+// Общий случай - один проход по всем операндам сразу; выражения из одной
+// операции над непрерывными листьями отдаются SIMD-ядрам.
+template<typename E, typename Enable = void>
+struct TExprEval
+{
+    template<typename T>
+    static void run(T* dst, const E& e)
+    {
+        const size_t n = e.count();
+        auto body = [&](size_t b, size_t end) {
+            for (size_t i = b; i < end; i++)
+                dst[i] = e.elem(i);
+        };
+        if (n < PARALLEL_MIN_ELEMENTS)
+            body(0, n);
+        else
+            TThreadPool::instance().parallel_for(0, n, kernels::PARALLEL_GRAIN, body);
+    }
+};
+
+template<typename L, typename R>
+struct TExprEval<TBinaryExpr<L, R, TOpAdd>, typename std::enable_if<TExprDense<L>::value && TExprDense<R>::value>::type>
+{
+    template<typename T>
+    static void run(T* dst, const TBinaryExpr<L, R, TOpAdd>& e)
+    {
+        kernels::add(e.count(), e.lhs().data(), e.rhs().data(), dst);
+    }
+};
+
+template<typename L, typename R>
+struct TExprEval<TBinaryExpr<L, R, TOpSub>, typename std::enable_if<TExprDense<L>::value && TExprDense<R>::value>::type>
+{
+    template<typename T>
+    static void run(T* dst, const TBinaryExpr<L, R, TOpSub>& e)
+    {
+        kernels::sub(e.count(), e.lhs().data(), e.rhs().data(), dst);
+    }
+};
+
+template<typename L>
+struct TExprEval<TScalarExpr<L, TOpAdd>, typename std::enable_if<TExprDense<L>::value>::type>
+{
+    template<typename T>
+    static void run(T* dst, const TScalarExpr<L, TOpAdd>& e)
+    {
+        kernels::shift(e.count(), e.lhs().data(), e.value(), dst);
+    }
+};
+
+template<typename L>
+struct TExprEval<TScalarExpr<L, TOpSub>, typename std::enable_if<TExprDense<L>::value>::type>
+{
+    template<typename T>
+    static void run(T* dst, const TScalarExpr<L, TOpSub>& e)
+    {
+        kernels::shift(e.count(), e.lhs().data(), T(-e.value()), dst);
+    }
+};
+
+template<typename L>
+struct TExprEval<TScalarExpr<L, TOpMul>, typename std::enable_if<TExprDense<L>::value>::type>
+{
+    template<typename T>
+    static void run(T* dst, const TScalarExpr<L, TOpMul>& e)
+    {
+        kernels::scale(e.count(), e.lhs().data(), e.value(), dst);
+    }
+};
+
+template<typename T, typename E>
+void expr_assign(T* dst, const E& e)
+{
+    TExprEval<E>::run(dst, e);
+}
+
+// поэлементные операции
+template<typename L, typename R, typename K>
+TBinaryExpr<L, R, TOpAdd> operator+(const TExpr<L, K>& l, const TExpr<R, K>& r)
+{
+    expr_check_shape(l.self(), r.self());
+    return TBinaryExpr<L, R, TOpAdd>(l.self(), r.self());
+}
+
+template<typename L, typename R, typename K>
+TBinaryExpr<L, R, TOpSub> operator-(const TExpr<L, K>& l, const TExpr<R, K>& r)
+{
+    expr_check_shape(l.self(), r.self());
+    return TBinaryExpr<L, R, TOpSub>(l.self(), r.self());
+}
+
+// операции со скаляром
+template<typename L, typename K>
+typename std::enable_if<TExprScalarShift<K>::value, TScalarExpr<L, TOpAdd>>::type
+operator+(const TExpr<L, K>& l, typename L::value_type val)
+{
+    return TScalarExpr<L, TOpAdd>(l.self(), val);
+}
+
+template<typename L, typename K>
+typename std::enable_if<TExprScalarShift<K>::value, TScalarExpr<L, TOpSub>>::type
+operator-(const TExpr<L, K>& l, typename L::value_type val)
+{
+    return TScalarExpr<L, TOpSub>(l.self(), val);
+}
+
+template<typename L, typename K>
+TScalarExpr<L, TOpMul> operator*(const TExpr<L, K>& l, typename L::value_type val)
+{
+    return TScalarExpr<L, TOpMul>(l.self(), val);
+}
+
+// сравнение без вычисления промежуточных результатов
+template<typename L, typename R, typename K>
+bool operator==(const TExpr<L, K>& l, const TExpr<R, K>& r)
+{
+    const L& a = l.self();
+    const R& b = r.self();
+    if (a.size() != b.size() || a.count() != b.count())
+        return false;
+    const size_t n = a.count();
+    for (size_t i = 0; i < n; i++)
+        if (a.elem(i) != b.elem(i))
+            return false;
+    return true;
+}
+
+template<typename L, typename R, typename K>
+bool operator!=(const TExpr<L, K>& l, const TExpr<R, K>& r)
+{
+    return !(l == r);
+}
+
+// Операнд-временный объект, владеющий памятью (вектор, матрица): результат
+// вычисляется прямо в его буфер, и он же возвращается перемещением, так что
+// цепочка вида (a * b + c) * 2 выделяет память один раз.
+template<typename C>
+struct TExprOwner : std::false_type {};
+
+// для ссылочного L (операнд - lvalue) перегрузки ниже отбрасываются
+template<typename L, typename R = L>
+struct TExprOwnerRvalue : std::enable_if<TExprOwner<L>::value && TExprOwner<R>::value, L> {};
+
+template<typename L, typename R>
+typename TExprOwnerRvalue<L>::type operator+(L&& l, const TExpr<R, typename L::expr_kind>& r)
+{
+    expr_assign(l.data(), l + r.self());
+    return std::move(l);
+}
+
+template<typename L, typename R>
+typename TExprOwnerRvalue<R>::type operator+(const TExpr<L, typename R::expr_kind>& l, R&& r)
+{
+    expr_assign(r.data(), l.self() + r);
+    return std::move(r);
+}
+
+template<typename L, typename R>
+typename TExprOwnerRvalue<L, R>::type operator+(L&& l, R&& r)
+{
+    expr_assign(l.data(), l + r);
+    return std::move(l);
+}
+
+template<typename L, typename R>
+typename TExprOwnerRvalue<L>::type operator-(L&& l, const TExpr<R, typename L::expr_kind>& r)
+{
+    expr_assign(l.data(), l - r.self());
+    return std::move(l);
+}
+
+template<typename L, typename R>
+typename TExprOwnerRvalue<R>::type operator-(const TExpr<L, typename R::expr_kind>& l, R&& r)
+{
+    expr_assign(r.data(), l.self() - r);
+    return std::move(r);
+}
+
+template<typename L, typename R>
+typename TExprOwnerRvalue<L, R>::type operator-(L&& l, R&& r)
+{
+    expr_assign(l.data(), l - r);
+    return std::move(l);
+}
+
+template<typename L>
+typename std::enable_if<TExprScalarShift<typename TExprOwnerRvalue<L>::type::expr_kind>::value, L>::type
+operator+(L&& l, typename TExprOwnerRvalue<L>::type::value_type val)
+{
+    expr_assign(l.data(), l + val);
+    return std::move(l);
+}
+
+template<typename L>
+typename std::enable_if<TExprScalarShift<typename TExprOwnerRvalue<L>::type::expr_kind>::value, L>::type
+operator-(L&& l, typename TExprOwnerRvalue<L>::type::value_type val)
+{
+    expr_assign(l.data(), l - val);
+    return std::move(l);
+}
+
+template<typename L>
+typename TExprOwnerRvalue<L>::type operator*(L&& l, typename TExprOwnerRvalue<L>::type::value_type val)
+{
+    expr_assign(l.data(), l * val);
+    return std::move(l);
+}
+
+// скалярное произведение
+template<typename L, typename R, typename Enable = void>
+struct TExprDot
+{
+    static typename L::value_type run(const L& a, const R& b)
+    {
+        typename L::value_type res = typename L::value_type();
+        const size_t n = a.count();
+        for (size_t i = 0; i < n; i++)
+            res += a.elem(i) * b.elem(i);
+        return res;
+    }
+};
+
+template<typename L, typename R>
+struct TExprDot<L, R, typename std::enable_if<TExprDense<L>::value && TExprDense<R>::value>::type>
+{
+    static typename L::value_type run(const L& a, const R& b)
+    {
+        return kernels::dot(a.count(), a.data(), b.data());
+    }
+};
+
+template<typename L, typename R>
+typename L::value_type operator*(const TExpr<L, TVectorTag>& l, const TExpr<R, TVectorTag>& r)
+{
+    expr_check_shape(l.self(), r.self());
+    return TExprDot<L, R>::run(l.self(), r.self());
+}
+
+#endif
@@ -0,0 +1,207 @@
+// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Блочное умножение матриц (GEMM)
+//
+// Схема Гото: C разбивается на блоки NC столбцов, K - на слои по KC,
+// A - на блоки по MC строк. Блок B (KC x NC) и блок A (MC x KC)
+// упаковываются в непрерывные панели шириной NR и MR, после чего
+// микроядро считает плитку MR x NR целиком в локальном аккумуляторе.
+
+#ifndef __TGemm_H__
+#define __TGemm_H__
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+#include "tmemory.h"
+#include "tsimd.h"
+
+namespace kernels
+{
+
+// Параметры блочности для типа T.
+// Плитка микроядра MR x NR берётся из таблицы ядер (tsimd.h) и зависит
+// от выбранного набора инструкций.
+template<typename T>
+struct TGemmBlocking
+{
+    // KC * NR помещается в L1, MC * KC - в L2, KC * NC - в L3
+    static const size_t KC = 256;
+    static const size_t MC = 120;
+    static const size_t NC = 2048;
+};
+
+// Упаковка блока A (mc x kc) в панели по MR строк:
+// для каждого k подряд лежат MR элементов столбца, хвост дополняется нулями.
+// Множитель alpha применяется здесь, чтобы не трогать микроядро.
+template<typename T>
+void gemm_pack_a(size_t mc, size_t kc, T alpha, const T* a, ptrdiff_t rsa, ptrdiff_t csa, T* buf, size_t MR)
+{
+    for (size_t i = 0; i < mc; i += MR) {
+        const size_t mr = mc - i < MR ? mc - i : MR;
+        for (size_t k = 0; k < kc; k++) {
+            const T* src = a + i * rsa + k * csa;
+            for (size_t r = 0; r < mr; r++)
+                buf[r] = alpha * src[r * rsa];
+            for (size_t r = mr; r < MR; r++)
+                buf[r] = T();
+            buf += MR;
+        }
+    }
+}
+
+// Упаковка блока B (kc x nc) в панели по NR столбцов
+template<typename T>
+void gemm_pack_b(size_t kc, size_t nc, const T* b, ptrdiff_t rsb, ptrdiff_t csb, T* buf, size_t NR)
+{
+    for (size_t j = 0; j < nc; j += NR) {
+        const size_t nr = nc - j < NR ? nc - j : NR;
+        for (size_t k = 0; k < kc; k++) {
+            const T* src = b + k * rsb + j * csb;
+            for (size_t c = 0; c < nr; c++)
+                buf[c] = src[c * csb];
+            for (size_t c = nr; c < NR; c++)
+                buf[c] = T();
+            buf += NR;
+        }
+    }
+}
+
+// C = beta C; при beta == 0 исходное содержимое C не читается
+template<typename T>
+void gemm_scale_c(size_t m, size_t n, T beta, T* c, size_t ldc)
+{
+    if (beta == T(1))
+        return;
+    for (size_t i = 0; i < m; i++) {
+        T* ci = c + i * ldc;
+        if (beta == T())
+            std::fill(ci, ci + n, T());
+        else
+            for (size_t j = 0; j < n; j++)
+                ci[j] *= beta;
+    }
+}
+
+// Последовательная часть: C (m x n) = alpha A (m x k) B (k x n) + beta C
+template<typename T>
+void gemm_serial(size_t m, size_t n, size_t k, T alpha,
+    const T* a, ptrdiff_t rsa, ptrdiff_t csa,
+    const T* b, ptrdiff_t rsb, ptrdiff_t csb,
+    T beta, T* c, size_t ldc)
+{
+    typedef TGemmBlocking<T> P;
+    gemm_scale_c(m, n, beta, c, ldc);
+    if (m == 0 || n == 0 || k == 0 || alpha == T())
+        return;
+
+    // маленькие задачи не окупают упаковку
+    if (m * n * k <= 32 * 32 * 32) {
+        for (size_t i = 0; i < m; i++)
+            for (size_t p = 0; p < k; p++) {
+                const T aip = alpha * a[i * rsa + p * csa];
+                const T* bp = b + p * rsb;
+                T* ci = c + i * ldc;
+                for (size_t j = 0; j < n; j++)
+                    ci[j] += aip * bp[j * csb];
+            }
+        return;
+    }
+
+    const TKernelTable<T> ker = kernel_table<T>();
+    const size_t MR = ker.MR;
+    const size_t NR = ker.NR;
+    const size_t mcMax = m < P::MC ? m : P::MC;
+    const size_t ncMax = n < P::NC ? n : P::NC;
+    const size_t kcMax = k < P::KC ? k : P::KC;
+    std::vector<T, TAlignedAllocator<T>> bufA(((mcMax + MR - 1) / MR) * MR * kcMax);
+    std::vector<T, TAlignedAllocator<T>> bufB(((ncMax + NR - 1) / NR) * NR * kcMax);
+
+    for (size_t jc = 0; jc < n; jc += P::NC) {
+        const size_t nc = n - jc < P::NC ? n - jc : P::NC;
+        for (size_t pc = 0; pc < k; pc += P::KC) {
+            const size_t kc = k - pc < P::KC ? k - pc : P::KC;
+            gemm_pack_b(kc, nc, b + pc * rsb + jc * csb, rsb, csb, bufB.data(), NR);
+            for (size_t ic = 0; ic < m; ic += P::MC) {
+                const size_t mc = m - ic < P::MC ? m - ic : P::MC;
+                gemm_pack_a(mc, kc, alpha, a + ic * rsa + pc * csa, rsa, csa, bufA.data(), MR);
+                for (size_t jr = 0; jr < nc; jr += NR) {
+                    const size_t nr = nc - jr < NR ? nc - jr : NR;
+                    const T* pb = bufB.data() + jr * kc;
+                    for (size_t ir = 0; ir < mc; ir += MR) {
+                        const size_t mr = mc - ir < MR ? mc - ir : MR;
+                        ker.gemm_micro(kc, bufA.data() + ir * kc, pb,
+                            c + (ic + ir) * ldc + jc + jr, ldc, mr, nr);
+                    }
+                }
+            }
+        }
+    }
+}
+
+// C (m x n, строки через ldc) = alpha A (m x k) B (k x n) + beta C.
+// A и B задаются шагами по строкам и столбцам, поэтому транспонированный
+// операнд передаётся без копирования - перестановкой шагов.
+// Большие задачи делятся на плитки C, которые считаются в пуле потоков;
+// каждая плитка упаковывает свои панели сама.
+template<typename T>
+void gemm(size_t m, size_t n, size_t k, T alpha,
+    const T* a, ptrdiff_t rsa, ptrdiff_t csa,
+    const T* b, ptrdiff_t rsb, ptrdiff_t csb,
+    T beta, T* c, size_t ldc)
+{
+    TThreadPool& pool = TThreadPool::instance();
+    const size_t threads = pool.num_threads();
+    if (threads <= 1 || double(m) * n * k < PARALLEL_MIN_FLOPS) {
+        gemm_serial(m, n, k, alpha, a, rsa, csa, b, rsb, csb, beta, c, ldc);
+        return;
+    }
+    // по строкам режем не мельче MC, недостающее добираем по столбцам
+    const size_t MC = TGemmBlocking<T>::MC;
+    size_t rowParts = (m + MC - 1) / MC;
+    if (rowParts > threads)
+        rowParts = threads;
+    size_t colParts = (threads + rowParts - 1) / rowParts;
+    const size_t maxColParts = (n + 63) / 64;
+    if (colParts > maxColParts)
+        colParts = maxColParts;
+    pool.parallel_for(0, rowParts * colParts, 1, [&](size_t tb, size_t te) {
+        for (size_t t = tb; t < te; t++) {
+            const size_t r = t / colParts, q = t % colParts;
+            const size_t i0 = m * r / rowParts, i1 = m * (r + 1) / rowParts;
+            const size_t j0 = n * q / colParts, j1 = n * (q + 1) / colParts;
+            gemm_serial(i1 - i0, j1 - j0, k, alpha, a + i0 * rsa, rsa, csa,
+                b + j0 * csb, rsb, csb, beta, c + i0 * ldc + j0, ldc);
+        }
+    });
+}
+
+// y (n) = alpha A^T x + beta y, A - m x n, строки через lda.
+// Строки A читаются подряд: к полосе y прибавляются строки, умноженные на
+// x[i]. Полоса y держится в кэше, пока через неё проходят все m строк;
+// при большом объёме полосы делятся между потоками.
+template<typename T>
+void gemv_t(size_t m, size_t n, T alpha, const T* a, size_t lda, const T* x, T beta, T* y)
+{
+    const TKernelTable<T>& t = kernel_table<T>();
+    const size_t TILE = 512;
+    auto body = [&](size_t jb, size_t je) {
+        for (size_t j = jb; j < je; j += TILE) {
+            const size_t len = je - j < TILE ? je - j : TILE;
+            if (beta == T())
+                std::fill(y + j, y + j + len, T());
+            else if (beta != T(1))
+                t.scale(len, y + j, beta, y + j);
+            for (size_t i = 0; i < m; i++)
+                t.axpy(len, alpha * x[i], a + i * lda + j, y + j);
+        }
+    };
+    if (m * n < PARALLEL_MIN_ELEMENTS)
+        body(0, n);
+    else
+        TThreadPool::instance().parallel_for(0, n, TILE, body);
+}
+
+} // namespace kernels
+
+#endif
@@ -0,0 +1,357 @@
+// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Векторы и матрицы в отображённых в память файлах
+//
+// TMappedFile отображает двоичный файл в адресное пространство (mmap,
+// в Windows - MapViewOfFile). Страницы подгружаются по первому обращению,
+// так что работа с файлом любого размера начинается сразу, а процессы,
+// отобразившие один файл, делят страницы кэша ОС вместо собственных копий.
+//
+// Режимы:
+//   MAPPED_READ_ONLY     - только чтение, запись в память - ошибка доступа;
+//   MAPPED_COPY_ON_WRITE - изменения видны только этому процессу;
+//   MAPPED_READ_WRITE    - изменения попадают в файл.
+//
+// Данные подключаются двумя способами:
+//   - map_vector/map_matrix/map_rect_matrix возвращают обычные
+//     TDynamicVector/TDynamicMatrix/TRectMatrix с аллокатором
+//     TMappedAllocator, память которых - участок файла (размеры ограничены
+//     MAX_VECTOR_SIZE, как у любого вектора; файл открыт не только для
+//     чтения);
+//   - map_view возвращает TMatrixView над участком файла без ограничений
+//     размера; представления принимают операции и блочные ядра.
+// Файл остаётся отображённым, пока жив хотя бы один объект над ним.
+// Элементы хранятся в машинном представлении, построчно.
+
+#ifndef __TMapped_H__
+#define __TMapped_H__
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <system_error>
+#include "tview.h"
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+enum TMapMode { MAPPED_READ_ONLY, MAPPED_COPY_ON_WRITE, MAPPED_READ_WRITE };
+
+// Ожидаемый характер обращений (madvise)
+enum TMapAdvice { ADVICE_NORMAL, ADVICE_SEQUENTIAL, ADVICE_RANDOM, ADVICE_WILL_NEED, ADVICE_DONT_NEED };
+
+class TMappedFile
+{
+    char* addr;
+    size_t len;
+    TMapMode mapMode;
+#if defined(_WIN32)
+    HANDLE file;
+    HANDLE mapping;
+
+    [[noreturn]] static void fail(const char* what)
+    {
+        throw std::system_error(int(GetLastError()), std::system_category(), what);
+    }
+
+    void map(const std::string& path, bool create, size_t size)
+    {
+        const bool write = mapMode == MAPPED_READ_WRITE;
+        file = CreateFileA(path.c_str(), GENERIC_READ | (write ? GENERIC_WRITE : 0),
+            FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, create ? CREATE_ALWAYS : OPEN_EXISTING,
+            FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE)
+            fail("CreateFile");
+        if (!create) {
+            LARGE_INTEGER fs;
+            if (!GetFileSizeEx(file, &fs)) {
+                CloseHandle(file);
+                fail("GetFileSizeEx");
+            }
+            size = size_t(fs.QuadPart);
+        }
+        if (size == 0) {
+            CloseHandle(file);
+            throw std::length_error("file is empty");
+        }
+        const DWORD protect = write ? PAGE_READWRITE : (mapMode == MAPPED_COPY_ON_WRITE ? PAGE_WRITECOPY : PAGE_READONLY);
+        mapping = CreateFileMappingA(file, nullptr, protect, DWORD(uint64_t(size) >> 32), DWORD(size), nullptr);
+        if (mapping == nullptr) {
+            CloseHandle(file);
+            fail("CreateFileMapping");
+        }
+        const DWORD access = write ? FILE_MAP_WRITE : (mapMode == MAPPED_COPY_ON_WRITE ? FILE_MAP_COPY : FILE_MAP_READ);
+        addr = static_cast<char*>(MapViewOfFile(mapping, access, 0, 0, size));
+        if (addr == nullptr) {
+            CloseHandle(mapping);
+            CloseHandle(file);
+            fail("MapViewOfFile");
+        }
+        len = size;
+    }
+#else
+    [[noreturn]] static void fail(const char* what)
+    {
+        throw std::system_error(errno, std::generic_category(), what);
+    }
+
+    void map(const std::string& path, bool create, size_t size, bool populate = false)
+    {
+        const bool write = mapMode == MAPPED_READ_WRITE;
+        const int fd = ::open(path.c_str(), (write ? O_RDWR : O_RDONLY) | (create ? O_CREAT | O_TRUNC : 0), 0644);
+        if (fd < 0)
+            fail("open");
+        if (create) {
+            if (::ftruncate(fd, off_t(size)) != 0) {
+                const int err = errno;
+                ::close(fd);
+                throw std::system_error(err, std::generic_category(), "ftruncate");
+            }
+        }
+        else {
+            struct stat st;
+            if (::fstat(fd, &st) != 0) {
+                const int err = errno;
+                ::close(fd);
+                throw std::system_error(err, std::generic_category(), "fstat");
+            }
+            size = size_t(st.st_size);
+        }
+        if (size == 0) {
+            ::close(fd);
+            throw std::length_error("file is empty");
+        }
+        int flags = mapMode == MAPPED_COPY_ON_WRITE ? MAP_PRIVATE : MAP_SHARED;
+#ifdef MAP_POPULATE
+        if (populate)
+            flags |= MAP_POPULATE;
+#endif
+        void* p = ::mmap(nullptr, size, mapMode == MAPPED_READ_ONLY ? PROT_READ : PROT_READ | PROT_WRITE, flags, fd, 0);
+        const int err = errno;
+        // отображение держит файл само, дескриптор больше не нужен
+        ::close(fd);
+        if (p == MAP_FAILED)
+            throw std::system_error(err, std::generic_category(), "mmap");
+        addr = static_cast<char*>(p);
+        len = size;
+#ifndef MAP_POPULATE
+        if (populate)
+            advise(ADVICE_WILL_NEED);
+#endif
+    }
+#endif
+
+public:
+    // Существующий файл целиком. populate - прочитать все страницы сразу
+    // (MAP_POPULATE), а не по первому обращению.
+    explicit TMappedFile(const std::string& path, TMapMode mode = MAPPED_READ_ONLY, bool populate = false)
+        : addr(nullptr), len(0), mapMode(mode)
+    {
+#if defined(_WIN32)
+        map(path, false, 0);
+        if (populate)
+            advise(ADVICE_WILL_NEED);
+#else
+        map(path, false, 0, populate);
+#endif
+    }
+    // Новый файл из size байт (существующий перезаписывается), для записи.
+    // Размер проверяется до открытия, чтобы отвергнутый вызов не стёр файл.
+    TMappedFile(const std::string& path, size_t size)
+        : addr(nullptr), len(0), mapMode(MAPPED_READ_WRITE)
+    {
+        if (size == 0)
+            throw std::length_error("file is empty");
+        map(path, true, size);
+    }
+    TMappedFile(const TMappedFile&) = delete;
+    TMappedFile& operator=(const TMappedFile&) = delete;
+    ~TMappedFile()
+    {
+#if defined(_WIN32)
+        UnmapViewOfFile(addr);
+        CloseHandle(mapping);
+        CloseHandle(file);
+#else
+        ::munmap(addr, len);
+#endif
+    }
+
+    char* data() const noexcept { return addr; }
+    size_t size() const noexcept { return len; }
+    TMapMode mode() const noexcept { return mapMode; }
+
+    // Подсказка ОС о порядке обращений к байтам [offset, offset + bytes)
+    // (по умолчанию - ко всему файлу)
+    void advise(TMapAdvice advice, size_t offset = 0, size_t bytes = size_t(-1)) const
+    {
+        if (offset >= len)
+            throw out_of_range("out of range");
+        if (bytes > len - offset)
+            bytes = len - offset;
+#if defined(_WIN32)
+        (void)advice;
+#else
+        // начало участка выравнивается вниз на границу страницы
+        const size_t page = size_t(::sysconf(_SC_PAGESIZE));
+        const size_t start = offset / page * page;
+        int a = MADV_NORMAL;
+        switch (advice) {
+        case ADVICE_SEQUENTIAL: a = MADV_SEQUENTIAL; break;
+        case ADVICE_RANDOM: a = MADV_RANDOM; break;
+        case ADVICE_WILL_NEED: a = MADV_WILLNEED; break;
+        case ADVICE_DONT_NEED: a = MADV_DONTNEED; break;
+        default: break;
+        }
+        if (::madvise(addr + start, bytes + (offset - start), a) != 0)
+            fail("madvise");
+#endif
+    }
+
+    // запись изменённых страниц в файл (MAPPED_READ_WRITE)
+    void sync() const
+    {
+        if (mapMode != MAPPED_READ_WRITE)
+            return;
+#if defined(_WIN32)
+        if (!FlushViewOfFile(addr, 0) || !FlushFileBuffers(file))
+            fail("FlushViewOfFile");
+#else
+        if (::msync(addr, len, MS_SYNC) != 0)
+            fail("msync");
+#endif
+    }
+};
+
+// Участок файла, отдаваемый аллокатором. Его получает только первое
+// выделение, и после освобождения участок больше не выдаётся: иначе
+// новая память объекта другого размера (или другого объекта с тем же
+// аллокатором) незаметно оказалась бы в файле. Все остальные выделения
+// берут обычную выровненную память.
+struct TMappedRegion
+{
+    std::shared_ptr<TMappedFile> file;
+    size_t offset;
+    std::atomic<bool> taken;    // участок выдан (и, возможно, уже освобождён)
+
+    TMappedRegion(const std::shared_ptr<TMappedFile>& f, size_t off) : file(f), offset(off), taken(false) {}
+};
+
+// Аллокатор, память которого - участок отображённого файла
+template<typename T>
+class TMappedAllocator
+{
+    template<typename U> friend class TMappedAllocator;
+    static_assert(std::is_trivially_copyable<T>::value, "mapped elements must be trivially copyable");
+    std::shared_ptr<TMappedRegion> region;
+public:
+    typedef T value_type;
+    template<typename U>
+    struct rebind { typedef TMappedAllocator<U> other; };
+
+    // без файла - обычная выровненная память
+    TMappedAllocator() noexcept {}
+    TMappedAllocator(const std::shared_ptr<TMappedFile>& f, size_t offset = 0)
+        : region(std::make_shared<TMappedRegion>(f, offset))
+    {
+        if (f == nullptr) throw logic_error("no file");
+        // запись в такую память - ошибка доступа, а контейнеры изменяемы
+        if (f->mode() == MAPPED_READ_ONLY)
+            throw logic_error("read-only file: map it copy-on-write or use map_view with const elements");
+        if (offset > f->size()) throw out_of_range("out of range");
+        if ((size_t(f->data()) + offset) % alignof(T) != 0) throw logic_error("misaligned offset");
+    }
+    template<typename U>
+    TMappedAllocator(const TMappedAllocator<U>& a) noexcept : region(a.region) {}
+
+    // копия контейнера получает обычную память и никогда не попадает в файл
+    TMappedAllocator select_on_container_copy_construction() const noexcept { return TMappedAllocator(); }
+
+    T* allocate(size_t n)
+    {
+        if (region != nullptr && n <= capacity()) {
+            char* p = region->file->data() + region->offset;
+            bool expected = false;
+            if (size_t(p) % alignof(T) == 0 && region->taken.compare_exchange_strong(expected, true))
+                return reinterpret_cast<T*>(p);
+        }
+        return TAlignedAllocator<T>().allocate(n);
+    }
+    void deallocate(T* p, size_t n) noexcept
+    {
+        // участок файла не освобождается и больше не выдаётся
+        if (region == nullptr || reinterpret_cast<char*>(p) != region->file->data() + region->offset)
+            TAlignedAllocator<T>().deallocate(p, n);
+    }
+
+    // число элементов T, помещающихся в участке
+    size_t capacity() const noexcept
+    {
+        return region == nullptr ? 0 : (region->file->size() - region->offset) / sizeof(T);
+    }
+    std::shared_ptr<TMappedFile> file() const noexcept
+    {
+        return region == nullptr ? std::shared_ptr<TMappedFile>() : region->file;
+    }
+
+    friend bool operator==(const TMappedAllocator& a, const TMappedAllocator& b) noexcept { return a.region == b.region; }
+    friend bool operator!=(const TMappedAllocator& a, const TMappedAllocator& b) noexcept { return a.region != b.region; }
+};
+
+// Вектор, матрицы и блок над участком файла, начиная с offset байт.
+// Элементы не инициализируются: содержимое берётся из файла.
+// Контейнеры изменяемы, поэтому над MAPPED_READ_ONLY-файлом они не
+// строятся (logic_error): файл для них открывается в режиме
+// MAPPED_COPY_ON_WRITE (страницы по-прежнему общие, пока не изменены)
+// или MAPPED_READ_WRITE, а только для чтения - map_view<const T>.
+template<typename T>
+TDynamicVector<T, TMappedAllocator<T>> map_vector(const std::shared_ptr<TMappedFile>& f, size_t size, size_t offset = 0)
+{
+    TMappedAllocator<T> a(f, offset);
+    if (size > a.capacity()) throw length_error("file is too small");
+    return TDynamicVector<T, TMappedAllocator<T>>(size, uninitialized, a);
+}
+
+template<typename T>
+TDynamicMatrix<T, TMappedAllocator<T>> map_matrix(const std::shared_ptr<TMappedFile>& f, size_t size, size_t offset = 0)
+{
+    TMappedAllocator<T> a(f, offset);
+    if (size > a.capacity() / size) throw length_error("file is too small");
+    return TDynamicMatrix<T, TMappedAllocator<T>>(size, uninitialized, a);
+}
+
+template<typename T>
+TRectMatrix<T, TMappedAllocator<T>> map_rect_matrix(const std::shared_ptr<TMappedFile>& f, size_t rows, size_t cols, size_t offset = 0)
+{
+    TMappedAllocator<T> a(f, offset);
+    if (cols == 0 || rows > a.capacity() / cols) throw length_error("file is too small");
+    return TRectMatrix<T, TMappedAllocator<T>>(rows, cols, uninitialized, a);
+}
+
+// Блок rows x cols без ограничения размера. Представление не продлевает
+// жизнь файла: f должен жить дольше него. Для файла только для чтения
+// T - константный тип.
+template<typename T>
+TMatrixView<T> map_view(const TMappedFile& f, size_t rows, size_t cols, size_t offset = 0)
+{
+    static_assert(std::is_trivially_copyable<T>::value, "mapped elements must be trivially copyable");
+    if (f.mode() == MAPPED_READ_ONLY && !std::is_const<T>::value)
+        throw logic_error("read-only file needs a view of const elements");
+    if (offset > f.size() || cols == 0 || rows > (f.size() - offset) / sizeof(T) / cols)
+        throw length_error("file is too small");
+    if ((size_t(f.data()) + offset) % alignof(T) != 0)
+        throw logic_error("misaligned offset");
+    return TMatrixView<T>(reinterpret_cast<T*>(f.data() + offset), rows, cols, cols);
+}
+
+#endif
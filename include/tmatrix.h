@@ -8,78 +8,125 @@
 #define __TDynamicMatrix_H__
 
 #include <iostream>
+#include <algorithm>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
 #include <assert.h>
 #include <cassert>
+#include "tmemory.h"
+#include "tarena.h"
+#include "tsimd.h"
+#include "tgemm.h"
+#include "texpr.h"
 using namespace std;
 
 const int MAX_VECTOR_SIZE = 100000000;
 const int MAX_MATRIX_SIZE = 10000;
 
 // Динамический вектор - 
-// шаблонный вектор на динамической памяти
-template<typename T>
-class TDynamicVector
+// шаблонный вектор на динамической памяти.
+// Память берётся у аллокатора Alloc, по умолчанию - выровненная на 64 байта.
+template<typename T, typename Alloc = TAlignedAllocator<T>>
+class TDynamicVector : public TExpr<TDynamicVector<T, Alloc>, TVectorTag>
 {
 protected:
     size_t sz;
     T* pMem;
-public:
-    TDynamicVector(size_t size = 1) : sz(size)
+    Alloc alloc;
+
+    static size_t checked(size_t size)
     {
-        if (sz == 0 || sz > MAX_VECTOR_SIZE)
+        if (size == 0 || size > MAX_VECTOR_SIZE)
             throw length_error("Vector size should be greater than zero");
-        pMem = new T[sz]();// {}; // У типа T д.б. конструктор по умолчанию
+        return size;
+    }
+public:
+    typedef T value_type;
+    typedef Alloc allocator_type;
+
+    TDynamicVector(size_t size = 1, const Alloc& a = Alloc()) : sz(checked(size)), alloc(a)
+    {
+        pMem = mem_create(alloc, sz, true); // У типа T д.б. конструктор по умолчанию
+    }
+    // элементы не инициализируются (для встроенных типов), вызывающий код
+    // обязан перезаписать их все
+    TDynamicVector(size_t size, TUninitialized, const Alloc& a = Alloc()) : sz(checked(size)), alloc(a)
+    {
+        pMem = mem_create(alloc, sz, false);
     }
-    TDynamicVector(T* arr, size_t s) : sz(s)
+    TDynamicVector(const T* arr, size_t s, const Alloc& a = Alloc()) : sz(s), alloc(a)
     {
         assert(arr != nullptr && "TDynamicVector ctor requires non-nullptr arg");
-        pMem = new T[sz];
-        std::copy(arr, arr + sz, pMem);
+        pMem = mem_create(alloc, sz, false);
+        mem_copy(arr, sz, pMem);
     }
     TDynamicVector(const TDynamicVector& v)
+        : sz(v.sz), alloc(std::allocator_traits<Alloc>::select_on_container_copy_construction(v.alloc))
     {
-        sz = v.sz;
-        pMem = new T[sz];
-        if (pMem == nullptr)
-            throw bad_alloc();
-        for (int i = 0; i < sz; i++)
-            pMem[i] = v.pMem[i];
+        pMem = mem_create(alloc, sz, false);
+        mem_copy(v.pMem, sz, pMem);
     }
-    TDynamicVector(TDynamicVector&& v) noexcept
+    // вычисление выражения за один проход
+    template<typename E>
+    TDynamicVector(const TExpr<E, TVectorTag>& e, const Alloc& a = Alloc())
+        : TDynamicVector(e.self().size(), uninitialized, a)
     {
-        sz = 0;
-        pMem = nullptr;
-        swap(*this, v);
+        static_assert(std::is_same<typename E::value_type, T>::value, "element types differ");
+        expr_assign(pMem, e.self());
+    }
+    TDynamicVector(TDynamicVector&& v) noexcept : sz(0), pMem(nullptr), alloc(v.alloc)
+    {
+        std::swap(sz, v.sz);
+        std::swap(pMem, v.pMem);
     }
     ~TDynamicVector()
     {
-        delete[]pMem;
+        mem_destroy(alloc, pMem, sz);
         pMem = nullptr;
     }
     TDynamicVector& operator=(const TDynamicVector& v)
     {
         if (this != &v) {
             if (sz != v.sz) {
-                sz = v.sz;
-                delete[]pMem;
-                T* p = new T[sz];
-                if (p == nullptr) throw bad_alloc();
+                T* p = mem_create(alloc, v.sz, false);
+                mem_destroy(alloc, pMem, sz);
                 pMem = p;
+                sz = v.sz;
             }
-            std::copy(v.pMem, v.pMem + sz, pMem);
+            mem_copy(v.pMem, sz, pMem);
         }
         return (*this);
     }
     TDynamicVector& operator=(TDynamicVector&& v) noexcept
     {
+        mem_destroy(alloc, pMem, sz);
         sz = 0;
-        delete[]pMem;
         pMem = nullptr;
         swap(*this, v);
         return(*this);
     }
+    template<typename E>
+    TDynamicVector& operator=(const TExpr<E, TVectorTag>& e)
+    {
+        if (sz != e.self().size()) {
+            TDynamicVector tmp(e);
+            swap(*this, tmp);
+        }
+        else
+            expr_assign(pMem, e.self());
+        return *this;
+    }
 
     size_t size() const noexcept { return sz; }
+    size_t count() const noexcept { return sz; }
+    const T& elem(size_t i) const { return pMem[i]; }
+
+    // непосредственный доступ к памяти
+    T* data() noexcept { return pMem; }
+    const T* data() const noexcept { return pMem; }
+
+    void fill(const T& val) { mem_fill(pMem, sz, val); }
 
     // индексация
     T& operator[](size_t ind)
@@ -105,70 +152,52 @@ public:
     // сравнение
     bool operator==(const TDynamicVector& v) const noexcept
     {
-        if (sz != v.sz) return 0;
-        else
-            for (int i = 0; i < sz; i++)
-                if (pMem[i] != v.pMem[i]) return 0;
-        return 1;
+        return sz == v.sz && mem_equal(pMem, v.pMem, sz);
     }
     bool operator!=(const TDynamicVector& v) const noexcept
     {
         return !(*this == v);
     }
 
-    // скалярные операции
-    TDynamicVector operator+(T val)
-    {
-        TDynamicVector res(*this);
-        for (int i = 0; i < sz; i++)
-            res.pMem[i] += val;
-        return res;
-    }
-    TDynamicVector operator-(T val)
+    // скалярные, поэлементные операции и скалярное произведение - см. texpr.h
+
+    // операции с присваиванием, без выделения памяти
+    template<typename E>
+    TDynamicVector& operator+=(const TExpr<E, TVectorTag>& e)
     {
-        TDynamicVector res(*this);
-        for (int i = 0; i < sz; i++)
-            res.pMem[i] -= val;
-        return res;
+        expr_assign(pMem, *this + e.self());
+        return *this;
     }
-    TDynamicVector operator*(T val)
+    template<typename E>
+    TDynamicVector& operator-=(const TExpr<E, TVectorTag>& e)
     {
-        TDynamicVector res(*this);
-        for (int i = 0; i < sz; i++)
-            res.pMem[i] *= val;
-        return res;
+        expr_assign(pMem, *this - e.self());
+        return *this;
     }
-
-    // векторные операции
-    TDynamicVector operator+(const TDynamicVector& v)
+    TDynamicVector& operator+=(T val)
     {
-        if (sz != v.sz) throw logic_error("vectors have different lengths");
-        TDynamicVector <T> res(*this);
-        for (int i = 0; i < sz; i++)
-            res.pMem[i] += v.pMem[i];
-        return res;
+        expr_assign(pMem, *this + val);
+        return *this;
     }
-    TDynamicVector operator-(const TDynamicVector& v)
+    TDynamicVector& operator-=(T val)
     {
-        if (sz != v.sz) throw logic_error("vectors have diffrent lengths");
-        TDynamicVector<T> res(*this);
-        for (int i = 0; i < sz; i++)
-            res.pMem[i] -= v.pMem[i];
-        return res;
+        expr_assign(pMem, *this - val);
+        return *this;
     }
-    T operator*(const TDynamicVector& v)// noexcept(noexcept(T()))
+    TDynamicVector& operator*=(T val)
     {
-        if (sz != v.sz) throw logic_error("vectors have different lengths");
-        T res = T();
-        for (int i = 0; i < sz; i++)
-            res += pMem[i] * v.pMem[i];
-        return res;
+        expr_assign(pMem, *this * val);
+        return *this;
     }
 
+    allocator_type get_allocator() const { return alloc; }
+
+    // память переходит вместе с аллокатором, которым она выделена
     friend void swap(TDynamicVector& lhs, TDynamicVector& rhs) noexcept
     {
         std::swap(lhs.sz, rhs.sz);
         std::swap(lhs.pMem, rhs.pMem);
+        std::swap(lhs.alloc, rhs.alloc);
     }
 
     // ввод/вывод
@@ -187,102 +216,338 @@ public:
 };
 
 
-// Динамическая матрица - 
-// шаблонная матрица на динамической памяти
+// Строка матрицы - 
+// невладеющее представление непрерывного участка памяти матрицы,
+// участвует в выражениях наравне с вектором
 template<typename T>
-class TDynamicMatrix : private TDynamicVector<TDynamicVector<T>>
+class TMatrixRow : public TExpr<TMatrixRow<T>, TVectorTag>
 {
-    using TDynamicVector<TDynamicVector<T>>::pMem;
-    using TDynamicVector<TDynamicVector<T>>::sz;
+    T* pMem;
+    size_t sz;
 public:
-    TDynamicMatrix(size_t s = 1) : TDynamicVector<TDynamicVector<T>>(s)
+    typedef typename std::remove_const<T>::type value_type;
+
+    TMatrixRow(T* p, size_t size) noexcept : pMem(p), sz(size) {}
+    TMatrixRow(const TMatrixRow& r) noexcept = default;
+
+    // присваивание копирует элементы, а не само представление
+    TMatrixRow& operator=(const TMatrixRow& r)
+    {
+        if (sz != r.sz) throw logic_error("rows have different lengths");
+        if (pMem != r.pMem)
+            mem_copy<value_type>(r.pMem, sz, pMem);
+        return *this;
+    }
+    template<typename E>
+    TMatrixRow& operator=(const TExpr<E, TVectorTag>& e)
+    {
+        if (sz != e.self().size()) throw logic_error("rows have different lengths");
+        expr_assign(pMem, e.self());
+        return *this;
+    }
+
+    // операции с присваиванием
+    template<typename E>
+    const TMatrixRow& operator+=(const TExpr<E, TVectorTag>& e) const
+    {
+        expr_assign(pMem, *this + e.self());
+        return *this;
+    }
+    template<typename E>
+    const TMatrixRow& operator-=(const TExpr<E, TVectorTag>& e) const
+    {
+        expr_assign(pMem, *this - e.self());
+        return *this;
+    }
+    const TMatrixRow& operator*=(value_type val) const
+    {
+        expr_assign(pMem, *this * val);
+        return *this;
+    }
+
+    size_t size() const noexcept { return sz; }
+    size_t count() const noexcept { return sz; }
+    const value_type& elem(size_t i) const { return pMem[i]; }
+    T* data() const noexcept { return pMem; }
+
+    void fill(const value_type& val) const { mem_fill<value_type>(pMem, sz, val); }
+
+    // индексация
+    T& operator[](size_t ind) const
+    {
+        return pMem[ind];
+    }
+    // индексация с контролем
+    T& at(size_t ind) const
+    {
+        if (ind >= sz) throw out_of_range("out of range");
+        return pMem[ind];
+    }
+
+    // ввод/вывод
+    friend istream& operator>>(istream& istr, const TMatrixRow& r)
+    {
+        for (size_t i = 0; i < r.sz; i++)
+            istr >> r.pMem[i];
+        return istr;
+    }
+    friend ostream& operator<<(ostream& ostr, const TMatrixRow& r)
+    {
+        for (size_t i = 0; i < r.sz; i++)
+            ostr << r.pMem[i] << ' ';
+        return ostr;
+    }
+};
+
+
+// Динамическая матрица - 
+// шаблонная матрица на динамической памяти.
+// Элементы хранятся построчно в одном непрерывном буфере из sz * sz
+// элементов, operator[] возвращает представление строки.
+template<typename T, typename Alloc = TAlignedAllocator<T>>
+class TDynamicMatrix : public TExpr<TDynamicMatrix<T, Alloc>, TMatrixTag>
+{
+    size_t sz;
+    TDynamicVector<T, Alloc> mem;
+
+    static size_t square(size_t s)
     {
         if (s == 0 || s > MAX_MATRIX_SIZE)
-            throw length_error("Matrix size should be greater than zero and ess than MAX_MATRIX_SIZE");
-        for (size_t i = 0; i < sz; i++)
-            pMem[i] = TDynamicVector<T>(sz);
+            throw length_error("Matrix size should be greater than zero and less than MAX_MATRIX_SIZE");
+        return s * s;
+    }
+public:
+    typedef T value_type;
+    typedef Alloc allocator_type;
+
+    TDynamicMatrix(size_t s = 1, const Alloc& a = Alloc()) : sz(s), mem(square(s), a) {}
+    TDynamicMatrix(size_t s, TUninitialized, const Alloc& a = Alloc()) : sz(s), mem(square(s), uninitialized, a) {}
+    TDynamicMatrix(const TDynamicMatrix& m) = default;
+    // вычисление выражения за один проход
+    template<typename E>
+    TDynamicMatrix(const TExpr<E, TMatrixTag>& e, const Alloc& a = Alloc())
+        : TDynamicMatrix(e.self().size(), uninitialized, a)
+    {
+        static_assert(std::is_same<typename E::value_type, T>::value, "element types differ");
+        expr_assign(mem.data(), e.self());
+    }
+    TDynamicMatrix(TDynamicMatrix&& m) noexcept : sz(m.sz), mem(std::move(m.mem))
+    {
+        m.sz = 0;
+    }
+    TDynamicMatrix& operator=(const TDynamicMatrix& m) = default;
+    TDynamicMatrix& operator=(TDynamicMatrix&& m) noexcept
+    {
+        sz = m.sz;
+        mem = std::move(m.mem);
+        m.sz = 0;
+        return *this;
+    }
+    template<typename E>
+    TDynamicMatrix& operator=(const TExpr<E, TMatrixTag>& e)
+    {
+        if (sz != e.self().size()) {
+            TDynamicMatrix tmp(e);
+            swap(*this, tmp);
+        }
+        else
+            expr_assign(mem.data(), e.self());
+        return *this;
+    }
+
+    size_t size() const noexcept { return sz; }
+    size_t count() const noexcept { return sz * sz; }
+    const T& elem(size_t i) const { return mem.data()[i]; }
+
+    // непосредственный доступ к памяти (построчно)
+    T* data() noexcept { return mem.data(); }
+    const T* data() const noexcept { return mem.data(); }
+
+    void fill(const T& val) { mem.fill(val); }
+
+    // индексация
+    TMatrixRow<T> operator[](size_t ind)
+    {
+        return TMatrixRow<T>(mem.data() + ind * sz, sz);
+    }
+    TMatrixRow<const T> operator[](size_t ind) const
+    {
+        return TMatrixRow<const T>(mem.data() + ind * sz, sz);
+    }
+    // индексация с контролем
+    TMatrixRow<T> at(size_t ind)
+    {
+        if (ind >= sz) throw out_of_range("out of range");
+        return (*this)[ind];
+    }
+    TMatrixRow<const T> at(size_t ind) const
+    {
+        if (ind >= sz) throw out_of_range("out of range");
+        return (*this)[ind];
     }
 
-    using TDynamicVector<TDynamicVector<T>>::operator[];
-    using TDynamicVector<TDynamicVector<T>>::size;
-    using TDynamicVector<TDynamicVector<T>>::at;
     // сравнение
     bool operator==(const TDynamicMatrix& m) const noexcept
     {
-        if (sz != m.sz) return 0;
-        else
-            for (int i = 0; i < sz; i++)
-                if (pMem[i] != m.pMem[i]) return 0;
-        return 1;
+        return sz == m.sz && mem == m.mem;
     }
     bool operator!=(const TDynamicMatrix& m) const noexcept {
         return !(*this == m);
     }
 
-    // матрично-скалярные операции
-    TDynamicMatrix operator*(const T& val)
-    {
-        TDynamicMatrix res(sz);
-        for (int i = 0; i < sz; i++)
-            res[i] = pMem[i] * val;
-        return res;
-    }
+    // матрично-скалярные и поэлементные операции - см. texpr.h,
+    // произведения - после определения класса
 
-    // матрично-векторные операции
-    TDynamicVector<T> operator*(const TDynamicVector<T>& v)
+    // операции с присваиванием, без выделения памяти
+    template<typename E>
+    TDynamicMatrix& operator+=(const TExpr<E, TMatrixTag>& e)
     {
-        if (sz != v.size()) throw logic_error("different lengths");
-        TDynamicVector <T> res(sz);
-        for (int i = 0; i < sz; i++)
-            res[i] = pMem[i] * v;
-        return res;
+        expr_assign(mem.data(), *this + e.self());
+        return *this;
     }
-
-    // матрично-матричные операции
-    TDynamicMatrix operator+(const TDynamicMatrix& m)
+    template<typename E>
+    TDynamicMatrix& operator-=(const TExpr<E, TMatrixTag>& e)
     {
-        if (sz != m.sz) throw logic_error("different lengths");
-        TDynamicMatrix res(sz);
-        for (int i = 0; i < sz; i++)
-            res[i] = pMem[i] + m.pMem[i];
-        return res;
+        expr_assign(mem.data(), *this - e.self());
+        return *this;
     }
-    TDynamicMatrix operator-(const TDynamicMatrix& m)
+    TDynamicMatrix& operator*=(const T& val)
     {
-        if (sz != m.sz) throw logic_error("different lengths");
-        TDynamicMatrix res(sz);
-        for (int i = 0; i < sz; i++)
-            res[i] = pMem[i] - m.pMem[i];
-        return res;
+        expr_assign(mem.data(), *this * val);
+        return *this;
     }
-    TDynamicMatrix operator*(const TDynamicMatrix& m)
+
+    allocator_type get_allocator() const { return mem.get_allocator(); }
+
+    friend void swap(TDynamicMatrix& lhs, TDynamicMatrix& rhs) noexcept
     {
-        if (sz != m.sz) throw logic_error("different lengths");
-        TDynamicMatrix res(sz);
-        size_t pMemSize = pMem[0].size();
-        TDynamicVector <T> tmp(pMemSize);
-        for (int i = 0; i < sz; i++)
-            for (int j = 0; j < pMemSize; j++) {
-                for (int k = 0; k < pMemSize; k++)
-                    tmp[k] = m.pMem[k][j];
-                res[i][j] += pMem[i] * tmp;
-            }
-        return res;
+        std::swap(lhs.sz, rhs.sz);
+        swap(lhs.mem, rhs.mem);
     }
 
     // ввод/вывод
     friend istream& operator>>(istream& istr, TDynamicMatrix& v)
     {
         for (size_t i = 0; i < v.sz; i++)
-            istr >> v.pMem[i];
+            istr >> v[i];
         return istr;
     }
     friend ostream& operator<<(ostream& ostr, const TDynamicMatrix& v)
     {
         for (size_t i = 0; i < v.sz; i++)
-            ostr << v.pMem[i] << endl;
+            ostr << v[i] << endl;
         return ostr;
     }
 };
 
+// Векторы и матрицы в памяти текущей арены. Только эти типы и результаты
+// операций над ними берут память из арены (см. tarena.h).
+template<typename T>
+using TArenaVector = TDynamicVector<T, TArenaAllocator<T>>;
+template<typename T>
+using TArenaMatrix = TDynamicMatrix<T, TArenaAllocator<T>>;
+
+template<typename T, typename A>
+struct TExprDense<TDynamicVector<T, A>> : std::true_type {};
+template<typename T>
+struct TExprDense<TMatrixRow<T>> : std::true_type {};
+template<typename T, typename A>
+struct TExprDense<TDynamicMatrix<T, A>> : std::true_type {};
+
+template<typename T, typename A>
+struct TExprOwner<TDynamicVector<T, A>> : std::true_type {};
+template<typename T, typename A>
+struct TExprOwner<TDynamicMatrix<T, A>> : std::true_type {};
+
+// Аллокатор результата произведения: у листа - его собственный,
+// у выражения - аллокатор по умолчанию
+template<typename E, typename Enable = void>
+struct TExprAllocator
+{
+    typedef TAlignedAllocator<typename E::value_type> type;
+};
+template<typename E>
+struct TExprAllocator<E, typename std::enable_if<TExprOwner<E>::value>::type>
+{
+    typedef typename E::allocator_type type;
+};
+
+// Произведения. Операнд-выражение сначала вычисляется,
+// листья используются как есть. Результат получает аллокатор левого
+// операнда.
+template<typename T, typename A>
+const TDynamicMatrix<T, A>& materialize(const TDynamicMatrix<T, A>& m) { return m; }
+template<typename E>
+TDynamicMatrix<typename E::value_type> materialize(const TExpr<E, TMatrixTag>& e)
+{
+    return TDynamicMatrix<typename E::value_type>(e);
+}
+template<typename T, typename A>
+const TDynamicVector<T, A>& materialize(const TDynamicVector<T, A>& v) { return v; }
+template<typename E>
+TDynamicVector<typename E::value_type> materialize(const TExpr<E, TVectorTag>& e)
+{
+    return TDynamicVector<typename E::value_type>(e);
+}
+
+// матрично-векторные операции
+template<typename L, typename R>
+TDynamicVector<typename L::value_type, typename TExprAllocator<L>::type>
+operator*(const TExpr<L, TMatrixTag>& l, const TExpr<R, TVectorTag>& r)
+{
+    typedef typename L::value_type T;
+    const auto& a = materialize(l.self());
+    const auto& x = materialize(r.self());
+    const size_t sz = a.size();
+    if (sz != x.size()) throw logic_error("different lengths");
+    TDynamicVector<T, typename TExprAllocator<L>::type> res(sz, uninitialized, a.get_allocator());
+    kernels::gemv(sz, sz, T(1), a.data(), sz, x.data(), T(), res.data());
+    return res;
+}
+
+// матрично-матричные операции
+template<typename L, typename R>
+TDynamicMatrix<typename L::value_type, typename TExprAllocator<L>::type>
+operator*(const TExpr<L, TMatrixTag>& l, const TExpr<R, TMatrixTag>& r)
+{
+    typedef typename L::value_type T;
+    const auto& a = materialize(l.self());
+    const auto& b = materialize(r.self());
+    const size_t sz = a.size();
+    if (sz != b.size()) throw logic_error("different lengths");
+    TDynamicMatrix<T, typename TExprAllocator<L>::type> res(sz, uninitialized, a.get_allocator());
+    kernels::gemm(sz, sz, sz, T(1), a.data(), sz, 1, b.data(), sz, 1, T(), res.data(), sz);
+    return res;
+}
+
+// Совмещённые операции в духе BLAS: результат пишется в память вызывающего
+
+// y = y + alpha x
+template<typename T, typename AX, typename AY>
+void axpy(T alpha, const TDynamicVector<T, AX>& x, TDynamicVector<T, AY>& y)
+{
+    if (x.size() != y.size()) throw logic_error("vectors have different lengths");
+    kernels::axpy(x.size(), alpha, x.data(), y.data());
+}
+
+// y = alpha A x + beta y
+template<typename T, typename AA, typename AX, typename AY>
+void gemv(T alpha, const TDynamicMatrix<T, AA>& a, const TDynamicVector<T, AX>& x, T beta, TDynamicVector<T, AY>& y)
+{
+    const size_t sz = a.size();
+    if (sz != x.size() || sz != y.size()) throw logic_error("different lengths");
+    if (x.data() == y.data()) throw logic_error("result must not alias an operand");
+    kernels::gemv(sz, sz, alpha, a.data(), sz, x.data(), beta, y.data());
+}
+
+// C = alpha A B + beta C
+template<typename T, typename AA, typename AB, typename AC>
+void gemm(T alpha, const TDynamicMatrix<T, AA>& a, const TDynamicMatrix<T, AB>& b, T beta, TDynamicMatrix<T, AC>& c)
+{
+    const size_t sz = a.size();
+    if (sz != b.size() || sz != c.size()) throw logic_error("different lengths");
+    if (a.data() == c.data() || b.data() == c.data()) throw logic_error("result must not alias an operand");
+    kernels::gemm(sz, sz, sz, alpha, a.data(), sz, 1, b.data(), sz, 1, beta, c.data(), sz);
+}
+
 #endif
@@ -0,0 +1,198 @@
+// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Распределение, копирование, сравнение и заполнение непрерывных массивов
+//
+// По умолчанию память выделяется блоками, выровненными на границу строки
+// кэша (64 байта): SIMD-загрузки начала буфера не пересекают строки кэша,
+// а буферы разных потоков не делят одну строку.
+//
+// Реализация копирования выбирается на этапе компиляции: тривиально копируемые типы
+// копируются memcpy, целые сравниваются memcmp, нулевое значение
+// заполняется memset. Вещественные типы сравниваются поэлементно, так как
+// 0.0 == -0.0, а NaN не равен самому себе. Прочие типы обрабатываются
+// алгоритмами стандартной библиотеки.
+
+#ifndef __TMemory_H__
+#define __TMemory_H__
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <type_traits>
+#if defined(_MSC_VER)
+#include <malloc.h>
+#endif
+
+const size_t CACHE_LINE_SIZE = 64;
+
+// Аллокатор с выравниванием Align (степень двойки, не меньше alignof(T))
+template<typename T, size_t Align = CACHE_LINE_SIZE>
+class TAlignedAllocator
+{
+    static_assert((Align & (Align - 1)) == 0 && Align >= alignof(T), "bad alignment");
+public:
+    typedef T value_type;
+    template<typename U>
+    struct rebind { typedef TAlignedAllocator<U, Align> other; };
+
+    TAlignedAllocator() noexcept {}
+    template<typename U>
+    TAlignedAllocator(const TAlignedAllocator<U, Align>&) noexcept {}
+
+    T* allocate(size_t n)
+    {
+        if (n > size_t(-1) / sizeof(T))
+            throw std::bad_alloc();
+        const size_t bytes = n == 0 ? Align : (n * sizeof(T) + Align - 1) / Align * Align;
+#if defined(_MSC_VER)
+        void* p = _aligned_malloc(bytes, Align);
+#else
+        void* p = nullptr;
+        if (posix_memalign(&p, Align < sizeof(void*) ? sizeof(void*) : Align, bytes) != 0)
+            p = nullptr;
+#endif
+        if (p == nullptr)
+            throw std::bad_alloc();
+        return static_cast<T*>(p);
+    }
+    void deallocate(T* p, size_t) noexcept
+    {
+#if defined(_MSC_VER)
+        _aligned_free(p);
+#else
+        std::free(p);
+#endif
+    }
+
+    friend bool operator==(const TAlignedAllocator&, const TAlignedAllocator&) noexcept { return true; }
+    friend bool operator!=(const TAlignedAllocator&, const TAlignedAllocator&) noexcept { return false; }
+};
+
+// Создание массива из n элементов в памяти аллокатора. Если zero = false,
+// элементы тривиальных типов не инициализируются.
+template<typename T, typename Alloc>
+void mem_construct(Alloc&, T* p, size_t n, bool zero, std::true_type)
+{
+    if (zero && n != 0)
+        std::memset(p, 0, n * sizeof(T));
+}
+
+template<typename T, typename Alloc>
+void mem_construct(Alloc& a, T* p, size_t n, bool, std::false_type)
+{
+    size_t i = 0;
+    try {
+        for (; i < n; i++)
+            std::allocator_traits<Alloc>::construct(a, p + i);
+    }
+    catch (...) {
+        while (i > 0)
+            std::allocator_traits<Alloc>::destroy(a, p + --i);
+        throw;
+    }
+}
+
+template<typename Alloc>
+typename Alloc::value_type* mem_create(Alloc& a, size_t n, bool zero)
+{
+    typedef typename Alloc::value_type T;
+    T* p = std::allocator_traits<Alloc>::allocate(a, n);
+    try {
+        mem_construct(a, p, n, zero, std::integral_constant<bool,
+            std::is_trivially_default_constructible<T>::value && std::is_arithmetic<T>::value>());
+    }
+    catch (...) {
+        std::allocator_traits<Alloc>::deallocate(a, p, n);
+        throw;
+    }
+    return p;
+}
+
+template<typename Alloc>
+void mem_destroy(Alloc& a, typename Alloc::value_type* p, size_t n) noexcept
+{
+    if (p == nullptr)
+        return;
+    if (!std::is_trivially_destructible<typename Alloc::value_type>::value)
+        for (size_t i = 0; i < n; i++)
+            std::allocator_traits<Alloc>::destroy(a, p + i);
+    std::allocator_traits<Alloc>::deallocate(a, p, n);
+}
+
+// Метка конструктора без инициализации элементов: применяется, когда
+// вызывающий код сразу перезаписывает всю память
+struct TUninitialized {};
+const TUninitialized uninitialized = TUninitialized();
+
+template<typename T>
+struct TMemBitwiseCopy : std::is_trivially_copyable<T> {};
+
+template<typename T>
+struct TMemBitwiseEqual : std::integral_constant<bool, std::is_integral<T>::value || std::is_pointer<T>::value> {};
+
+template<typename T>
+void mem_copy(const T* src, size_t n, T* dst, std::true_type)
+{
+    if (n != 0)
+        std::memcpy(dst, src, n * sizeof(T));
+}
+
+template<typename T>
+void mem_copy(const T* src, size_t n, T* dst, std::false_type)
+{
+    std::copy(src, src + n, dst);
+}
+
+// копирование n элементов в непересекающийся массив dst
+template<typename T>
+void mem_copy(const T* src, size_t n, T* dst)
+{
+    mem_copy(src, n, dst, TMemBitwiseCopy<T>());
+}
+
+template<typename T>
+bool mem_equal(const T* a, const T* b, size_t n, std::true_type)
+{
+    return n == 0 || std::memcmp(a, b, n * sizeof(T)) == 0;
+}
+
+template<typename T>
+bool mem_equal(const T* a, const T* b, size_t n, std::false_type)
+{
+    return std::equal(a, a + n, b);
+}
+
+template<typename T>
+bool mem_equal(const T* a, const T* b, size_t n)
+{
+    return a == b || mem_equal(a, b, n, TMemBitwiseEqual<T>());
+}
+
+template<typename T>
+void mem_fill(T* dst, size_t n, const T& val, std::true_type)
+{
+    unsigned char bytes[sizeof(T)];
+    std::memcpy(bytes, &val, sizeof(T));
+    const bool zero = std::all_of(bytes, bytes + sizeof(T), [](unsigned char c) { return c == 0; });
+    if (zero && n != 0)
+        std::memset(dst, 0, n * sizeof(T));
+    else
+        std::fill(dst, dst + n, val);
+}
+
+template<typename T>
+void mem_fill(T* dst, size_t n, const T& val, std::false_type)
+{
+    std::fill(dst, dst + n, val);
+}
+
+template<typename T>
+void mem_fill(T* dst, size_t n, const T& val)
+{
+    mem_fill(dst, n, val, TMemBitwiseCopy<T>());
+}
+
+#endif
@@ -0,0 +1,242 @@
+// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Ядра для матриц в упакованном формате
+//
+// Верхнетреугольная матрица порядка n хранится построчно: строка i
+// содержит элементы (i, i) ... (i, n - 1) и начинается с позиции
+// upper_offset(n, i), всего n (n + 1) / 2 элементов. Симметричная матрица
+// хранит в том же формате свой верхний треугольник.
+//
+// Произведение треугольных матриц и SYRK используют микроядра GEMM
+// (tgemm.h); блоки результата, целиком лежащие под диагональю, не
+// считаются вовсе.
+
+#ifndef __TPacked_H__
+#define __TPacked_H__
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+#include "tmemory.h"
+#include "tsimd.h"
+#include "tgemm.h"
+
+namespace kernels
+{
+
+inline size_t upper_offset(size_t n, size_t i)
+{
+    return i * n - i * (i - 1) / 2;
+}
+
+inline size_t upper_count(size_t n)
+{
+    return n * (n + 1) / 2;
+}
+
+// Упаковка блока (i0.., k0..) размера mc x kc верхнетреугольной A
+// в панели по MR строк (как gemm_pack_a)
+template<typename T>
+void trmm_pack_a(size_t n, size_t i0, size_t k0, size_t mc, size_t kc, T alpha, const T* a, T* buf, size_t MR)
+{
+    for (size_t i = 0; i < mc; i += MR) {
+        const size_t mr = mc - i < MR ? mc - i : MR;
+        for (size_t k = 0; k < kc; k++) {
+            for (size_t r = 0; r < mr; r++) {
+                const size_t row = i0 + i + r, col = k0 + k;
+                buf[r] = col >= row ? alpha * a[upper_offset(n, row) + col - row] : T();
+            }
+            for (size_t r = mr; r < MR; r++)
+                buf[r] = T();
+            buf += MR;
+        }
+    }
+}
+
+// Упаковка блока (k0.., j0..) размера kc x nc верхнетреугольной B
+// в панели по NR столбцов (как gemm_pack_b)
+template<typename T>
+void trmm_pack_b(size_t n, size_t k0, size_t j0, size_t kc, size_t nc, const T* b, T* buf, size_t NR)
+{
+    for (size_t j = 0; j < nc; j += NR) {
+        const size_t nr = nc - j < NR ? nc - j : NR;
+        for (size_t k = 0; k < kc; k++) {
+            const size_t row = k0 + k;
+            const T* src = b + upper_offset(n, row) - row;
+            for (size_t c = 0; c < nr; c++) {
+                const size_t col = j0 + j + c;
+                buf[c] = col >= row ? src[col] : T();
+            }
+            for (size_t c = nr; c < NR; c++)
+                buf[c] = T();
+            buf += NR;
+        }
+    }
+}
+
+// Блок C (ic.., jc..) размера mc x nc: суммирование только по
+// k из [ic, jc + nc), вне этого отрезка A или B равны нулю
+template<typename T>
+void trmm_upper_block(size_t n, size_t ic, size_t jc, size_t mc, size_t nc, T alpha, const T* a, const T* b, T* c)
+{
+    typedef TGemmBlocking<T> P;
+    const TKernelTable<T> ker = kernel_table<T>();
+    const size_t MR = ker.MR;
+    const size_t NR = ker.NR;
+    const size_t kEnd = jc + nc;
+    std::vector<T, TAlignedAllocator<T>> bufA(((mc + MR - 1) / MR) * MR * P::KC);
+    std::vector<T, TAlignedAllocator<T>> bufB(((nc + NR - 1) / NR) * NR * P::KC);
+    std::vector<T, TAlignedAllocator<T>> tile(mc * nc);
+
+    for (size_t pc = ic; pc < kEnd; pc += P::KC) {
+        const size_t kc = kEnd - pc < P::KC ? kEnd - pc : P::KC;
+        trmm_pack_b(n, pc, jc, kc, nc, b, bufB.data(), NR);
+        trmm_pack_a(n, ic, pc, mc, kc, alpha, a, bufA.data(), MR);
+        for (size_t jr = 0; jr < nc; jr += NR) {
+            const size_t nr = nc - jr < NR ? nc - jr : NR;
+            for (size_t ir = 0; ir < mc; ir += MR) {
+                // плитка целиком под диагональю
+                if (jc + jr + nr <= ic + ir)
+                    continue;
+                const size_t mr = mc - ir < MR ? mc - ir : MR;
+                ker.gemm_micro(kc, bufA.data() + ir * kc, bufB.data() + jr * kc,
+                    tile.data() + ir * nc + jr, nc, mr, nr);
+            }
+        }
+    }
+    for (size_t i = 0; i < mc; i++) {
+        const size_t row = ic + i;
+        const size_t j0 = row > jc ? row - jc : 0;
+        if (j0 < nc)
+            std::copy(tile.data() + i * nc + j0, tile.data() + (i + 1) * nc,
+                c + upper_offset(n, row) + jc + j0 - row);
+    }
+}
+
+// C = alpha A B для верхнетреугольных A, B, C порядка n
+template<typename T>
+void trmm_upper(size_t n, T alpha, const T* a, const T* b, T* c)
+{
+    typedef TGemmBlocking<T> P;
+    const size_t MB = P::MC;
+    const size_t NB = P::KC;
+    const size_t rowBlocks = (n + MB - 1) / MB;
+    const size_t colBlocks = (n + NB - 1) / NB;
+    auto body = [&](size_t tb, size_t te) {
+        for (size_t t = tb; t < te; t++) {
+            const size_t ic = t / colBlocks * MB, jc = t % colBlocks * NB;
+            const size_t mc = n - ic < MB ? n - ic : MB;
+            const size_t nc = n - jc < NB ? n - jc : NB;
+            if (jc + nc > ic)
+                trmm_upper_block(n, ic, jc, mc, nc, alpha, a, b, c);
+        }
+    };
+    // n^3 / 3 операций
+    if (double(n) * n * n / 3 < PARALLEL_MIN_FLOPS)
+        body(0, rowBlocks * colBlocks);
+    else
+        TThreadPool::instance().parallel_for(0, rowBlocks * colBlocks, 1, body);
+}
+
+// y = A x для верхнетреугольной A порядка n
+template<typename T>
+void trmv_upper(size_t n, const T* a, const T* x, T* y)
+{
+    const TKernelTable<T>& t = kernel_table<T>();
+    auto body = [&](size_t ib, size_t ie) {
+        for (size_t i = ib; i < ie; i++)
+            y[i] = t.dot(n - i, a + upper_offset(n, i), x + i);
+    };
+    if (upper_count(n) < PARALLEL_MIN_ELEMENTS)
+        body(0, n);
+    else {
+        const size_t rows = PARALLEL_GRAIN / n;
+        TThreadPool::instance().parallel_for(0, n, rows < 4 ? 4 : rows, body);
+    }
+}
+
+// y = A x для симметричной A порядка n, хранящей верхний треугольник.
+// Строка i даёт y[i] скалярным произведением и одновременно добавляет
+// x[i] * a(i, j) в y[j], j > i, так что каждый элемент читается один раз.
+// Для параллельной работы строки делятся на фиксированное (не зависящее
+// от числа потоков) число частей со своими копиями y, которые затем
+// складываются по порядку.
+template<typename T>
+void spmv_upper(size_t n, const T* a, const T* x, T* y)
+{
+    const TKernelTable<T>& t = kernel_table<T>();
+    const size_t total = upper_count(n);
+    size_t parts = total / PARALLEL_MIN_ELEMENTS;
+    if (parts > 8)
+        parts = 8;
+    if (parts < 1)
+        parts = 1;
+    auto rows = [&](size_t ib, size_t ie, T* res) {
+        std::fill(res, res + n, T());
+        for (size_t i = ib; i < ie; i++) {
+            const T* row = a + upper_offset(n, i);
+            res[i] += row[0] * x[i] + t.dot_axpy(n - i - 1, row + 1, x + i + 1, x[i], res + i + 1);
+        }
+    };
+    if (parts == 1) {
+        rows(0, n, y);
+        return;
+    }
+    // границы частей с примерно равным числом элементов
+    std::vector<size_t> bound(parts + 1, n);
+    bound[0] = 0;
+    for (size_t i = 0, p = 1; i < n && p < parts; i++)
+        if (upper_offset(n, i + 1) >= total * p / parts)
+            bound[p++] = i + 1;
+    std::vector<T, TAlignedAllocator<T>> partial((parts - 1) * n);
+    TThreadPool::instance().parallel_for(0, parts, 1, [&](size_t pb, size_t pe) {
+        for (size_t p = pb; p < pe; p++)
+            rows(bound[p], bound[p + 1], p == 0 ? y : partial.data() + (p - 1) * n);
+    });
+    for (size_t p = 1; p < parts; p++)
+        t.axpy(n, T(1), partial.data() + (p - 1) * n, y);
+}
+
+// C = alpha A A^T + beta C: A - n x k со строками через lda, C -
+// симметричная порядка n в упакованном формате. Считаются только блоки
+// на диагонали и над ней; при beta == 0 исходное содержимое C не читается.
+template<typename T>
+void syrk_upper(size_t n, size_t k, T alpha, const T* a, size_t lda, T beta, T* c)
+{
+    typedef TGemmBlocking<T> P;
+    const size_t MB = P::MC;
+    const size_t NB = P::KC;
+    const size_t rowBlocks = (n + MB - 1) / MB;
+    const size_t colBlocks = (n + NB - 1) / NB;
+    auto body = [&](size_t tb, size_t te) {
+        std::vector<T, TAlignedAllocator<T>> tile(MB * NB);
+        for (size_t t = tb; t < te; t++) {
+            const size_t ic = t / colBlocks * MB, jc = t % colBlocks * NB;
+            const size_t mc = n - ic < MB ? n - ic : MB;
+            const size_t nc = n - jc < NB ? n - jc : NB;
+            if (jc + nc <= ic)
+                continue;
+            gemm_serial(mc, nc, k, alpha, a + ic * lda, ptrdiff_t(lda), 1,
+                a + jc * lda, 1, ptrdiff_t(lda), T(), tile.data(), nc);
+            for (size_t i = 0; i < mc; i++) {
+                const size_t row = ic + i;
+                const size_t j0 = row > jc ? row - jc : 0;
+                if (j0 >= nc)
+                    continue;
+                T* dst = c + upper_offset(n, row) + jc + j0 - row;
+                const T* src = tile.data() + i * nc + j0;
+                for (size_t j = 0; j < nc - j0; j++)
+                    dst[j] = gemv_update(T(1), src[j], beta, dst[j]);
+            }
+        }
+    };
+    // n^2 k операций
+    if (double(n) * n * k < PARALLEL_MIN_FLOPS)
+        body(0, rowBlocks * colBlocks);
+    else
+        TThreadPool::instance().parallel_for(0, rowBlocks * colBlocks, 1, body);
+}
+
+} // namespace kernels
+
+#endif
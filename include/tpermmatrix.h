@@ -0,0 +1,144 @@
+// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Матрица перестановки
+//
+// Хранится массив p из n номеров: в строке i единица стоит в столбце
+// p[i]. Умножение слева переставляет строки (или элементы вектора),
+// справа - столбцы, за O(n) и O(n^2) операций без построения плотной
+// формы (ядра - см. tdiag.h).
+
+#ifndef __TPermutationMatrix_H__
+#define __TPermutationMatrix_H__
+
+#include <vector>
+#include "tmatrix.h"
+#include "tdiag.h"
+
+class TPermutationMatrix
+{
+    std::vector<size_t> perm;
+public:
+    // единичная перестановка
+    explicit TPermutationMatrix(size_t s = 1) : perm(s)
+    {
+        if (s == 0 || s > MAX_VECTOR_SIZE)
+            throw length_error("Matrix size should be greater than zero");
+        for (size_t i = 0; i < s; i++)
+            perm[i] = i;
+    }
+    // p должен содержать каждое число от 0 до n - 1 ровно один раз
+    explicit TPermutationMatrix(const std::vector<size_t>& p) : perm(p)
+    {
+        if (p.empty() || p.size() > MAX_VECTOR_SIZE)
+            throw length_error("Matrix size should be greater than zero");
+        std::vector<bool> seen(p.size(), false);
+        for (size_t i = 0; i < p.size(); i++) {
+            if (p[i] >= p.size() || seen[p[i]])
+                throw logic_error("not a permutation");
+            seen[p[i]] = true;
+        }
+    }
+
+    size_t size() const noexcept { return perm.size(); }
+    const size_t* data() const noexcept { return perm.data(); }
+
+    // столбец единицы в строке i
+    size_t operator[](size_t ind) const { return perm[ind]; }
+    size_t at(size_t ind) const
+    {
+        if (ind >= perm.size()) throw out_of_range("out of range");
+        return perm[ind];
+    }
+    // элемент (i, j) типа T, как у dense<T>() и других форматов
+    template<typename T = double>
+    T get(size_t i, size_t j) const
+    {
+        if (i >= perm.size() || j >= perm.size()) throw out_of_range("out of range");
+        return perm[i] == j ? T(1) : T();
+    }
+
+    // перестановка строк i и j (умножение слева на транспозицию)
+    void swap_rows(size_t i, size_t j)
+    {
+        if (i >= perm.size() || j >= perm.size()) throw out_of_range("out of range");
+        std::swap(perm[i], perm[j]);
+    }
+
+    // обратная перестановка, она же транспонированная матрица
+    TPermutationMatrix inverse() const
+    {
+        TPermutationMatrix res(perm.size());
+        for (size_t i = 0; i < perm.size(); i++)
+            res.perm[perm[i]] = i;
+        return res;
+    }
+
+    template<typename T>
+    TDynamicMatrix<T> dense() const
+    {
+        TDynamicMatrix<T> res(perm.size());
+        for (size_t i = 0; i < perm.size(); i++)
+            res[i][perm[i]] = T(1);
+        return res;
+    }
+
+    // (P Q)[i] = Q[P[i]]
+    TPermutationMatrix operator*(const TPermutationMatrix& m) const
+    {
+        if (perm.size() != m.perm.size()) throw logic_error("different lengths");
+        TPermutationMatrix res(perm.size());
+        for (size_t i = 0; i < perm.size(); i++)
+            res.perm[i] = m.perm[perm[i]];
+        return res;
+    }
+
+    bool operator==(const TPermutationMatrix& m) const noexcept { return perm == m.perm; }
+    bool operator!=(const TPermutationMatrix& m) const noexcept { return perm != m.perm; }
+
+    friend ostream& operator<<(ostream& ostr, const TPermutationMatrix& v)
+    {
+        for (size_t i = 0; i < v.size(); i++)
+            ostr << v.perm[i] << ' ';
+        return ostr;
+    }
+};
+
+// Произведения. Результат получает аллокатор плотного операнда.
+
+// P x
+template<typename R>
+TDynamicVector<typename R::value_type, typename TExprAllocator<R>::type>
+operator*(const TPermutationMatrix& p, const TExpr<R, TVectorTag>& r)
+{
+    const auto& x = materialize(r.self());
+    if (p.size() != x.size()) throw logic_error("different lengths");
+    TDynamicVector<typename R::value_type, typename TExprAllocator<R>::type> res(x.size(), uninitialized, x.get_allocator());
+    kernels::perm_gather(x.size(), p.data(), x.data(), res.data());
+    return res;
+}
+
+// P A - перестановка строк
+template<typename R>
+TDynamicMatrix<typename R::value_type, typename TExprAllocator<R>::type>
+operator*(const TPermutationMatrix& p, const TExpr<R, TMatrixTag>& r)
+{
+    const auto& a = materialize(r.self());
+    if (p.size() != a.size()) throw logic_error("different lengths");
+    TDynamicMatrix<typename R::value_type, typename TExprAllocator<R>::type> res(a.size(), uninitialized, a.get_allocator());
+    kernels::perm_rows(a.size(), p.data(), a.data(), res.data());
+    return res;
+}
+
+// A P - перестановка столбцов
+template<typename L>
+TDynamicMatrix<typename L::value_type, typename TExprAllocator<L>::type>
+operator*(const TExpr<L, TMatrixTag>& l, const TPermutationMatrix& p)
+{
+    const auto& a = materialize(l.self());
+    if (p.size() != a.size()) throw logic_error("different lengths");
+    TDynamicMatrix<typename L::value_type, typename TExprAllocator<L>::type> res(a.size(), uninitialized, a.get_allocator());
+    kernels::perm_cols(a.size(), p.data(), a.data(), res.data());
+    return res;
+}
+
+#endif
@@ -0,0 +1,287 @@
+// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Прямоугольная матрица
+//
+// Матрица m x n хранится построчно в одном буфере ровно из m n
+// элементов. Порядки ограничены не MAX_MATRIX_SIZE, а общим числом
+// элементов (MAX_VECTOR_SIZE), так что «высокие» матрицы вида
+// 1000000 x 16 не нужно дополнять до квадратных. Произведение m x k на
+// k x n считается блочным GEMM за m n k операций.
+
+#ifndef __TRectMatrix_H__
+#define __TRectMatrix_H__
+
+#include "tmatrix.h"
+
+// Вид операнда: прямоугольные матрицы смешиваются только между собой,
+// при совпадении обоих размеров
+struct TRectTag
+{
+    static const char* mismatch() { return "different shapes"; }
+};
+
+// Читает ли выражение e элементы блока p (rows x cols, строки через ld)
+// не по тем же индексам, по которым в этот блок пишется результат.
+// Поэлементное вычисление на месте безопасно, пока каждый элемент
+// читается там же, куда пишется; операнды, переставляющие элементы
+// (сдвинутые представления, транспонирование - tview.h, ttranspose.h),
+// объявляют свои перегрузки.
+template<typename E, typename T>
+bool expr_permutes(const E&, const T*, size_t, size_t, size_t)
+{
+    return false;
+}
+template<typename L, typename R, typename Op, typename T>
+bool expr_permutes(const TBinaryExpr<L, R, Op>& e, const T* p, size_t rows, size_t cols, size_t ld)
+{
+    return expr_permutes(e.lhs(), p, rows, cols, ld) || expr_permutes(e.rhs(), p, rows, cols, ld);
+}
+template<typename L, typename Op, typename T>
+bool expr_permutes(const TScalarExpr<L, Op>& e, const T* p, size_t rows, size_t cols, size_t ld)
+{
+    return expr_permutes(e.lhs(), p, rows, cols, ld);
+}
+
+template<typename T, typename Alloc = TAlignedAllocator<T>>
+class TRectMatrix : public TExpr<TRectMatrix<T, Alloc>, TRectTag>
+{
+    size_t nrows, ncols;
+    TDynamicVector<T, Alloc> mem;
+
+    static size_t area(size_t rows, size_t cols)
+    {
+        if (rows == 0 || cols == 0)
+            throw length_error("Matrix size should be greater than zero");
+        if (rows > MAX_VECTOR_SIZE / cols)
+            throw length_error("Matrix should contain less than MAX_VECTOR_SIZE elements");
+        return rows * cols;
+    }
+
+    // вычисление выражения той же формы на место; выражение, читающее
+    // эту же матрицу в другом порядке, вычисляется через копию
+    template<typename E>
+    void assign(const E& e)
+    {
+        if (expr_permutes(e, mem.data(), nrows, ncols, ncols)) {
+            const TRectMatrix<T> tmp(e);
+            mem_copy(tmp.data(), count(), mem.data());
+        }
+        else
+            expr_assign(mem.data(), e);
+    }
+public:
+    typedef T value_type;
+    typedef Alloc allocator_type;
+
+    TRectMatrix(size_t rows = 1, size_t cols = 1, const Alloc& a = Alloc())
+        : nrows(rows), ncols(cols), mem(area(rows, cols), a) {}
+    TRectMatrix(size_t rows, size_t cols, TUninitialized, const Alloc& a = Alloc())
+        : nrows(rows), ncols(cols), mem(area(rows, cols), uninitialized, a) {}
+    // копия квадратной матрицы
+    template<typename A>
+    explicit TRectMatrix(const TDynamicMatrix<T, A>& m, const Alloc& a = Alloc())
+        : TRectMatrix(m.size(), m.size(), uninitialized, a)
+    {
+        mem_copy(m.data(), m.count(), mem.data());
+    }
+    // вычисление выражения за один проход
+    template<typename E>
+    TRectMatrix(const TExpr<E, TRectTag>& e, const Alloc& a = Alloc())
+        : TRectMatrix(e.self().size(), e.self().layout(), uninitialized, a)
+    {
+        static_assert(std::is_same<typename E::value_type, T>::value, "element types differ");
+        expr_assign(mem.data(), e.self());
+    }
+    TRectMatrix(const TRectMatrix& m) = default;
+    TRectMatrix(TRectMatrix&& m) noexcept : nrows(m.nrows), ncols(m.ncols), mem(std::move(m.mem))
+    {
+        m.nrows = m.ncols = 0;
+    }
+    TRectMatrix& operator=(const TRectMatrix& m) = default;
+    TRectMatrix& operator=(TRectMatrix&& m) noexcept
+    {
+        nrows = m.nrows;
+        ncols = m.ncols;
+        mem = std::move(m.mem);
+        m.nrows = m.ncols = 0;
+        return *this;
+    }
+    template<typename E>
+    TRectMatrix& operator=(const TExpr<E, TRectTag>& e)
+    {
+        if (nrows != e.self().size() || ncols != e.self().layout()) {
+            TRectMatrix tmp(e);
+            swap(*this, tmp);
+        }
+        else
+            assign(e.self());
+        return *this;
+    }
+
+    size_t rows() const noexcept { return nrows; }
+    size_t cols() const noexcept { return ncols; }
+    // для выражений: size() - число строк, layout() - число столбцов
+    size_t size() const noexcept { return nrows; }
+    size_t count() const noexcept { return nrows * ncols; }
+    size_t layout() const noexcept { return ncols; }
+    const T& elem(size_t i) const { return mem.data()[i]; }
+
+    // непосредственный доступ к памяти (построчно, строки через stride())
+    T* data() noexcept { return mem.data(); }
+    const T* data() const noexcept { return mem.data(); }
+    size_t stride() const noexcept { return ncols; }
+
+    void fill(const T& val) { mem.fill(val); }
+
+    // индексация
+    TMatrixRow<T> operator[](size_t ind)
+    {
+        return TMatrixRow<T>(mem.data() + ind * ncols, ncols);
+    }
+    TMatrixRow<const T> operator[](size_t ind) const
+    {
+        return TMatrixRow<const T>(mem.data() + ind * ncols, ncols);
+    }
+    // индексация с контролем
+    TMatrixRow<T> at(size_t ind)
+    {
+        if (ind >= nrows) throw out_of_range("out of range");
+        return (*this)[ind];
+    }
+    TMatrixRow<const T> at(size_t ind) const
+    {
+        if (ind >= nrows) throw out_of_range("out of range");
+        return (*this)[ind];
+    }
+
+    // квадратная матрица в формате TDynamicMatrix
+    TDynamicMatrix<T, Alloc> dense() const
+    {
+        if (nrows != ncols) throw logic_error("matrix is not square");
+        TDynamicMatrix<T, Alloc> res(nrows, uninitialized, mem.get_allocator());
+        mem_copy(mem.data(), count(), res.data());
+        return res;
+    }
+
+    // сравнение
+    bool operator==(const TRectMatrix& m) const noexcept
+    {
+        return nrows == m.nrows && ncols == m.ncols && mem == m.mem;
+    }
+    bool operator!=(const TRectMatrix& m) const noexcept
+    {
+        return !(*this == m);
+    }
+
+    // поэлементные операции - см. texpr.h, произведения - после
+    // определения класса
+
+    // операции с присваиванием, без выделения памяти
+    template<typename E>
+    TRectMatrix& operator+=(const TExpr<E, TRectTag>& e)
+    {
+        assign(*this + e.self());
+        return *this;
+    }
+    template<typename E>
+    TRectMatrix& operator-=(const TExpr<E, TRectTag>& e)
+    {
+        assign(*this - e.self());
+        return *this;
+    }
+    TRectMatrix& operator*=(const T& val)
+    {
+        expr_assign(mem.data(), *this * val);
+        return *this;
+    }
+
+    allocator_type get_allocator() const { return mem.get_allocator(); }
+
+    friend void swap(TRectMatrix& lhs, TRectMatrix& rhs) noexcept
+    {
+        std::swap(lhs.nrows, rhs.nrows);
+        std::swap(lhs.ncols, rhs.ncols);
+        swap(lhs.mem, rhs.mem);
+    }
+
+    // ввод/вывод
+    friend istream& operator>>(istream& istr, TRectMatrix& v)
+    {
+        for (size_t i = 0; i < v.nrows; i++)
+            istr >> v[i];
+        return istr;
+    }
+    friend ostream& operator<<(ostream& ostr, const TRectMatrix& v)
+    {
+        for (size_t i = 0; i < v.nrows; i++)
+            ostr << v[i] << endl;
+        return ostr;
+    }
+};
+
+template<typename T, typename A>
+struct TExprDense<TRectMatrix<T, A>> : std::true_type {};
+template<typename T, typename A>
+struct TExprOwner<TRectMatrix<T, A>> : std::true_type {};
+
+template<typename T, typename A>
+const TRectMatrix<T, A>& materialize(const TRectMatrix<T, A>& m) { return m; }
+template<typename E>
+TRectMatrix<typename E::value_type> materialize(const TExpr<E, TRectTag>& e)
+{
+    return TRectMatrix<typename E::value_type>(e);
+}
+
+// Произведения. Результат получает аллокатор левого операнда.
+// Операнды-листья передаются ядрам с шагом строк stride(), поэтому
+// так же, без копирования, умножаются и представления (см. tview.h).
+
+// (m x n) на вектор длины n
+template<typename L, typename R>
+TDynamicVector<typename L::value_type, typename TExprAllocator<L>::type>
+operator*(const TExpr<L, TRectTag>& l, const TExpr<R, TVectorTag>& r)
+{
+    typedef typename L::value_type T;
+    const auto& a = materialize(l.self());
+    const auto& x = materialize(r.self());
+    if (a.cols() != x.size()) throw logic_error("different lengths");
+    TDynamicVector<T, typename TExprAllocator<L>::type> res(a.rows(), uninitialized, a.get_allocator());
+    kernels::gemv(a.rows(), a.cols(), T(1), a.data(), a.stride(), x.data(), T(), res.data());
+    return res;
+}
+
+// (m x k) на (k x n)
+template<typename L, typename R>
+TRectMatrix<typename L::value_type, typename TExprAllocator<L>::type>
+operator*(const TExpr<L, TRectTag>& l, const TExpr<R, TRectTag>& r)
+{
+    typedef typename L::value_type T;
+    const auto& a = materialize(l.self());
+    const auto& b = materialize(r.self());
+    if (a.cols() != b.rows()) throw logic_error("different lengths");
+    const size_t m = a.rows(), n = b.cols(), k = a.cols();
+    TRectMatrix<T, typename TExprAllocator<L>::type> res(m, n, uninitialized, a.get_allocator());
+    kernels::gemm(m, n, k, T(1), a.data(), a.stride(), 1, b.data(), b.stride(), 1, T(), res.data(), n);
+    return res;
+}
+
+// y = alpha A x + beta y
+template<typename T, typename AA, typename AX, typename AY>
+void gemv(T alpha, const TRectMatrix<T, AA>& a, const TDynamicVector<T, AX>& x, T beta, TDynamicVector<T, AY>& y)
+{
+    if (a.cols() != x.size() || a.rows() != y.size()) throw logic_error("different lengths");
+    if (x.data() == y.data()) throw logic_error("result must not alias an operand");
+    kernels::gemv(a.rows(), a.cols(), alpha, a.data(), a.cols(), x.data(), beta, y.data());
+}
+
+// C = alpha A B + beta C
+template<typename T, typename AA, typename AB, typename AC>
+void gemm(T alpha, const TRectMatrix<T, AA>& a, const TRectMatrix<T, AB>& b, T beta, TRectMatrix<T, AC>& c)
+{
+    const size_t m = a.rows(), n = b.cols(), k = a.cols();
+    if (k != b.rows() || m != c.rows() || n != c.cols()) throw logic_error("different lengths");
+    if (a.data() == c.data() || b.data() == c.data()) throw logic_error("result must not alias an operand");
+    kernels::gemm(m, n, k, alpha, a.data(), k, 1, b.data(), n, 1, beta, c.data(), n);
+}
+
+#endif
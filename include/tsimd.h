@@ -0,0 +1,554 @@
+// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Вычислительные ядра с выбором набора инструкций во время выполнения
+//
+// Для float, double, int32_t и int64_t есть версии AVX2 и AVX-512,
+// для остальных типов - скалярные. Набор инструкций определяется через
+// cpuid при первом обращении; его можно понизить переменной окружения
+// TMATRIX_SIMD=scalar|avx2|avx512 или функцией set_simd_level().
+
+#ifndef __TSimd_H__
+#define __TSimd_H__
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+#include "tthreadpool.h"
+
+#if !defined(TMATRIX_NO_SIMD) && (defined(__x86_64__) || defined(_M_X64)) && \
+    (defined(__GNUC__) || defined(_MSC_VER))
+#define TMATRIX_X86_SIMD
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define TSIMD_TARGET_AVX2
+#define TSIMD_TARGET_AVX512
+#else
+#define TSIMD_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#define TSIMD_TARGET_AVX512 __attribute__((target("avx512f,avx512dq,avx2,fma")))
+#endif
+#endif
+
+namespace kernels
+{
+
+enum TSimdLevel { SIMD_SCALAR = 0, SIMD_AVX2 = 1, SIMD_AVX512 = 2 };
+
+// Максимальный уровень, поддерживаемый процессором и ОС
+inline TSimdLevel detect_simd_level()
+{
+#if defined(TMATRIX_X86_SIMD) && defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7)
+        return SIMD_SCALAR;
+    __cpuid(info, 1);
+    const bool osxsave = (info[2] & (1 << 27)) != 0;
+    const bool fma = (info[2] & (1 << 12)) != 0;
+    if (!osxsave)
+        return SIMD_SCALAR;
+    const unsigned long long xcr0 = _xgetbv(0);
+    __cpuidex(info, 7, 0);
+    const bool avx2 = (info[1] & (1 << 5)) != 0;
+    const bool avx512 = (info[1] & (1 << 16)) != 0 && (info[1] & (1 << 17)) != 0;
+    if (avx512 && fma && (xcr0 & 0xE6) == 0xE6)
+        return SIMD_AVX512;
+    if (avx2 && fma && (xcr0 & 0x6) == 0x6)
+        return SIMD_AVX2;
+    return SIMD_SCALAR;
+#elif defined(TMATRIX_X86_SIMD)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512dq"))
+        return SIMD_AVX512;
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+        return SIMD_AVX2;
+    return SIMD_SCALAR;
+#else
+    return SIMD_SCALAR;
+#endif
+}
+
+inline TSimdLevel& current_simd_level()
+{
+    static TSimdLevel level = []() {
+        TSimdLevel l = detect_simd_level();
+        const char* env = std::getenv("TMATRIX_SIMD");
+        if (env != nullptr) {
+            if (std::strcmp(env, "scalar") == 0)
+                l = SIMD_SCALAR;
+            else if (std::strcmp(env, "avx2") == 0 && l > SIMD_AVX2)
+                l = SIMD_AVX2;
+        }
+        return l;
+    }();
+    return level;
+}
+
+inline TSimdLevel simd_level() { return current_simd_level(); }
+
+// Таблица ядер для типа T
+template<typename T>
+struct TKernelTable
+{
+    // c = a + b, c = a - b
+    void (*add)(size_t n, const T* a, const T* b, T* c);
+    void (*sub)(size_t n, const T* a, const T* b, T* c);
+    // c = a + val, c = a * val
+    void (*shift)(size_t n, const T* a, T val, T* c);
+    void (*scale)(size_t n, const T* a, T val, T* c);
+    // y = y + alpha * x
+    void (*axpy)(size_t n, T alpha, const T* x, T* y);
+    T (*dot)(size_t n, const T* a, const T* b);
+    // y = y + alpha * a и скалярное произведение (a, x) за одно чтение a
+    T (*dot_axpy)(size_t n, const T* a, const T* x, T alpha, T* y);
+    // y = alpha A x + beta y, A - m x n со строками через lda;
+    // при beta == 0 исходное содержимое y не читается
+    void (*gemv)(size_t m, size_t n, T alpha, const T* a, size_t lda, const T* x, T beta, T* y);
+    // плитка GEMM: C[0:mr, 0:nr] += Apanel * Bpanel (панели шириной MR и NR)
+    void (*gemm_micro)(size_t kc, const T* a, const T* b, T* c, size_t ldc, size_t mr, size_t nr);
+    size_t MR;
+    size_t NR;
+};
+
+// Скалярные ядра
+
+template<typename T>
+void scalar_add(size_t n, const T* a, const T* b, T* c)
+{
+    for (size_t i = 0; i < n; i++)
+        c[i] = a[i] + b[i];
+}
+
+template<typename T>
+void scalar_sub(size_t n, const T* a, const T* b, T* c)
+{
+    for (size_t i = 0; i < n; i++)
+        c[i] = a[i] - b[i];
+}
+
+template<typename T>
+void scalar_shift(size_t n, const T* a, T val, T* c)
+{
+    for (size_t i = 0; i < n; i++)
+        c[i] = a[i] + val;
+}
+
+template<typename T>
+void scalar_scale(size_t n, const T* a, T val, T* c)
+{
+    for (size_t i = 0; i < n; i++)
+        c[i] = a[i] * val;
+}
+
+template<typename T>
+void scalar_axpy(size_t n, T alpha, const T* x, T* y)
+{
+    for (size_t i = 0; i < n; i++)
+        y[i] += alpha * x[i];
+}
+
+template<typename T>
+T scalar_dot(size_t n, const T* a, const T* b)
+{
+    T res = T();
+    for (size_t i = 0; i < n; i++)
+        res += a[i] * b[i];
+    return res;
+}
+
+template<typename T>
+T scalar_dot_axpy(size_t n, const T* a, const T* x, T alpha, T* y)
+{
+    T res = T();
+    for (size_t i = 0; i < n; i++) {
+        res += a[i] * x[i];
+        y[i] += alpha * a[i];
+    }
+    return res;
+}
+
+template<typename T>
+inline T gemv_update(T alpha, T d, T beta, T y)
+{
+    return beta == T() ? alpha * d : alpha * d + beta * y;
+}
+
+template<typename T>
+void scalar_gemv(size_t m, size_t n, T alpha, const T* a, size_t lda, const T* x, T beta, T* y)
+{
+    for (size_t i = 0; i < m; i++)
+        y[i] = gemv_update(alpha, scalar_dot(n, a + i * lda, x), beta, y[i]);
+}
+
+template<typename T, size_t MR, size_t NR>
+void scalar_gemm_micro(size_t kc, const T* a, const T* b, T* c, size_t ldc, size_t mr, size_t nr)
+{
+    T ab[MR][NR];
+    for (size_t r = 0; r < MR; r++)
+        for (size_t j = 0; j < NR; j++)
+            ab[r][j] = T();
+    for (size_t k = 0; k < kc; k++) {
+        for (size_t r = 0; r < MR; r++) {
+            const T ar = a[r];
+            for (size_t j = 0; j < NR; j++)
+                ab[r][j] += ar * b[j];
+        }
+        a += MR;
+        b += NR;
+    }
+    for (size_t r = 0; r < mr; r++)
+        for (size_t j = 0; j < nr; j++)
+            c[r * ldc + j] += ab[r][j];
+}
+
+// Плитка скалярного микроядра
+template<typename T>
+struct TScalarGemmTile
+{
+    static const size_t MR = 6;
+    static const size_t NR = sizeof(T) <= 4 ? 16 : (sizeof(T) <= 8 ? 8 : 4);
+};
+
+template<typename T>
+void fill_scalar_table(TKernelTable<T>& t)
+{
+    t.add = &scalar_add<T>;
+    t.sub = &scalar_sub<T>;
+    t.shift = &scalar_shift<T>;
+    t.scale = &scalar_scale<T>;
+    t.axpy = &scalar_axpy<T>;
+    t.dot = &scalar_dot<T>;
+    t.dot_axpy = &scalar_dot_axpy<T>;
+    t.gemv = &scalar_gemv<T>;
+    t.MR = TScalarGemmTile<T>::MR;
+    t.NR = TScalarGemmTile<T>::NR;
+    t.gemm_micro = &scalar_gemm_micro<T, TScalarGemmTile<T>::MR, TScalarGemmTile<T>::NR>;
+}
+
+// Обёртки над интринсиками: регистр, ширина W и арифметика.
+// has_mul == false означает, что умножение в этом наборе недоступно
+// (int64 в AVX2) и соответствующие ядра остаются скалярными.
+struct TAvx2 {};
+struct TAvx512 {};
+
+template<typename Isa, typename T>
+struct TSimdOps
+{
+    static const bool supported = false;
+};
+
+#ifdef TMATRIX_X86_SIMD
+
+template<>
+struct TSimdOps<TAvx2, double>
+{
+    static const bool supported = true;
+    static const bool has_mul = true;
+    static const size_t W = 4;
+    typedef __m256d reg;
+    TSIMD_TARGET_AVX2 static inline reg load(const double* p) { return _mm256_loadu_pd(p); }
+    TSIMD_TARGET_AVX2 static inline void store(double* p, reg a) { _mm256_storeu_pd(p, a); }
+    TSIMD_TARGET_AVX2 static inline reg set1(double v) { return _mm256_set1_pd(v); }
+    TSIMD_TARGET_AVX2 static inline reg zero() { return _mm256_setzero_pd(); }
+    TSIMD_TARGET_AVX2 static inline reg add(reg a, reg b) { return _mm256_add_pd(a, b); }
+    TSIMD_TARGET_AVX2 static inline reg sub(reg a, reg b) { return _mm256_sub_pd(a, b); }
+    TSIMD_TARGET_AVX2 static inline reg mul(reg a, reg b) { return _mm256_mul_pd(a, b); }
+    TSIMD_TARGET_AVX2 static inline reg fmadd(reg a, reg b, reg c) { return _mm256_fmadd_pd(a, b, c); }
+};
+
+template<>
+struct TSimdOps<TAvx2, float>
+{
+    static const bool supported = true;
+    static const bool has_mul = true;
+    static const size_t W = 8;
+    typedef __m256 reg;
+    TSIMD_TARGET_AVX2 static inline reg load(const float* p) { return _mm256_loadu_ps(p); }
+    TSIMD_TARGET_AVX2 static inline void store(float* p, reg a) { _mm256_storeu_ps(p, a); }
+    TSIMD_TARGET_AVX2 static inline reg set1(float v) { return _mm256_set1_ps(v); }
+    TSIMD_TARGET_AVX2 static inline reg zero() { return _mm256_setzero_ps(); }
+    TSIMD_TARGET_AVX2 static inline reg add(reg a, reg b) { return _mm256_add_ps(a, b); }
+    TSIMD_TARGET_AVX2 static inline reg sub(reg a, reg b) { return _mm256_sub_ps(a, b); }
+    TSIMD_TARGET_AVX2 static inline reg mul(reg a, reg b) { return _mm256_mul_ps(a, b); }
+    TSIMD_TARGET_AVX2 static inline reg fmadd(reg a, reg b, reg c) { return _mm256_fmadd_ps(a, b, c); }
+};
+
+template<>
+struct TSimdOps<TAvx2, int32_t>
+{
+    static const bool supported = true;
+    static const bool has_mul = true;
+    static const size_t W = 8;
+    typedef __m256i reg;
+    TSIMD_TARGET_AVX2 static inline reg load(const int32_t* p) { return _mm256_loadu_si256((const __m256i*)p); }
+    TSIMD_TARGET_AVX2 static inline void store(int32_t* p, reg a) { _mm256_storeu_si256((__m256i*)p, a); }
+    TSIMD_TARGET_AVX2 static inline reg set1(int32_t v) { return _mm256_set1_epi32(v); }
+    TSIMD_TARGET_AVX2 static inline reg zero() { return _mm256_setzero_si256(); }
+    TSIMD_TARGET_AVX2 static inline reg add(reg a, reg b) { return _mm256_add_epi32(a, b); }
+    TSIMD_TARGET_AVX2 static inline reg sub(reg a, reg b) { return _mm256_sub_epi32(a, b); }
+    TSIMD_TARGET_AVX2 static inline reg mul(reg a, reg b) { return _mm256_mullo_epi32(a, b); }
+    TSIMD_TARGET_AVX2 static inline reg fmadd(reg a, reg b, reg c) { return add(mul(a, b), c); }
+};
+
+template<>
+struct TSimdOps<TAvx2, int64_t>
+{
+    static const bool supported = true;
+    static const bool has_mul = false;
+    static const size_t W = 4;
+    typedef __m256i reg;
+    TSIMD_TARGET_AVX2 static inline reg load(const int64_t* p) { return _mm256_loadu_si256((const __m256i*)p); }
+    TSIMD_TARGET_AVX2 static inline void store(int64_t* p, reg a) { _mm256_storeu_si256((__m256i*)p, a); }
+    TSIMD_TARGET_AVX2 static inline reg set1(int64_t v) { return _mm256_set1_epi64x(v); }
+    TSIMD_TARGET_AVX2 static inline reg zero() { return _mm256_setzero_si256(); }
+    TSIMD_TARGET_AVX2 static inline reg add(reg a, reg b) { return _mm256_add_epi64(a, b); }
+    TSIMD_TARGET_AVX2 static inline reg sub(reg a, reg b) { return _mm256_sub_epi64(a, b); }
+};
+
+template<>
+struct TSimdOps<TAvx512, double>
+{
+    static const bool supported = true;
+    static const bool has_mul = true;
+    static const size_t W = 8;
+    typedef __m512d reg;
+    TSIMD_TARGET_AVX512 static inline reg load(const double* p) { return _mm512_loadu_pd(p); }
+    TSIMD_TARGET_AVX512 static inline void store(double* p, reg a) { _mm512_storeu_pd(p, a); }
+    TSIMD_TARGET_AVX512 static inline reg set1(double v) { return _mm512_set1_pd(v); }
+    TSIMD_TARGET_AVX512 static inline reg zero() { return _mm512_setzero_pd(); }
+    TSIMD_TARGET_AVX512 static inline reg add(reg a, reg b) { return _mm512_add_pd(a, b); }
+    TSIMD_TARGET_AVX512 static inline reg sub(reg a, reg b) { return _mm512_sub_pd(a, b); }
+    TSIMD_TARGET_AVX512 static inline reg mul(reg a, reg b) { return _mm512_mul_pd(a, b); }
+    TSIMD_TARGET_AVX512 static inline reg fmadd(reg a, reg b, reg c) { return _mm512_fmadd_pd(a, b, c); }
+};
+
+template<>
+struct TSimdOps<TAvx512, float>
+{
+    static const bool supported = true;
+    static const bool has_mul = true;
+    static const size_t W = 16;
+    typedef __m512 reg;
+    TSIMD_TARGET_AVX512 static inline reg load(const float* p) { return _mm512_loadu_ps(p); }
+    TSIMD_TARGET_AVX512 static inline void store(float* p, reg a) { _mm512_storeu_ps(p, a); }
+    TSIMD_TARGET_AVX512 static inline reg set1(float v) { return _mm512_set1_ps(v); }
+    TSIMD_TARGET_AVX512 static inline reg zero() { return _mm512_setzero_ps(); }
+    TSIMD_TARGET_AVX512 static inline reg add(reg a, reg b) { return _mm512_add_ps(a, b); }
+    TSIMD_TARGET_AVX512 static inline reg sub(reg a, reg b) { return _mm512_sub_ps(a, b); }
+    TSIMD_TARGET_AVX512 static inline reg mul(reg a, reg b) { return _mm512_mul_ps(a, b); }
+    TSIMD_TARGET_AVX512 static inline reg fmadd(reg a, reg b, reg c) { return _mm512_fmadd_ps(a, b, c); }
+};
+
+template<>
+struct TSimdOps<TAvx512, int32_t>
+{
+    static const bool supported = true;
+    static const bool has_mul = true;
+    static const size_t W = 16;
+    typedef __m512i reg;
+    TSIMD_TARGET_AVX512 static inline reg load(const int32_t* p) { return _mm512_loadu_si512(p); }
+    TSIMD_TARGET_AVX512 static inline void store(int32_t* p, reg a) { _mm512_storeu_si512(p, a); }
+    TSIMD_TARGET_AVX512 static inline reg set1(int32_t v) { return _mm512_set1_epi32(v); }
+    TSIMD_TARGET_AVX512 static inline reg zero() { return _mm512_setzero_si512(); }
+    TSIMD_TARGET_AVX512 static inline reg add(reg a, reg b) { return _mm512_add_epi32(a, b); }
+    TSIMD_TARGET_AVX512 static inline reg sub(reg a, reg b) { return _mm512_sub_epi32(a, b); }
+    TSIMD_TARGET_AVX512 static inline reg mul(reg a, reg b) { return _mm512_mullo_epi32(a, b); }
+    TSIMD_TARGET_AVX512 static inline reg fmadd(reg a, reg b, reg c) { return add(mul(a, b), c); }
+};
+
+template<>
+struct TSimdOps<TAvx512, int64_t>
+{
+    static const bool supported = true;
+    static const bool has_mul = true;
+    static const size_t W = 8;
+    typedef __m512i reg;
+    TSIMD_TARGET_AVX512 static inline reg load(const int64_t* p) { return _mm512_loadu_si512(p); }
+    TSIMD_TARGET_AVX512 static inline void store(int64_t* p, reg a) { _mm512_storeu_si512(p, a); }
+    TSIMD_TARGET_AVX512 static inline reg set1(int64_t v) { return _mm512_set1_epi64(v); }
+    TSIMD_TARGET_AVX512 static inline reg zero() { return _mm512_setzero_si512(); }
+    TSIMD_TARGET_AVX512 static inline reg add(reg a, reg b) { return _mm512_add_epi64(a, b); }
+    TSIMD_TARGET_AVX512 static inline reg sub(reg a, reg b) { return _mm512_sub_epi64(a, b); }
+    TSIMD_TARGET_AVX512 static inline reg mul(reg a, reg b) { return _mm512_mullo_epi64(a, b); }
+    TSIMD_TARGET_AVX512 static inline reg fmadd(reg a, reg b, reg c) { return add(mul(a, b), c); }
+};
+
+// Один и тот же текст ядер компилируется для каждого набора инструкций
+namespace avx2
+{
+#define TSIMD_ISA TAvx2
+#define TSIMD_TARGET TSIMD_TARGET_AVX2
+#include "tsimd_impl.h"
+#undef TSIMD_TARGET
+#undef TSIMD_ISA
+} // namespace avx2
+
+namespace avx512
+{
+#define TSIMD_ISA TAvx512
+#define TSIMD_TARGET TSIMD_TARGET_AVX512
+#include "tsimd_impl.h"
+#undef TSIMD_TARGET
+#undef TSIMD_ISA
+} // namespace avx512
+
+#endif // TMATRIX_X86_SIMD
+
+template<typename T>
+void fill_simd_table(TKernelTable<T>&, TSimdLevel, std::false_type)
+{
+}
+
+#ifdef TMATRIX_X86_SIMD
+template<typename T>
+void fill_simd_table(TKernelTable<T>& t, TSimdLevel level, std::true_type)
+{
+    if (level >= SIMD_AVX2)
+        avx2::fill_table(t);
+    if (level >= SIMD_AVX512)
+        avx512::fill_table(t);
+}
+#endif
+
+template<typename T>
+TKernelTable<T> make_kernel_table(TSimdLevel level)
+{
+    TKernelTable<T> t;
+    fill_scalar_table(t);
+    fill_simd_table(t, level, std::integral_constant<bool, TSimdOps<TAvx2, T>::supported>());
+    return t;
+}
+
+template<typename T>
+TKernelTable<T>& kernel_table()
+{
+    static TKernelTable<T> t = make_kernel_table<T>(simd_level());
+    return t;
+}
+
+// Понижение (или возврат) уровня; выше обнаруженного поднять нельзя.
+// Вызывать до начала вычислений: таблицы перестраиваются без блокировок.
+inline TSimdLevel set_simd_level(TSimdLevel level)
+{
+    const TSimdLevel hw = detect_simd_level();
+    current_simd_level() = level < hw ? level : hw;
+    kernel_table<float>() = make_kernel_table<float>(simd_level());
+    kernel_table<double>() = make_kernel_table<double>(simd_level());
+    kernel_table<int32_t>() = make_kernel_table<int32_t>(simd_level());
+    kernel_table<int64_t>() = make_kernel_table<int64_t>(simd_level());
+    return simd_level();
+}
+
+// Точки входа. Большие операции делятся на куски по PARALLEL_GRAIN
+// элементов и выполняются пулом потоков.
+
+const size_t PARALLEL_GRAIN = 1 << 14;
+
+template<typename T>
+inline void add(size_t n, const T* a, const T* b, T* c)
+{
+    const TKernelTable<T>& t = kernel_table<T>();
+    if (n < PARALLEL_MIN_ELEMENTS) {
+        t.add(n, a, b, c);
+        return;
+    }
+    TThreadPool::instance().parallel_for(0, n, PARALLEL_GRAIN, [&](size_t i, size_t e) {
+        t.add(e - i, a + i, b + i, c + i);
+    });
+}
+
+template<typename T>
+inline void sub(size_t n, const T* a, const T* b, T* c)
+{
+    const TKernelTable<T>& t = kernel_table<T>();
+    if (n < PARALLEL_MIN_ELEMENTS) {
+        t.sub(n, a, b, c);
+        return;
+    }
+    TThreadPool::instance().parallel_for(0, n, PARALLEL_GRAIN, [&](size_t i, size_t e) {
+        t.sub(e - i, a + i, b + i, c + i);
+    });
+}
+
+template<typename T>
+inline void shift(size_t n, const T* a, T val, T* c)
+{
+    const TKernelTable<T>& t = kernel_table<T>();
+    if (n < PARALLEL_MIN_ELEMENTS) {
+        t.shift(n, a, val, c);
+        return;
+    }
+    TThreadPool::instance().parallel_for(0, n, PARALLEL_GRAIN, [&](size_t i, size_t e) {
+        t.shift(e - i, a + i, val, c + i);
+    });
+}
+
+template<typename T>
+inline void scale(size_t n, const T* a, T val, T* c)
+{
+    const TKernelTable<T>& t = kernel_table<T>();
+    if (n < PARALLEL_MIN_ELEMENTS) {
+        t.scale(n, a, val, c);
+        return;
+    }
+    TThreadPool::instance().parallel_for(0, n, PARALLEL_GRAIN, [&](size_t i, size_t e) {
+        t.scale(e - i, a + i, val, c + i);
+    });
+}
+
+template<typename T>
+inline void axpy(size_t n, T alpha, const T* x, T* y)
+{
+    const TKernelTable<T>& t = kernel_table<T>();
+    if (n < PARALLEL_MIN_ELEMENTS) {
+        t.axpy(n, alpha, x, y);
+        return;
+    }
+    TThreadPool::instance().parallel_for(0, n, PARALLEL_GRAIN, [&](size_t i, size_t e) {
+        t.axpy(e - i, alpha, x + i, y + i);
+    });
+}
+
+// Частичные суммы считаются по фиксированным блокам и складываются
+// по порядку, так что результат не зависит от числа потоков
+template<typename T>
+inline T dot(size_t n, const T* a, const T* b)
+{
+    const TKernelTable<T>& t = kernel_table<T>();
+    if (n < PARALLEL_MIN_ELEMENTS)
+        return t.dot(n, a, b);
+    const size_t blocks = (n + PARALLEL_GRAIN - 1) / PARALLEL_GRAIN;
+    std::vector<T> partial(blocks);
+    TThreadPool::instance().parallel_for(0, blocks, 1, [&](size_t bb, size_t be) {
+        for (size_t k = bb; k < be; k++) {
+            const size_t i = k * PARALLEL_GRAIN;
+            const size_t len = n - i < PARALLEL_GRAIN ? n - i : PARALLEL_GRAIN;
+            partial[k] = t.dot(len, a + i, b + i);
+        }
+    });
+    T res = T();
+    for (size_t k = 0; k < blocks; k++)
+        res += partial[k];
+    return res;
+}
+
+template<typename T>
+inline void gemv(size_t m, size_t n, T alpha, const T* a, size_t lda, const T* x, T beta, T* y)
+{
+    const TKernelTable<T>& t = kernel_table<T>();
+    if (m * n < PARALLEL_MIN_ELEMENTS) {
+        t.gemv(m, n, alpha, a, lda, x, beta, y);
+        return;
+    }
+    const size_t rows = PARALLEL_GRAIN / n;
+    TThreadPool::instance().parallel_for(0, m, rows < 4 ? 4 : rows, [&](size_t i, size_t e) {
+        t.gemv(e - i, n, alpha, a + i * lda, lda, x, beta, y + i);
+    });
+}
+
+} // namespace kernels
+
+#endif
@@ -0,0 +1,242 @@
+// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Тела SIMD-ядер. Подключается из tsimd.h внутри пространства имён
+// конкретного набора инструкций с определёнными TSIMD_ISA и TSIMD_TARGET,
+// поэтому защиты от повторного включения нет.
+
+template<typename T>
+TSIMD_TARGET inline T hsum(typename TSimdOps<TSIMD_ISA, T>::reg r)
+{
+    typedef TSimdOps<TSIMD_ISA, T> V;
+    T buf[V::W];
+    V::store(buf, r);
+    T res = T();
+    for (size_t w = 0; w < V::W; w++)
+        res += buf[w];
+    return res;
+}
+
+template<typename T>
+TSIMD_TARGET void add(size_t n, const T* a, const T* b, T* c)
+{
+    typedef TSimdOps<TSIMD_ISA, T> V;
+    size_t i = 0;
+    for (; i + V::W <= n; i += V::W)
+        V::store(c + i, V::add(V::load(a + i), V::load(b + i)));
+    for (; i < n; i++)
+        c[i] = a[i] + b[i];
+}
+
+template<typename T>
+TSIMD_TARGET void sub(size_t n, const T* a, const T* b, T* c)
+{
+    typedef TSimdOps<TSIMD_ISA, T> V;
+    size_t i = 0;
+    for (; i + V::W <= n; i += V::W)
+        V::store(c + i, V::sub(V::load(a + i), V::load(b + i)));
+    for (; i < n; i++)
+        c[i] = a[i] - b[i];
+}
+
+template<typename T>
+TSIMD_TARGET void shift(size_t n, const T* a, T val, T* c)
+{
+    typedef TSimdOps<TSIMD_ISA, T> V;
+    const typename V::reg v = V::set1(val);
+    size_t i = 0;
+    for (; i + V::W <= n; i += V::W)
+        V::store(c + i, V::add(V::load(a + i), v));
+    for (; i < n; i++)
+        c[i] = a[i] + val;
+}
+
+template<typename T>
+TSIMD_TARGET void scale(size_t n, const T* a, T val, T* c)
+{
+    typedef TSimdOps<TSIMD_ISA, T> V;
+    const typename V::reg v = V::set1(val);
+    size_t i = 0;
+    for (; i + V::W <= n; i += V::W)
+        V::store(c + i, V::mul(V::load(a + i), v));
+    for (; i < n; i++)
+        c[i] = a[i] * val;
+}
+
+template<typename T>
+TSIMD_TARGET void axpy(size_t n, T alpha, const T* x, T* y)
+{
+    typedef TSimdOps<TSIMD_ISA, T> V;
+    const typename V::reg va = V::set1(alpha);
+    size_t i = 0;
+    for (; i + V::W <= n; i += V::W)
+        V::store(y + i, V::fmadd(va, V::load(x + i), V::load(y + i)));
+    for (; i < n; i++)
+        y[i] += alpha * x[i];
+}
+
+template<typename T>
+TSIMD_TARGET T dot(size_t n, const T* a, const T* b)
+{
+    typedef TSimdOps<TSIMD_ISA, T> V;
+    typename V::reg s0 = V::zero(), s1 = V::zero(), s2 = V::zero(), s3 = V::zero();
+    size_t i = 0;
+    // четыре независимых аккумулятора скрывают задержку FMA
+    for (; i + 4 * V::W <= n; i += 4 * V::W) {
+        s0 = V::fmadd(V::load(a + i), V::load(b + i), s0);
+        s1 = V::fmadd(V::load(a + i + V::W), V::load(b + i + V::W), s1);
+        s2 = V::fmadd(V::load(a + i + 2 * V::W), V::load(b + i + 2 * V::W), s2);
+        s3 = V::fmadd(V::load(a + i + 3 * V::W), V::load(b + i + 3 * V::W), s3);
+    }
+    for (; i + V::W <= n; i += V::W)
+        s0 = V::fmadd(V::load(a + i), V::load(b + i), s0);
+    T res = hsum<T>(V::add(V::add(s0, s1), V::add(s2, s3)));
+    for (; i < n; i++)
+        res += a[i] * b[i];
+    return res;
+}
+
+template<typename T>
+TSIMD_TARGET T dot_axpy(size_t n, const T* a, const T* x, T alpha, T* y)
+{
+    typedef TSimdOps<TSIMD_ISA, T> V;
+    const typename V::reg va = V::set1(alpha);
+    typename V::reg s0 = V::zero(), s1 = V::zero();
+    size_t i = 0;
+    for (; i + 2 * V::W <= n; i += 2 * V::W) {
+        const typename V::reg a0 = V::load(a + i);
+        const typename V::reg a1 = V::load(a + i + V::W);
+        s0 = V::fmadd(a0, V::load(x + i), s0);
+        s1 = V::fmadd(a1, V::load(x + i + V::W), s1);
+        V::store(y + i, V::fmadd(va, a0, V::load(y + i)));
+        V::store(y + i + V::W, V::fmadd(va, a1, V::load(y + i + V::W)));
+    }
+    for (; i + V::W <= n; i += V::W) {
+        const typename V::reg a0 = V::load(a + i);
+        s0 = V::fmadd(a0, V::load(x + i), s0);
+        V::store(y + i, V::fmadd(va, a0, V::load(y + i)));
+    }
+    T res = hsum<T>(V::add(s0, s1));
+    for (; i < n; i++) {
+        res += a[i] * x[i];
+        y[i] += alpha * a[i];
+    }
+    return res;
+}
+
+template<typename T>
+TSIMD_TARGET void gemv(size_t m, size_t n, T alpha, const T* a, size_t lda, const T* x, T beta, T* y)
+{
+    typedef TSimdOps<TSIMD_ISA, T> V;
+    size_t i = 0;
+    // четыре строки за проход: каждая загрузка x используется четырежды
+    for (; i + 4 <= m; i += 4) {
+        const T* r0 = a + i * lda;
+        const T* r1 = r0 + lda;
+        const T* r2 = r1 + lda;
+        const T* r3 = r2 + lda;
+        typename V::reg s0 = V::zero(), s1 = V::zero(), s2 = V::zero(), s3 = V::zero();
+        size_t j = 0;
+        for (; j + V::W <= n; j += V::W) {
+            const typename V::reg xv = V::load(x + j);
+            s0 = V::fmadd(V::load(r0 + j), xv, s0);
+            s1 = V::fmadd(V::load(r1 + j), xv, s1);
+            s2 = V::fmadd(V::load(r2 + j), xv, s2);
+            s3 = V::fmadd(V::load(r3 + j), xv, s3);
+        }
+        T y0 = hsum<T>(s0), y1 = hsum<T>(s1), y2 = hsum<T>(s2), y3 = hsum<T>(s3);
+        for (; j < n; j++) {
+            y0 += r0[j] * x[j];
+            y1 += r1[j] * x[j];
+            y2 += r2[j] * x[j];
+            y3 += r3[j] * x[j];
+        }
+        y[i] = gemv_update(alpha, y0, beta, y[i]);
+        y[i + 1] = gemv_update(alpha, y1, beta, y[i + 1]);
+        y[i + 2] = gemv_update(alpha, y2, beta, y[i + 2]);
+        y[i + 3] = gemv_update(alpha, y3, beta, y[i + 3]);
+    }
+    for (; i < m; i++)
+        y[i] = gemv_update(alpha, dot(n, a + i * lda, x), beta, y[i]);
+}
+
+template<typename T>
+TSIMD_TARGET inline void gemm_update_row(T* c, typename TSimdOps<TSIMD_ISA, T>::reg c0,
+    typename TSimdOps<TSIMD_ISA, T>::reg c1)
+{
+    typedef TSimdOps<TSIMD_ISA, T> V;
+    V::store(c, V::add(V::load(c), c0));
+    V::store(c + V::W, V::add(V::load(c + V::W), c1));
+}
+
+// Микроядро 6 x 2W: 12 регистров-аккумуляторов
+template<typename T>
+TSIMD_TARGET void gemm_micro(size_t kc, const T* a, const T* b, T* c, size_t ldc, size_t mr, size_t nr)
+{
+    typedef TSimdOps<TSIMD_ISA, T> V;
+    typedef typename V::reg reg;
+    const size_t MR = 6;
+    const size_t NR = 2 * V::W;
+    reg c00 = V::zero(), c01 = V::zero(), c10 = V::zero(), c11 = V::zero();
+    reg c20 = V::zero(), c21 = V::zero(), c30 = V::zero(), c31 = V::zero();
+    reg c40 = V::zero(), c41 = V::zero(), c50 = V::zero(), c51 = V::zero();
+    for (size_t k = 0; k < kc; k++) {
+        const reg b0 = V::load(b);
+        const reg b1 = V::load(b + V::W);
+        reg ar;
+        ar = V::set1(a[0]); c00 = V::fmadd(ar, b0, c00); c01 = V::fmadd(ar, b1, c01);
+        ar = V::set1(a[1]); c10 = V::fmadd(ar, b0, c10); c11 = V::fmadd(ar, b1, c11);
+        ar = V::set1(a[2]); c20 = V::fmadd(ar, b0, c20); c21 = V::fmadd(ar, b1, c21);
+        ar = V::set1(a[3]); c30 = V::fmadd(ar, b0, c30); c31 = V::fmadd(ar, b1, c31);
+        ar = V::set1(a[4]); c40 = V::fmadd(ar, b0, c40); c41 = V::fmadd(ar, b1, c41);
+        ar = V::set1(a[5]); c50 = V::fmadd(ar, b0, c50); c51 = V::fmadd(ar, b1, c51);
+        a += MR;
+        b += NR;
+    }
+    if (mr == MR && nr == NR) {
+        gemm_update_row<T>(c, c00, c01);
+        gemm_update_row<T>(c + ldc, c10, c11);
+        gemm_update_row<T>(c + 2 * ldc, c20, c21);
+        gemm_update_row<T>(c + 3 * ldc, c30, c31);
+        gemm_update_row<T>(c + 4 * ldc, c40, c41);
+        gemm_update_row<T>(c + 5 * ldc, c50, c51);
+        return;
+    }
+    // краевая плитка: через буфер
+    T buf[MR * NR];
+    V::store(buf, c00); V::store(buf + V::W, c01);
+    V::store(buf + NR, c10); V::store(buf + NR + V::W, c11);
+    V::store(buf + 2 * NR, c20); V::store(buf + 2 * NR + V::W, c21);
+    V::store(buf + 3 * NR, c30); V::store(buf + 3 * NR + V::W, c31);
+    V::store(buf + 4 * NR, c40); V::store(buf + 4 * NR + V::W, c41);
+    V::store(buf + 5 * NR, c50); V::store(buf + 5 * NR + V::W, c51);
+    for (size_t r = 0; r < mr; r++)
+        for (size_t j = 0; j < nr; j++)
+            c[r * ldc + j] += buf[r * NR + j];
+}
+
+template<typename T>
+void fill_mul_table(TKernelTable<T>&, std::false_type)
+{
+}
+
+template<typename T>
+void fill_mul_table(TKernelTable<T>& t, std::true_type)
+{
+    t.scale = &scale<T>;
+    t.axpy = &axpy<T>;
+    t.dot = &dot<T>;
+    t.dot_axpy = &dot_axpy<T>;
+    t.gemv = &gemv<T>;
+    t.gemm_micro = &gemm_micro<T>;
+    t.MR = 6;
+    t.NR = 2 * TSimdOps<TSIMD_ISA, T>::W;
+}
+
+template<typename T>
+void fill_table(TKernelTable<T>& t)
+{
+    t.add = &add<T>;
+    t.sub = &sub<T>;
+    t.shift = &shift<T>;
+    fill_mul_table(t, std::integral_constant<bool, TSimdOps<TSIMD_ISA, T>::has_mul>());
+}
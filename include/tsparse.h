@@ -0,0 +1,283 @@
+// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Ядра для разреженных матриц
+//
+// Формат CSR: ненулевые элементы хранятся построчно, строка i занимает
+// позиции [ptr[i], ptr[i + 1]) массивов ind (номера столбцов, по
+// возрастанию) и val (значения).
+//
+// Произведение разреженных матриц (SpGEMM) считается в два прохода:
+// символьный находит число элементов каждой строки результата, после
+// чего память выделяется один раз, а численный заполняет строки. Строка
+// C собирается в аккумуляторе: плотном (массив на все столбцы) при
+// небольшом числе столбцов или в хеш-таблице размером по числу
+// умножений строки.
+
+#ifndef __TSparse_H__
+#define __TSparse_H__
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+#include "tmemory.h"
+#include "tsimd.h"
+
+namespace kernels
+{
+
+// Деление строк на parts частей с примерно равной работой. Стоимость
+// строки - число её ненулевых элементов плюс один (накладные расходы
+// строки), так что и пустые строки, и одна очень длинная строка не
+// нарушают баланс. bound - parts + 1 границ.
+inline void csr_partition(size_t rows, const size_t* ptr, size_t parts, size_t* bound)
+{
+    const size_t total = ptr[rows] - ptr[0] + rows;
+    bound[0] = 0;
+    for (size_t p = 1; p < parts; p++) {
+        const size_t target = total * p / parts;
+        // первая строка i, для которой работа строк [0, i) не меньше target
+        size_t lo = bound[p - 1], hi = rows;
+        while (lo < hi) {
+            const size_t mid = lo + (hi - lo) / 2;
+            if (ptr[mid] - ptr[0] + mid < target)
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+        bound[p] = lo;
+    }
+    bound[parts] = rows;
+}
+
+// Выполнение body(ib, ie) над строками, поделёнными по работе work
+// (префиксные суммы стоимостей строк, rows + 1 элементов)
+template<typename F>
+void csr_rows_parallel(size_t rows, const size_t* work, const F& body)
+{
+    TThreadPool& pool = TThreadPool::instance();
+    const size_t total = work[rows] - work[0] + rows;
+    if (total < PARALLEL_MIN_ELEMENTS || pool.num_threads() <= 1) {
+        body(0, rows);
+        return;
+    }
+    size_t parts = total / PARALLEL_GRAIN;
+    if (parts > pool.num_threads() * 4)
+        parts = pool.num_threads() * 4;
+    if (parts < 2)
+        parts = 2;
+    std::vector<size_t> bound(parts + 1);
+    csr_partition(rows, work, parts, bound.data());
+    pool.parallel_for(0, parts, 1, [&](size_t pb, size_t pe) {
+        for (size_t p = pb; p < pe; p++)
+            body(bound[p], bound[p + 1]);
+    });
+}
+
+// y = alpha A x + beta y; при beta == 0 исходное содержимое y не читается
+template<typename T, typename I>
+void csr_spmv(size_t rows, T alpha, const size_t* ptr, const I* ind, const T* val, const T* x, T beta, T* y)
+{
+    auto body = [&](size_t ib, size_t ie) {
+        for (size_t i = ib; i < ie; i++) {
+            T s = T();
+            for (size_t k = ptr[i]; k < ptr[i + 1]; k++)
+                s += val[k] * x[ind[k]];
+            y[i] = gemv_update(alpha, s, beta, y[i]);
+        }
+    };
+    // части по числу ненулевых элементов, а не строк
+    csr_rows_parallel(rows, ptr, body);
+}
+
+// Формат BSR: матрица делится на плотные блоки B x B, ненулевые блоки
+// хранятся как в CSR (ptr и ind - по блочным строкам и столбцам), каждый
+// блок - B * B значений построчно.
+
+// y = y + A x для одного блока; размер известен при компиляции, так что
+// циклы разворачиваются, а строки блока считаются независимо
+template<size_t B, typename T>
+inline void block_gemv(const T* a, const T* x, T* y)
+{
+    for (size_t r = 0; r < B; r++) {
+        T s = T();
+        for (size_t c = 0; c < B; c++)
+            s += a[r * B + c] * x[c];
+        y[r] += s;
+    }
+}
+
+// y = alpha A x + beta y для A в формате BSR из mb блочных строк
+template<size_t B, typename T, typename I>
+void bsr_spmv(size_t mb, T alpha, const size_t* ptr, const I* ind, const T* val, const T* x, T beta, T* y)
+{
+    auto body = [&](size_t ib, size_t ie) {
+        for (size_t i = ib; i < ie; i++) {
+            T s[B] = {};
+            for (size_t k = ptr[i]; k < ptr[i + 1]; k++)
+                block_gemv<B>(val + k * B * B, x + size_t(ind[k]) * B, s);
+            for (size_t r = 0; r < B; r++)
+                y[i * B + r] = gemv_update(alpha, s[r], beta, y[i * B + r]);
+        }
+    };
+    csr_rows_parallel(mb, ptr, body);
+}
+
+// Число ненулевых блоков B x B матрицы CSR (rows и cols кратны B)
+template<typename I>
+size_t csr_block_count(size_t rows, size_t cols, const size_t* ptr, const I* ind, size_t B)
+{
+    std::vector<size_t> mark(cols / B, size_t(-1));
+    size_t count = 0;
+    for (size_t i = 0; i < rows / B; i++)
+        for (size_t k = ptr[i * B]; k < ptr[(i + 1) * B]; k++)
+            if (mark[ind[k] / B] != i) {
+                mark[ind[k] / B] = i;
+                count++;
+            }
+    return count;
+}
+
+// Аккумулятор строки произведения. Слагаемые одного столбца
+// складываются в порядке поступления, поэтому результат не зависит от
+// вида аккумулятора и числа потоков.
+template<typename T, typename I>
+class TSpAccumulator
+{
+    bool dense;
+    // плотный: mark[j] - номер строки, в которой столбец j уже встречался
+    std::vector<size_t> mark;
+    std::vector<T> acc;
+    std::vector<I> cols;
+    // хеш-таблица с открытой адресацией
+    std::vector<I> keys;
+    std::vector<T> hval;
+    size_t mask;
+    size_t row;
+
+    static I empty() { return I(-1); }
+
+    size_t slot(I j) const
+    {
+        size_t h = (size_t(j) * 2654435761u) & mask;
+        while (keys[h] != empty() && keys[h] != j)
+            h = (h + 1) & mask;
+        return h;
+    }
+public:
+    // число столбцов, до которого используется плотный аккумулятор
+    static const size_t DENSE_COLUMNS = 1 << 18;
+
+    explicit TSpAccumulator(size_t n)
+        : dense(n <= DENSE_COLUMNS), mask(0), row(size_t(-1))
+    {
+        if (dense) {
+            mark.assign(n, size_t(-1));
+            acc.resize(n);
+        }
+    }
+
+    // начало строки i, в которой не больше flops слагаемых
+    void start(size_t i, size_t flops)
+    {
+        row = i;
+        cols.clear();
+        if (dense)
+            return;
+        size_t cap = 16;
+        while (cap < 2 * flops)
+            cap *= 2;
+        if (keys.size() < cap) {
+            keys.resize(cap);
+            hval.resize(cap);
+        }
+        mask = cap - 1;
+        std::fill(keys.begin(), keys.begin() + cap, empty());
+    }
+
+    void add(I j, const T& v)
+    {
+        if (dense) {
+            if (mark[j] != row) {
+                mark[j] = row;
+                acc[j] = v;
+                cols.push_back(j);
+            }
+            else
+                acc[j] += v;
+            return;
+        }
+        const size_t h = slot(j);
+        if (keys[h] == empty()) {
+            keys[h] = j;
+            hval[h] = v;
+            cols.push_back(j);
+        }
+        else
+            hval[h] += v;
+    }
+
+    size_t count() const noexcept { return cols.size(); }
+
+    // элементы строки по возрастанию столбцов
+    void extract(I* ind, T* val)
+    {
+        std::sort(cols.begin(), cols.end());
+        for (size_t k = 0; k < cols.size(); k++) {
+            ind[k] = cols[k];
+            val[k] = dense ? acc[cols[k]] : hval[slot(cols[k])];
+        }
+    }
+};
+
+// Символьный проход C = A B (A - m строк, B - n столбцов): flops -
+// префиксные суммы числа умножений по строкам (m + 1 элементов),
+// cptr[i + 1] получает число элементов строки i, cptr[0] = 0
+template<typename I>
+void csr_spgemm_symbolic(size_t m, size_t n, const size_t* aptr, const I* aind,
+    const size_t* bptr, const I* bind, size_t* flops, size_t* cptr)
+{
+    flops[0] = 0;
+    for (size_t i = 0; i < m; i++) {
+        size_t f = 0;
+        for (size_t k = aptr[i]; k < aptr[i + 1]; k++)
+            f += bptr[aind[k] + 1] - bptr[aind[k]];
+        flops[i + 1] = flops[i] + f;
+    }
+    csr_rows_parallel(m, flops, [&](size_t ib, size_t ie) {
+        TSpAccumulator<char, I> acc(n);
+        for (size_t i = ib; i < ie; i++) {
+            acc.start(i, flops[i + 1] - flops[i]);
+            for (size_t k = aptr[i]; k < aptr[i + 1]; k++)
+                for (size_t l = bptr[aind[k]]; l < bptr[aind[k] + 1]; l++)
+                    acc.add(bind[l], 0);
+            cptr[i + 1] = acc.count();
+        }
+    });
+    cptr[0] = 0;
+    for (size_t i = 0; i < m; i++)
+        cptr[i + 1] += cptr[i];
+}
+
+// Численный проход: строки C пишутся на места, найденные символьным
+template<typename T, typename I>
+void csr_spgemm_numeric(size_t m, size_t n, const size_t* aptr, const I* aind, const T* aval,
+    const size_t* bptr, const I* bind, const T* bval, const size_t* flops,
+    const size_t* cptr, I* cind, T* cval)
+{
+    csr_rows_parallel(m, flops, [&](size_t ib, size_t ie) {
+        TSpAccumulator<T, I> acc(n);
+        for (size_t i = ib; i < ie; i++) {
+            acc.start(i, flops[i + 1] - flops[i]);
+            for (size_t k = aptr[i]; k < aptr[i + 1]; k++) {
+                const T a = aval[k];
+                for (size_t l = bptr[aind[k]]; l < bptr[aind[k] + 1]; l++)
+                    acc.add(bind[l], a * bval[l]);
+            }
+            acc.extract(cind + cptr[i], cval + cptr[i]);
+        }
+    });
+}
+
+} // namespace kernels
+
+#endif
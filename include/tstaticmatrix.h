@@ -0,0 +1,348 @@
+// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Вектор и матрица фиксированного размера
+//
+// Размер задаётся параметром шаблона, элементы хранятся внутри объекта
+// (на стеке), без выделения памяти и проверок размеров во время
+// выполнения. Все операции constexpr, так что при константных операндах
+// вычисляются при компиляции; в произведениях шаблонами развёрнуты все
+// циклы - по строкам, по столбцам и по слагаемым суммы.
+// Доступ к элементам (size(), count(), [], at(), elem(), data(), fill(),
+// ввод/вывод) устроен как у TDynamicVector/TDynamicMatrix, поэтому
+// обобщённый код, обращающийся к элементам, работает с обоими. Операции
+// же возвращают готовые значения, а не выражения texpr.h: при размерах
+// 2..8, для которых предназначены эти классы, отложенное вычисление не
+// даёт выигрыша, и смешивать их с динамическими операндами нельзя.
+
+#ifndef __TStaticMatrix_H__
+#define __TStaticMatrix_H__
+
+#include <cstddef>
+#include <initializer_list>
+#include <iostream>
+#include <stdexcept>
+
+template<typename T, size_t N>
+class TStaticVector;
+
+namespace kernels
+{
+
+// Развёрнутые суммы произведений: слагаемые K .. N - 1
+template<size_t K, size_t N>
+struct TStaticUnroll
+{
+    // sum a[k] b[k]
+    template<typename T>
+    static constexpr T dot(const TStaticVector<T, N>& a, const TStaticVector<T, N>& b)
+    {
+        return a[K] * b[K] + TStaticUnroll<K + 1, N>::dot(a, b);
+    }
+    // sum a[k] b[k][j] - элемент j произведения строки a на матрицу b
+    template<typename T>
+    static constexpr T column(const TStaticVector<T, N>& a, const TStaticVector<T, N>* b, size_t j)
+    {
+        return a[K] * b[K][j] + TStaticUnroll<K + 1, N>::column(a, b, j);
+    }
+};
+
+template<size_t N>
+struct TStaticUnroll<N, N>
+{
+    template<typename T>
+    static constexpr T dot(const TStaticVector<T, N>&, const TStaticVector<T, N>&) { return T(); }
+    template<typename T>
+    static constexpr T column(const TStaticVector<T, N>&, const TStaticVector<T, N>*, size_t) { return T(); }
+};
+
+// Развёрнутый цикл по столбцам J .. N - 1 строки произведения
+template<size_t J, size_t N>
+struct TStaticCols
+{
+    // res[j] = sum a[k] b[k][j]
+    template<typename T>
+    static constexpr void row(TStaticVector<T, N>& res, const TStaticVector<T, N>& a, const TStaticVector<T, N>* b)
+    {
+        res[J] = TStaticUnroll<0, N>::column(a, b, J);
+        TStaticCols<J + 1, N>::row(res, a, b);
+    }
+};
+
+template<size_t N>
+struct TStaticCols<N, N>
+{
+    template<typename T>
+    static constexpr void row(TStaticVector<T, N>&, const TStaticVector<T, N>&, const TStaticVector<T, N>*) {}
+};
+
+// Развёрнутый цикл по строкам I .. N - 1 произведений
+template<size_t I, size_t N>
+struct TStaticRows
+{
+    // res[i] = a[i] * v
+    template<typename T>
+    static constexpr void matvec(TStaticVector<T, N>& res, const TStaticVector<T, N>* a, const TStaticVector<T, N>& v)
+    {
+        res[I] = TStaticUnroll<0, N>::dot(a[I], v);
+        TStaticRows<I + 1, N>::matvec(res, a, v);
+    }
+    // res[i] = a[i] * b
+    template<typename T>
+    static constexpr void matmul(TStaticVector<T, N>* res, const TStaticVector<T, N>* a, const TStaticVector<T, N>* b)
+    {
+        TStaticCols<0, N>::row(res[I], a[I], b);
+        TStaticRows<I + 1, N>::matmul(res, a, b);
+    }
+};
+
+template<size_t N>
+struct TStaticRows<N, N>
+{
+    template<typename T>
+    static constexpr void matvec(TStaticVector<T, N>&, const TStaticVector<T, N>*, const TStaticVector<T, N>&) {}
+    template<typename T>
+    static constexpr void matmul(TStaticVector<T, N>*, const TStaticVector<T, N>*, const TStaticVector<T, N>*) {}
+};
+
+} // namespace kernels
+
+template<typename T, size_t N>
+class TStaticVector
+{
+    static_assert(N > 0, "Vector size should be greater than zero");
+    T pMem[N];
+public:
+    typedef T value_type;
+
+    constexpr TStaticVector() : pMem{} {}
+    constexpr TStaticVector(std::initializer_list<T> l) : pMem{}
+    {
+        if (l.size() > N) throw std::length_error("too many elements");
+        size_t i = 0;
+        for (const T* p = l.begin(); p != l.end(); ++p)
+            pMem[i++] = *p;
+    }
+
+    constexpr size_t size() const noexcept { return N; }
+    constexpr size_t count() const noexcept { return N; }
+    constexpr const T& elem(size_t i) const { return pMem[i]; }
+
+    T* data() noexcept { return pMem; }
+    const T* data() const noexcept { return pMem; }
+
+    constexpr void fill(const T& val)
+    {
+        for (size_t i = 0; i < N; i++)
+            pMem[i] = val;
+    }
+
+    // индексация
+    constexpr T& operator[](size_t ind) { return pMem[ind]; }
+    constexpr const T& operator[](size_t ind) const { return pMem[ind]; }
+    // индексация с контролем
+    constexpr T& at(size_t ind)
+    {
+        if (ind >= N) throw std::out_of_range("out of range");
+        return pMem[ind];
+    }
+    constexpr const T& at(size_t ind) const
+    {
+        if (ind >= N) throw std::out_of_range("out of range");
+        return pMem[ind];
+    }
+
+    // сравнение
+    constexpr bool operator==(const TStaticVector& v) const
+    {
+        for (size_t i = 0; i < N; i++)
+            if (!(pMem[i] == v.pMem[i]))
+                return false;
+        return true;
+    }
+    constexpr bool operator!=(const TStaticVector& v) const { return !(*this == v); }
+
+    // операции с присваиванием
+    constexpr TStaticVector& operator+=(const TStaticVector& v)
+    {
+        for (size_t i = 0; i < N; i++)
+            pMem[i] += v.pMem[i];
+        return *this;
+    }
+    constexpr TStaticVector& operator-=(const TStaticVector& v)
+    {
+        for (size_t i = 0; i < N; i++)
+            pMem[i] -= v.pMem[i];
+        return *this;
+    }
+    constexpr TStaticVector& operator+=(const T& val)
+    {
+        for (size_t i = 0; i < N; i++)
+            pMem[i] += val;
+        return *this;
+    }
+    constexpr TStaticVector& operator-=(const T& val)
+    {
+        for (size_t i = 0; i < N; i++)
+            pMem[i] -= val;
+        return *this;
+    }
+    constexpr TStaticVector& operator*=(const T& val)
+    {
+        for (size_t i = 0; i < N; i++)
+            pMem[i] *= val;
+        return *this;
+    }
+
+    // скалярные операции
+    constexpr TStaticVector operator+(const T& val) const { TStaticVector res(*this); res += val; return res; }
+    constexpr TStaticVector operator-(const T& val) const { TStaticVector res(*this); res -= val; return res; }
+    constexpr TStaticVector operator*(const T& val) const { TStaticVector res(*this); res *= val; return res; }
+
+    // векторные операции
+    constexpr TStaticVector operator+(const TStaticVector& v) const { TStaticVector res(*this); res += v; return res; }
+    constexpr TStaticVector operator-(const TStaticVector& v) const { TStaticVector res(*this); res -= v; return res; }
+    // скалярное произведение
+    constexpr T operator*(const TStaticVector& v) const
+    {
+        return kernels::TStaticUnroll<0, N>::dot(*this, v);
+    }
+
+    // ввод/вывод
+    friend std::istream& operator>>(std::istream& istr, TStaticVector& v)
+    {
+        for (size_t i = 0; i < N; i++)
+            istr >> v.pMem[i];
+        return istr;
+    }
+    friend std::ostream& operator<<(std::ostream& ostr, const TStaticVector& v)
+    {
+        for (size_t i = 0; i < N; i++)
+            ostr << v.pMem[i] << ' ';
+        return ostr;
+    }
+};
+
+// Квадратная матрица порядка N: N строк-векторов подряд, то есть
+// N * N элементов построчно, как в TDynamicMatrix
+template<typename T, size_t N>
+class TStaticMatrix
+{
+    static_assert(sizeof(TStaticVector<T, N>) == N * sizeof(T), "rows must be stored without padding");
+    TStaticVector<T, N> pMem[N];
+public:
+    typedef T value_type;
+
+    constexpr TStaticMatrix() : pMem{} {}
+    constexpr TStaticMatrix(std::initializer_list<std::initializer_list<T>> l) : pMem{}
+    {
+        if (l.size() > N) throw std::length_error("too many rows");
+        size_t i = 0;
+        for (const std::initializer_list<T>* p = l.begin(); p != l.end(); ++p)
+            pMem[i++] = TStaticVector<T, N>(*p);
+    }
+
+    static constexpr TStaticMatrix identity()
+    {
+        TStaticMatrix res;
+        for (size_t i = 0; i < N; i++)
+            res.pMem[i][i] = T(1);
+        return res;
+    }
+
+    constexpr size_t size() const noexcept { return N; }
+    constexpr size_t count() const noexcept { return N * N; }
+    // элемент i построчного хранения
+    constexpr const T& elem(size_t i) const { return pMem[i / N][i % N]; }
+
+    // непосредственный доступ к элементам (построчно)
+    T* data() noexcept { return reinterpret_cast<T*>(pMem); }
+    const T* data() const noexcept { return reinterpret_cast<const T*>(pMem); }
+
+    constexpr void fill(const T& val)
+    {
+        for (size_t i = 0; i < N; i++)
+            pMem[i].fill(val);
+    }
+
+    // индексация
+    constexpr TStaticVector<T, N>& operator[](size_t ind) { return pMem[ind]; }
+    constexpr const TStaticVector<T, N>& operator[](size_t ind) const { return pMem[ind]; }
+    // индексация с контролем
+    constexpr TStaticVector<T, N>& at(size_t ind)
+    {
+        if (ind >= N) throw std::out_of_range("out of range");
+        return pMem[ind];
+    }
+    constexpr const TStaticVector<T, N>& at(size_t ind) const
+    {
+        if (ind >= N) throw std::out_of_range("out of range");
+        return pMem[ind];
+    }
+
+    // сравнение
+    constexpr bool operator==(const TStaticMatrix& m) const
+    {
+        for (size_t i = 0; i < N; i++)
+            if (pMem[i] != m.pMem[i])
+                return false;
+        return true;
+    }
+    constexpr bool operator!=(const TStaticMatrix& m) const { return !(*this == m); }
+
+    // операции с присваиванием
+    constexpr TStaticMatrix& operator+=(const TStaticMatrix& m)
+    {
+        for (size_t i = 0; i < N; i++)
+            pMem[i] += m.pMem[i];
+        return *this;
+    }
+    constexpr TStaticMatrix& operator-=(const TStaticMatrix& m)
+    {
+        for (size_t i = 0; i < N; i++)
+            pMem[i] -= m.pMem[i];
+        return *this;
+    }
+    constexpr TStaticMatrix& operator*=(const T& val)
+    {
+        for (size_t i = 0; i < N; i++)
+            pMem[i] *= val;
+        return *this;
+    }
+
+    // матрично-скалярные операции
+    constexpr TStaticMatrix operator*(const T& val) const { TStaticMatrix res(*this); res *= val; return res; }
+
+    // матрично-векторные операции
+    constexpr TStaticVector<T, N> operator*(const TStaticVector<T, N>& v) const
+    {
+        TStaticVector<T, N> res;
+        kernels::TStaticRows<0, N>::matvec(res, pMem, v);
+        return res;
+    }
+
+    // матрично-матричные операции
+    constexpr TStaticMatrix operator+(const TStaticMatrix& m) const { TStaticMatrix res(*this); res += m; return res; }
+    constexpr TStaticMatrix operator-(const TStaticMatrix& m) const { TStaticMatrix res(*this); res -= m; return res; }
+    constexpr TStaticMatrix operator*(const TStaticMatrix& m) const
+    {
+        TStaticMatrix res;
+        kernels::TStaticRows<0, N>::matmul(res.pMem, pMem, m.pMem);
+        return res;
+    }
+
+    // ввод/вывод
+    friend std::istream& operator>>(std::istream& istr, TStaticMatrix& v)
+    {
+        for (size_t i = 0; i < N; i++)
+            istr >> v.pMem[i];
+        return istr;
+    }
+    friend std::ostream& operator<<(std::ostream& ostr, const TStaticMatrix& v)
+    {
+        for (size_t i = 0; i < N; i++)
+            ostr << v.pMem[i] << std::endl;
+        return ostr;
+    }
+};
+
+#endif
@@ -0,0 +1,259 @@
+// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Симметричная матрица в упакованном формате
+//
+// Хранится только верхний треугольник - n (n + 1) / 2 элементов, в том же
+// формате, что и у верхнетреугольной матрицы (см. tpacked.h); элементы
+// (i, j) и (j, i) - одна и та же ячейка. Матрицы Грама A A^T строит SYRK,
+// который считает только половину произведения; A - квадратная или
+// прямоугольная n x k (TRectMatrix).
+
+#ifndef __TSymmetricMatrix_H__
+#define __TSymmetricMatrix_H__
+
+#include "tmatrix.h"
+#include "trectmatrix.h"
+#include "tpacked.h"
+
+struct TSymmetricTag
+{
+    static const char* mismatch() { return "different lengths"; }
+};
+
+// Строка i симметричной матрицы: доступны все столбцы
+template<typename T>
+class TSymmetricRow
+{
+    T* pMem;     // начало упакованного буфера
+    size_t row;
+    size_t sz;
+public:
+    TSymmetricRow(T* p, size_t i, size_t n) noexcept : pMem(p), row(i), sz(n) {}
+
+    size_t size() const noexcept { return sz; }
+
+    // индексация
+    T& operator[](size_t j) const
+    {
+        return j >= row ? pMem[kernels::upper_offset(sz, row) + j - row]
+                        : pMem[kernels::upper_offset(sz, j) + row - j];
+    }
+    // индексация с контролем
+    T& at(size_t j) const
+    {
+        if (j >= sz) throw out_of_range("out of range");
+        return (*this)[j];
+    }
+};
+
+template<typename T, typename Alloc = TAlignedAllocator<T>>
+class TSymmetricMatrix : public TExpr<TSymmetricMatrix<T, Alloc>, TSymmetricTag>
+{
+    size_t sz;
+    TDynamicVector<T, Alloc> mem;
+
+    static size_t packed(size_t s)
+    {
+        if (s == 0 || s > MAX_MATRIX_SIZE)
+            throw length_error("Matrix size should be greater than zero and less than MAX_MATRIX_SIZE");
+        return kernels::upper_count(s);
+    }
+public:
+    typedef T value_type;
+    typedef Alloc allocator_type;
+
+    TSymmetricMatrix(size_t s = 1, const Alloc& a = Alloc()) : sz(s), mem(packed(s), a) {}
+    TSymmetricMatrix(size_t s, TUninitialized, const Alloc& a = Alloc())
+        : sz(s), mem(packed(s), uninitialized, a) {}
+    // берётся верхний треугольник плотной матрицы
+    template<typename A>
+    explicit TSymmetricMatrix(const TDynamicMatrix<T, A>& m, const Alloc& a = Alloc())
+        : TSymmetricMatrix(m.size(), uninitialized, a)
+    {
+        for (size_t i = 0; i < sz; i++)
+            mem_copy(m.data() + i * sz + i, sz - i, mem.data() + kernels::upper_offset(sz, i));
+    }
+    // вычисление выражения за один проход
+    template<typename E>
+    TSymmetricMatrix(const TExpr<E, TSymmetricTag>& e, const Alloc& a = Alloc())
+        : TSymmetricMatrix(e.self().size(), uninitialized, a)
+    {
+        static_assert(std::is_same<typename E::value_type, T>::value, "element types differ");
+        expr_assign(mem.data(), e.self());
+    }
+    TSymmetricMatrix(const TSymmetricMatrix& m) = default;
+    TSymmetricMatrix(TSymmetricMatrix&& m) noexcept : sz(m.sz), mem(std::move(m.mem))
+    {
+        m.sz = 0;
+    }
+    TSymmetricMatrix& operator=(const TSymmetricMatrix& m) = default;
+    TSymmetricMatrix& operator=(TSymmetricMatrix&& m) noexcept
+    {
+        sz = m.sz;
+        mem = std::move(m.mem);
+        m.sz = 0;
+        return *this;
+    }
+    template<typename E>
+    TSymmetricMatrix& operator=(const TExpr<E, TSymmetricTag>& e)
+    {
+        if (sz != e.self().size()) {
+            TSymmetricMatrix tmp(e);
+            swap(*this, tmp);
+        }
+        else
+            expr_assign(mem.data(), e.self());
+        return *this;
+    }
+
+    size_t size() const noexcept { return sz; }
+    size_t count() const noexcept { return kernels::upper_count(sz); }
+    const T& elem(size_t i) const { return mem.data()[i]; }
+
+    // непосредственный доступ к упакованному буферу
+    T* data() noexcept { return mem.data(); }
+    const T* data() const noexcept { return mem.data(); }
+
+    void fill(const T& val) { mem.fill(val); }
+
+    // индексация
+    TSymmetricRow<T> operator[](size_t ind)
+    {
+        return TSymmetricRow<T>(mem.data(), ind, sz);
+    }
+    TSymmetricRow<const T> operator[](size_t ind) const
+    {
+        return TSymmetricRow<const T>(mem.data(), ind, sz);
+    }
+    // индексация с контролем
+    TSymmetricRow<T> at(size_t ind)
+    {
+        if (ind >= sz) throw out_of_range("out of range");
+        return (*this)[ind];
+    }
+    TSymmetricRow<const T> at(size_t ind) const
+    {
+        if (ind >= sz) throw out_of_range("out of range");
+        return (*this)[ind];
+    }
+
+    TDynamicMatrix<T, Alloc> dense() const
+    {
+        TDynamicMatrix<T, Alloc> res(sz, uninitialized, mem.get_allocator());
+        for (size_t i = 0; i < sz; i++) {
+            const T* row = mem.data() + kernels::upper_offset(sz, i);
+            for (size_t j = i; j < sz; j++)
+                res.data()[i * sz + j] = res.data()[j * sz + i] = row[j - i];
+        }
+        return res;
+    }
+
+    // поэлементные операции - см. texpr.h, произведения - после
+    // определения класса
+
+    // операции с присваиванием, без выделения памяти
+    template<typename E>
+    TSymmetricMatrix& operator+=(const TExpr<E, TSymmetricTag>& e)
+    {
+        expr_assign(mem.data(), *this + e.self());
+        return *this;
+    }
+    template<typename E>
+    TSymmetricMatrix& operator-=(const TExpr<E, TSymmetricTag>& e)
+    {
+        expr_assign(mem.data(), *this - e.self());
+        return *this;
+    }
+    TSymmetricMatrix& operator*=(const T& val)
+    {
+        expr_assign(mem.data(), *this * val);
+        return *this;
+    }
+
+    allocator_type get_allocator() const { return mem.get_allocator(); }
+
+    friend void swap(TSymmetricMatrix& lhs, TSymmetricMatrix& rhs) noexcept
+    {
+        std::swap(lhs.sz, rhs.sz);
+        swap(lhs.mem, rhs.mem);
+    }
+
+    // ввод/вывод: вводится верхний треугольник, выводится вся матрица
+    friend istream& operator>>(istream& istr, TSymmetricMatrix& v)
+    {
+        for (size_t i = 0; i < v.count(); i++)
+            istr >> v.mem[i];
+        return istr;
+    }
+    friend ostream& operator<<(ostream& ostr, const TSymmetricMatrix& v)
+    {
+        for (size_t i = 0; i < v.sz; i++) {
+            for (size_t j = 0; j < v.sz; j++)
+                ostr << v[i][j] << ' ';
+            ostr << endl;
+        }
+        return ostr;
+    }
+};
+
+template<typename T, typename A>
+struct TExprDense<TSymmetricMatrix<T, A>> : std::true_type {};
+template<typename T, typename A>
+struct TExprOwner<TSymmetricMatrix<T, A>> : std::true_type {};
+
+template<typename T, typename A>
+const TSymmetricMatrix<T, A>& materialize(const TSymmetricMatrix<T, A>& m) { return m; }
+template<typename E>
+TSymmetricMatrix<typename E::value_type> materialize(const TExpr<E, TSymmetricTag>& e)
+{
+    return TSymmetricMatrix<typename E::value_type>(e);
+}
+
+// умножение на вектор
+template<typename L, typename R>
+TDynamicVector<typename L::value_type> operator*(const TExpr<L, TSymmetricTag>& l, const TExpr<R, TVectorTag>& r)
+{
+    typedef typename L::value_type T;
+    const auto& a = materialize(l.self());
+    const auto& x = materialize(r.self());
+    const size_t sz = a.size();
+    if (sz != x.size()) throw logic_error("different lengths");
+    TDynamicVector<T> res(sz, uninitialized);
+    kernels::spmv_upper(sz, a.data(), x.data(), res.data());
+    return res;
+}
+
+// C = alpha A A^T + beta C
+template<typename T, typename AA, typename AC>
+void syrk(T alpha, const TDynamicMatrix<T, AA>& a, T beta, TSymmetricMatrix<T, AC>& c)
+{
+    const size_t sz = a.size();
+    if (sz != c.size()) throw logic_error("different lengths");
+    kernels::syrk_upper(sz, sz, alpha, a.data(), sz, beta, c.data());
+}
+
+// матрица Грама A A^T
+template<typename T, typename A>
+TSymmetricMatrix<T, A> syrk(const TDynamicMatrix<T, A>& a)
+{
+    TSymmetricMatrix<T, A> res(a.size(), uninitialized, a.get_allocator());
+    kernels::syrk_upper(a.size(), a.size(), T(1), a.data(), a.size(), T(), res.data());
+    return res;
+}
+
+// то же для n x k матрицы A: результат n x n
+template<typename T, typename AA, typename AC>
+void syrk(T alpha, const TRectMatrix<T, AA>& a, T beta, TSymmetricMatrix<T, AC>& c)
+{
+    if (a.rows() != c.size()) throw logic_error("different lengths");
+    kernels::syrk_upper(a.rows(), a.cols(), alpha, a.data(), a.stride(), beta, c.data());
+}
+template<typename T, typename A>
+TSymmetricMatrix<T, A> syrk(const TRectMatrix<T, A>& a)
+{
+    TSymmetricMatrix<T, A> res(a.rows(), uninitialized, a.get_allocator());
+    kernels::syrk_upper(a.rows(), a.cols(), T(1), a.data(), a.stride(), T(), res.data());
+    return res;
+}
+
+#endif
@@ -0,0 +1,224 @@
+// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Пул потоков с перехватом задач (work stealing)
+//
+// У каждого рабочего потока своя очередь: свои задачи он берёт с конца,
+// чужие крадёт с начала. Потоки запускаются при первой параллельной
+// операции; их число (вместе с вызывающим потоком) задаётся переменной
+// окружения TMATRIX_NUM_THREADS или методом set_num_threads().
+
+#ifndef __TThreadPool_H__
+#define __TThreadPool_H__
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdlib>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Операции меньше этих размеров выполняются в вызывающем потоке
+const size_t PARALLEL_MIN_ELEMENTS = 1 << 16;
+const size_t PARALLEL_MIN_FLOPS = 1 << 22;
+
+class TThreadPool
+{
+    typedef std::function<void()> TTask;
+
+    struct TQueue
+    {
+        std::mutex m;
+        std::deque<TTask> tasks;
+    };
+
+    size_t nthreads;
+    std::vector<std::thread> workers;
+    // очереди рабочих потоков; последняя - для внешних потоков
+    std::vector<std::unique_ptr<TQueue>> queues;
+    std::atomic<size_t> pending;
+    std::mutex wakeMutex;
+    std::condition_variable wake;
+    std::mutex controlMutex;
+    bool stopping;
+
+    // номер очереди текущего потока, -1 для потоков вне пула
+    static int& worker_index()
+    {
+        thread_local int index = -1;
+        return index;
+    }
+
+    static size_t default_num_threads()
+    {
+        const char* env = std::getenv("TMATRIX_NUM_THREADS");
+        if (env != nullptr && std::atoi(env) > 0)
+            return size_t(std::atoi(env));
+        const size_t hw = std::thread::hardware_concurrency();
+        return hw == 0 ? 1 : hw;
+    }
+
+    TThreadPool() : nthreads(default_num_threads()), pending(0), stopping(false) {}
+
+    void start()
+    {
+        std::lock_guard<std::mutex> lk(controlMutex);
+        if (!workers.empty() || nthreads <= 1)
+            return;
+        stopping = false;
+        queues.clear();
+        for (size_t i = 0; i < nthreads; i++)
+            queues.emplace_back(new TQueue);
+        for (size_t i = 0; i + 1 < nthreads; i++)
+            workers.emplace_back([this, i]() { run(int(i)); });
+    }
+
+    void stop()
+    {
+        std::lock_guard<std::mutex> lk(controlMutex);
+        {
+            std::lock_guard<std::mutex> wl(wakeMutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (size_t i = 0; i < workers.size(); i++)
+            workers[i].join();
+        workers.clear();
+    }
+
+    void push(TTask task)
+    {
+        const int idx = worker_index();
+        TQueue& q = *queues[idx >= 0 ? size_t(idx) : queues.size() - 1];
+        {
+            std::lock_guard<std::mutex> lk(q.m);
+            q.tasks.push_back(std::move(task));
+        }
+        pending++;
+        { std::lock_guard<std::mutex> lk(wakeMutex); }
+        wake.notify_one();
+    }
+
+    bool try_pop(TTask& task)
+    {
+        const int idx = worker_index();
+        const size_t nq = queues.size();
+        if (idx >= 0) {
+            TQueue& own = *queues[idx];
+            std::lock_guard<std::mutex> lk(own.m);
+            if (!own.tasks.empty()) {
+                task = std::move(own.tasks.back());
+                own.tasks.pop_back();
+                pending--;
+                return true;
+            }
+        }
+        const size_t first = idx >= 0 ? size_t(idx) + 1 : 0;
+        for (size_t k = 0; k < nq; k++) {
+            TQueue& victim = *queues[(first + k) % nq];
+            std::lock_guard<std::mutex> lk(victim.m);
+            if (!victim.tasks.empty()) {
+                task = std::move(victim.tasks.front());
+                victim.tasks.pop_front();
+                pending--;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void run(int index)
+    {
+        worker_index() = index;
+        TTask task;
+        for (;;) {
+            if (try_pop(task)) {
+                task();
+                task = nullptr;
+                continue;
+            }
+            std::unique_lock<std::mutex> lk(wakeMutex);
+            wake.wait(lk, [this]() { return stopping || pending > 0; });
+            if (stopping && pending == 0)
+                return;
+        }
+    }
+
+public:
+    TThreadPool(const TThreadPool&) = delete;
+    TThreadPool& operator=(const TThreadPool&) = delete;
+    ~TThreadPool() { stop(); }
+
+    static TThreadPool& instance()
+    {
+        static TThreadPool pool;
+        return pool;
+    }
+
+    // число потоков, включая вызывающий
+    size_t num_threads() const noexcept { return nthreads; }
+
+    // Нельзя вызывать во время параллельной операции
+    void set_num_threads(size_t n)
+    {
+        stop();
+        nthreads = n == 0 ? default_num_threads() : n;
+    }
+
+    // f(b, e) вызывается для непересекающихся отрезков [b, e), покрывающих
+    // [begin, end); границы отрезков кратны grain относительно begin.
+    // Вызывающий поток тоже выполняет задачи, поэтому вложенные вызовы
+    // не приводят к взаимной блокировке.
+    template<typename F>
+    void parallel_for(size_t begin, size_t end, size_t grain, const F& f)
+    {
+        if (grain == 0)
+            grain = 1;
+        const size_t blocks = (end - begin + grain - 1) / grain;
+        if (nthreads <= 1 || blocks <= 1) {
+            if (begin < end)
+                f(begin, end);
+            return;
+        }
+        start();
+
+        const size_t chunks = blocks < nthreads * 4 ? blocks : nthreads * 4;
+        std::atomic<size_t> left(chunks - 1);
+        std::exception_ptr error;
+        std::mutex errorMutex;
+        auto chunk = [&](size_t c) {
+            const size_t b = begin + (blocks * c / chunks) * grain;
+            size_t e = begin + (blocks * (c + 1) / chunks) * grain;
+            if (e > end)
+                e = end;
+            try {
+                f(b, e);
+            }
+            catch (...) {
+                std::lock_guard<std::mutex> lk(errorMutex);
+                if (!error)
+                    error = std::current_exception();
+            }
+        };
+        for (size_t c = 1; c < chunks; c++)
+            push([&, c]() { chunk(c); left--; });
+        chunk(0);
+
+        TTask task;
+        while (left > 0) {
+            if (try_pop(task)) {
+                task();
+                task = nullptr;
+            }
+            else
+                std::this_thread::yield();
+        }
+        if (error)
+            std::rethrow_exception(error);
+    }
+};
+
+#endif
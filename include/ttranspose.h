@@ -0,0 +1,388 @@
+// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Транспонированная матрица без копирования
+//
+// transpose(a) возвращает представление A^T над памятью a: элемент (i, j)
+// читается из a[j][i]. Произведения с таким операндом отдаются блочному
+// GEMM с переставленными шагами строк и столбцов, и транспонированная
+// панель собирается прямо при упаковке блока, так что A^T B и A B^T
+// стоят столько же, сколько A B, а A^T целиком никогда не строится.
+//
+// Когда транспонированная матрица всё же нужна, её строит рекурсивное
+// (cache-oblivious) транспонирование: блок делится пополам по большему
+// измерению, пока не поместится в кэш, так что и чтение, и запись
+// идут целыми строками кэша на любом уровне иерархии памяти.
+// TRectMatrix<T> b = transpose(a) - копия, transpose_in_place(a) - на
+// месте для квадратной матрицы. Присваивание a = transpose(a) (и любое
+// выражение, читающее транспонированной память результата) проверяется
+// и вычисляется через временную копию.
+
+#ifndef __TTranspose_H__
+#define __TTranspose_H__
+
+#include <utility>
+#include "tview.h"
+
+namespace kernels
+{
+
+// Лист рекурсии: блоки TRANSPOSE_TILE x TRANSPOSE_TILE источника и
+// приёмника вместе помещаются в L2
+const size_t TRANSPOSE_TILE = 64;
+// на месте оба блока и читаются, и пишутся, поэтому лист меньше
+const size_t TRANSPOSE_SWAP_TILE = 16;
+
+// b (n x m, строки через ldb) = a^T, a - m x n, строки через lda
+template<typename T>
+void transpose_block(size_t m, size_t n, const T* a, size_t lda, T* b, size_t ldb)
+{
+    while (m > TRANSPOSE_TILE || n > TRANSPOSE_TILE) {
+        if (m >= n) {
+            const size_t h = m / 2;
+            transpose_block(h, n, a, lda, b, ldb);
+            a += h * lda;
+            b += h;
+            m -= h;
+        }
+        else {
+            const size_t h = n / 2;
+            transpose_block(m, h, a, lda, b, ldb);
+            a += h;
+            b += h * ldb;
+            n -= h;
+        }
+    }
+    // строки приёмника пишутся подряд, источник читается столбцами
+    // внутри блока, который к этому моменту уже в кэше
+    for (size_t j = 0; j < n; j++)
+        for (size_t i = 0; i < m; i++)
+            b[j * ldb + i] = a[i * lda + j];
+}
+
+// a (m x n) <-> b^T (b - n x m), оба блока в одной матрице со строками через ld
+template<typename T>
+void transpose_swap(size_t m, size_t n, T* a, T* b, size_t ld)
+{
+    while (m > TRANSPOSE_SWAP_TILE || n > TRANSPOSE_SWAP_TILE) {
+        if (m >= n) {
+            const size_t h = m / 2;
+            transpose_swap(h, n, a, b, ld);
+            a += h * ld;
+            b += h;
+            m -= h;
+        }
+        else {
+            const size_t h = n / 2;
+            transpose_swap(m, h, a, b, ld);
+            a += h;
+            b += h * ld;
+            n -= h;
+        }
+    }
+    for (size_t i = 0; i < m; i++)
+        for (size_t j = 0; j < n; j++)
+            std::swap(a[i * ld + j], b[j * ld + i]);
+}
+
+// Квадратный блок n x n на месте: диагональные блоки рекурсивно,
+// внедиагональные меняются местами
+template<typename T>
+void transpose_square_block(size_t n, T* a, size_t ld)
+{
+    if (n <= TRANSPOSE_SWAP_TILE) {
+        for (size_t i = 0; i < n; i++)
+            for (size_t j = i + 1; j < n; j++)
+                std::swap(a[i * ld + j], a[j * ld + i]);
+        return;
+    }
+    const size_t h = n / 2;
+    transpose_square_block(h, a, ld);
+    transpose_square_block(n - h, a + h * ld + h, ld);
+    transpose_swap(h, n - h, a + h, a + h * ld, ld);
+}
+
+// b = a^T; большие матрицы делятся на полосы строк b между потоками
+template<typename T>
+void transpose(size_t m, size_t n, const T* a, size_t lda, T* b, size_t ldb)
+{
+    if (m * n < PARALLEL_MIN_ELEMENTS) {
+        transpose_block(m, n, a, lda, b, ldb);
+        return;
+    }
+    TThreadPool::instance().parallel_for(0, n, TRANSPOSE_TILE, [&](size_t jb, size_t je) {
+        transpose_block(m, je - jb, a + jb, lda, b + jb * ldb, ldb);
+    });
+}
+
+// Квадратная a на месте. Параллельно матрица режется на полосы по
+// STRIPE строк: задача - диагональный блок или пара симметричных блоков.
+template<typename T>
+void transpose_in_place(size_t n, T* a, size_t ld)
+{
+    const size_t STRIPE = 8 * TRANSPOSE_TILE;
+    if (n * n < PARALLEL_MIN_ELEMENTS || TThreadPool::instance().num_threads() <= 1) {
+        transpose_square_block(n, a, ld);
+        return;
+    }
+    const size_t nb = (n + STRIPE - 1) / STRIPE;
+    std::vector<std::pair<size_t, size_t>> tasks;
+    for (size_t i = 0; i < nb; i++)
+        for (size_t j = i; j < nb; j++)
+            tasks.push_back(std::make_pair(i, j));
+    TThreadPool::instance().parallel_for(0, tasks.size(), 1, [&](size_t tb, size_t te) {
+        for (size_t t = tb; t < te; t++) {
+            const size_t i0 = tasks[t].first * STRIPE, j0 = tasks[t].second * STRIPE;
+            const size_t mi = n - i0 < STRIPE ? n - i0 : STRIPE;
+            const size_t mj = n - j0 < STRIPE ? n - j0 : STRIPE;
+            if (i0 == j0)
+                transpose_square_block(mi, a + i0 * ld + i0, ld);
+            else
+                transpose_swap(mi, mj, a + i0 * ld + j0, a + j0 * ld + i0, ld);
+        }
+    });
+}
+
+} // namespace kernels
+
+// Транспонированный блок: rows() x cols(), элемент (i, j) лежит по адресу
+// data() + j * stride() + i
+template<typename T>
+class TTransposeView : public TExpr<TTransposeView<T>, TRectTag>
+{
+    T* pMem;
+    size_t nr, nc, ld;
+public:
+    typedef typename std::remove_const<T>::type value_type;
+
+    // m - исходный (нетранспонированный) блок
+    explicit TTransposeView(const TMatrixView<T>& m) noexcept
+        : pMem(m.data()), nr(m.cols()), nc(m.rows()), ld(m.stride()) {}
+    template<typename U, typename = typename std::enable_if<std::is_same<const U, T>::value>::type>
+    TTransposeView(const TTransposeView<U>& v) noexcept : pMem(v.data()), nr(v.rows()), nc(v.cols()), ld(v.stride()) {}
+
+    size_t rows() const noexcept { return nr; }
+    size_t cols() const noexcept { return nc; }
+    size_t stride() const noexcept { return ld; }
+    size_t size() const noexcept { return nr; }
+    size_t count() const noexcept { return nr * nc; }
+    size_t layout() const noexcept { return nc; }
+    const value_type& elem(size_t i) const { return pMem[(i % nc) * ld + i / nc]; }
+    T* data() const noexcept { return pMem; }
+
+    // результат произведения получает аллокатор по умолчанию
+    TAlignedAllocator<value_type> get_allocator() const { return TAlignedAllocator<value_type>(); }
+
+    T& get(size_t i, size_t j) const
+    {
+        if (i >= nr || j >= nc) throw out_of_range("out of range");
+        return pMem[j * ld + i];
+    }
+
+    // исходный блок: (A^T)^T = A
+    TMatrixView<T> transpose() const { return TMatrixView<T>(pMem, nc, nr, ld); }
+
+    friend ostream& operator<<(ostream& ostr, const TTransposeView& v)
+    {
+        for (size_t i = 0; i < v.nr; i++) {
+            for (size_t j = 0; j < v.nc; j++)
+                ostr << v.pMem[j * v.ld + i] << ' ';
+            ostr << endl;
+        }
+        return ostr;
+    }
+};
+
+template<typename M>
+auto transpose(const M& m) -> TTransposeView<typename std::remove_pointer<decltype(view(m).data())>::type>
+{
+    return TTransposeView<typename std::remove_pointer<decltype(view(m).data())>::type>(view(m));
+}
+template<typename T>
+TMatrixView<T> transpose(const TTransposeView<T>& m) { return m.transpose(); }
+
+// Копия A^T строится блочным транспонированием, а не поэлементно
+template<typename T>
+struct TRowEval<TTransposeView<T>>
+{
+    static const bool fast = true;
+    static const bool dense = false;
+    template<typename U>
+    static void run(U* dst, size_t ldd, const TTransposeView<T>& e, size_t ib, size_t ie)
+    {
+        kernels::transpose_block(e.cols(), ie - ib, e.data() + ib, e.stride(), dst + ib * ldd, ldd);
+    }
+};
+
+// транспонированный блок той же памяти читается не по индексам записи
+template<typename U, typename T>
+bool expr_permutes(const TTransposeView<U>& e, const T* p, size_t rows, size_t cols, size_t ld)
+{
+    return views_overlap(e.transpose(), TMatrixView<const T>(p, rows, cols, ld));
+}
+
+// Транспонирование квадратной матрицы (TDynamicMatrix, TRectMatrix или
+// блока) на месте
+template<typename M>
+void transpose_in_place(M&& m)
+{
+    auto v = view(m);
+    if (v.rows() != v.cols()) throw logic_error("matrix is not square");
+    kernels::transpose_in_place(v.rows(), v.data(), v.stride());
+}
+
+// Операнд блочного GEMM: хранимый блок rows x cols (строки через ld),
+// при trans участвует в произведении транспонированным
+template<typename T>
+struct TGemmOperand
+{
+    const T* data;
+    size_t rows, cols, ld;
+    bool trans;
+
+    size_t op_rows() const { return trans ? cols : rows; }
+    size_t op_cols() const { return trans ? rows : cols; }
+    ptrdiff_t rs() const { return trans ? 1 : ptrdiff_t(ld); }
+    ptrdiff_t cs() const { return trans ? ptrdiff_t(ld) : 1; }
+    TMatrixView<const T> stored() const { return TMatrixView<const T>(data, rows, cols, ld); }
+};
+
+template<typename T, typename A>
+TGemmOperand<T> gemm_operand(const TDynamicMatrix<T, A>& m)
+{
+    TGemmOperand<T> op = { m.data(), m.size(), m.size(), m.size(), false };
+    return op;
+}
+template<typename T, typename A>
+TGemmOperand<T> gemm_operand(const TRectMatrix<T, A>& m)
+{
+    TGemmOperand<T> op = { m.data(), m.rows(), m.cols(), m.stride(), false };
+    return op;
+}
+template<typename T>
+TGemmOperand<typename std::remove_const<T>::type> gemm_operand(const TMatrixView<T>& m)
+{
+    TGemmOperand<typename std::remove_const<T>::type> op = { m.data(), m.rows(), m.cols(), m.stride(), false };
+    return op;
+}
+template<typename T>
+TGemmOperand<typename std::remove_const<T>::type> gemm_operand(const TTransposeView<T>& m)
+{
+    TGemmOperand<typename std::remove_const<T>::type> op = { m.data(), m.cols(), m.rows(), m.stride(), true };
+    return op;
+}
+
+// C (m x n, строки через ldc) = alpha op(A) op(B) + beta C
+template<typename T>
+void gemm_operands(T alpha, const TGemmOperand<T>& a, const TGemmOperand<T>& b, T beta, T* c, size_t m, size_t n, size_t ldc)
+{
+    if (a.op_cols() != b.op_rows() || a.op_rows() != m || b.op_cols() != n) throw logic_error("different lengths");
+    kernels::gemm(m, n, a.op_cols(), alpha, a.data, a.rs(), a.cs(), b.data, b.rs(), b.cs(), beta, c, ldc);
+}
+
+// Произведения с транспонированным операндом. Результат - TRectMatrix
+// с аллокатором по умолчанию.
+template<typename TA, typename R>
+TRectMatrix<typename R::value_type> operator*(const TTransposeView<TA>& l, const TExpr<R, TRectTag>& r)
+{
+    typedef typename R::value_type T;
+    const auto& b = materialize(r.self());
+    TRectMatrix<T> res(l.rows(), b.cols(), uninitialized);
+    gemm_operands(T(1), gemm_operand(l), gemm_operand(b), T(), res.data(), res.rows(), res.cols(), res.stride());
+    return res;
+}
+
+template<typename L, typename TB>
+TRectMatrix<typename L::value_type> operator*(const TExpr<L, TRectTag>& l, const TTransposeView<TB>& r)
+{
+    typedef typename L::value_type T;
+    const auto& a = materialize(l.self());
+    TRectMatrix<T> res(a.rows(), r.cols(), uninitialized);
+    gemm_operands(T(1), gemm_operand(a), gemm_operand(r), T(), res.data(), res.rows(), res.cols(), res.stride());
+    return res;
+}
+
+template<typename TA, typename TB>
+TRectMatrix<typename TTransposeView<TA>::value_type> operator*(const TTransposeView<TA>& l, const TTransposeView<TB>& r)
+{
+    typedef typename TTransposeView<TA>::value_type T;
+    TRectMatrix<T> res(l.rows(), r.cols(), uninitialized);
+    gemm_operands(T(1), gemm_operand(l), gemm_operand(r), T(), res.data(), res.rows(), res.cols(), res.stride());
+    return res;
+}
+
+// с квадратными матрицами: A^T B и A B^T для TDynamicMatrix
+template<typename TA, typename R>
+TDynamicMatrix<typename R::value_type> operator*(const TTransposeView<TA>& l, const TExpr<R, TMatrixTag>& r)
+{
+    typedef typename R::value_type T;
+    const auto& b = materialize(r.self());
+    if (l.rows() != l.cols()) throw logic_error("different lengths");
+    TDynamicMatrix<T> res(l.rows(), uninitialized);
+    gemm_operands(T(1), gemm_operand(l), gemm_operand(b), T(), res.data(), res.size(), res.size(), res.size());
+    return res;
+}
+
+template<typename L, typename TB>
+TDynamicMatrix<typename L::value_type> operator*(const TExpr<L, TMatrixTag>& l, const TTransposeView<TB>& r)
+{
+    typedef typename L::value_type T;
+    const auto& a = materialize(l.self());
+    if (r.rows() != r.cols()) throw logic_error("different lengths");
+    TDynamicMatrix<T> res(a.size(), uninitialized);
+    gemm_operands(T(1), gemm_operand(a), gemm_operand(r), T(), res.data(), res.size(), res.size(), res.size());
+    return res;
+}
+
+// A^T x
+template<typename TA, typename R>
+TDynamicVector<typename R::value_type> operator*(const TTransposeView<TA>& l, const TExpr<R, TVectorTag>& r)
+{
+    typedef typename R::value_type T;
+    const auto& x = materialize(r.self());
+    if (l.cols() != x.size()) throw logic_error("different lengths");
+    TDynamicVector<T> res(l.rows(), uninitialized);
+    kernels::gemv_t(l.cols(), l.rows(), T(1), l.data(), l.stride(), x.data(), T(), res.data());
+    return res;
+}
+
+// Совмещённые операции: хотя бы один операнд транспонирован
+
+template<typename E>
+struct TIsTransposed : std::false_type {};
+template<typename T>
+struct TIsTransposed<TTransposeView<T>> : std::true_type {};
+
+// C = alpha op(A) op(B) + beta C
+template<typename T, typename A, typename B>
+typename std::enable_if<TIsTransposed<A>::value || TIsTransposed<B>::value>::type
+gemm(T alpha, const A& a, const B& b, T beta, const TMatrixView<T>& c)
+{
+    const TGemmOperand<T> oa = gemm_operand(a), ob = gemm_operand(b);
+    if (views_overlap(oa.stored(), c) || views_overlap(ob.stored(), c)) throw logic_error("result must not alias an operand");
+    gemm_operands(alpha, oa, ob, beta, c.data(), c.rows(), c.cols(), c.stride());
+}
+
+template<typename T, typename A, typename B, typename AC>
+typename std::enable_if<TIsTransposed<A>::value || TIsTransposed<B>::value>::type
+gemm(T alpha, const A& a, const B& b, T beta, TRectMatrix<T, AC>& c)
+{
+    gemm(alpha, a, b, beta, view(c));
+}
+
+template<typename T, typename A, typename B, typename AC>
+typename std::enable_if<TIsTransposed<A>::value || TIsTransposed<B>::value>::type
+gemm(T alpha, const A& a, const B& b, T beta, TDynamicMatrix<T, AC>& c)
+{
+    gemm(alpha, a, b, beta, view(c));
+}
+
+// y = alpha A^T x + beta y
+template<typename T, typename TA, typename AX, typename AY>
+void gemv(T alpha, const TTransposeView<TA>& a, const TDynamicVector<T, AX>& x, T beta, TDynamicVector<T, AY>& y)
+{
+    if (a.cols() != x.size() || a.rows() != y.size()) throw logic_error("different lengths");
+    if (x.data() == y.data()) throw logic_error("result must not alias an operand");
+    kernels::gemv_t(a.cols(), a.rows(), alpha, a.data(), a.stride(), x.data(), beta, y.data());
+}
+
+#endif
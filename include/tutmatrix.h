@@ -0,0 +1,250 @@
+// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Верхнетреугольная матрица в упакованном формате
+//
+// Хранятся только n (n + 1) / 2 элементов на диагонали и над ней,
+// построчно в одном непрерывном буфере (см. tpacked.h). Поэлементные
+// операции идут по упакованному буферу, произведения пропускают нулевую
+// часть: умножение на вектор требует вдвое, а произведение двух
+// треугольных матриц - втрое меньше операций, чем для плотных матриц.
+
+#ifndef __TUpperTriangularMatrix_H__
+#define __TUpperTriangularMatrix_H__
+
+#include "tmatrix.h"
+#include "tpacked.h"
+
+// Вид операнда: треугольные матрицы смешиваются только между собой
+struct TUpperTag
+{
+    static const char* mismatch() { return "different lengths"; }
+};
+// прибавление скаляра заполнило бы нули под диагональю
+template<>
+struct TExprScalarShift<TUpperTag> : std::false_type {};
+
+// Строка i верхнетреугольной матрицы: индексы столбцов от i до n - 1
+template<typename T>
+class TUpperRow
+{
+    T* pMem;     // элемент (i, i)
+    size_t first;
+    size_t sz;
+public:
+    TUpperRow(T* p, size_t i, size_t n) noexcept : pMem(p), first(i), sz(n) {}
+
+    size_t size() const noexcept { return sz; }
+    size_t first_column() const noexcept { return first; }
+    T* data() const noexcept { return pMem; }
+
+    // индексация: только j >= i
+    T& operator[](size_t j) const
+    {
+        assert(j >= first && "element below the diagonal");
+        return pMem[j - first];
+    }
+    // индексация с контролем
+    T& at(size_t j) const
+    {
+        if (j < first || j >= sz) throw out_of_range("out of range");
+        return pMem[j - first];
+    }
+};
+
+template<typename T, typename Alloc = TAlignedAllocator<T>>
+class TUpperTriangularMatrix : public TExpr<TUpperTriangularMatrix<T, Alloc>, TUpperTag>
+{
+    size_t sz;
+    TDynamicVector<T, Alloc> mem;
+
+    static size_t packed(size_t s)
+    {
+        if (s == 0 || s > MAX_MATRIX_SIZE)
+            throw length_error("Matrix size should be greater than zero and less than MAX_MATRIX_SIZE");
+        return kernels::upper_count(s);
+    }
+public:
+    typedef T value_type;
+    typedef Alloc allocator_type;
+
+    TUpperTriangularMatrix(size_t s = 1, const Alloc& a = Alloc()) : sz(s), mem(packed(s), a) {}
+    TUpperTriangularMatrix(size_t s, TUninitialized, const Alloc& a = Alloc())
+        : sz(s), mem(packed(s), uninitialized, a) {}
+    // верхний треугольник плотной матрицы
+    template<typename A>
+    explicit TUpperTriangularMatrix(const TDynamicMatrix<T, A>& m, const Alloc& a = Alloc())
+        : TUpperTriangularMatrix(m.size(), uninitialized, a)
+    {
+        for (size_t i = 0; i < sz; i++)
+            mem_copy(m.data() + i * sz + i, sz - i, (*this)[i].data());
+    }
+    // вычисление выражения за один проход
+    template<typename E>
+    TUpperTriangularMatrix(const TExpr<E, TUpperTag>& e, const Alloc& a = Alloc())
+        : TUpperTriangularMatrix(e.self().size(), uninitialized, a)
+    {
+        static_assert(std::is_same<typename E::value_type, T>::value, "element types differ");
+        expr_assign(mem.data(), e.self());
+    }
+    TUpperTriangularMatrix(const TUpperTriangularMatrix& m) = default;
+    TUpperTriangularMatrix(TUpperTriangularMatrix&& m) noexcept : sz(m.sz), mem(std::move(m.mem))
+    {
+        m.sz = 0;
+    }
+    TUpperTriangularMatrix& operator=(const TUpperTriangularMatrix& m) = default;
+    TUpperTriangularMatrix& operator=(TUpperTriangularMatrix&& m) noexcept
+    {
+        sz = m.sz;
+        mem = std::move(m.mem);
+        m.sz = 0;
+        return *this;
+    }
+    template<typename E>
+    TUpperTriangularMatrix& operator=(const TExpr<E, TUpperTag>& e)
+    {
+        if (sz != e.self().size()) {
+            TUpperTriangularMatrix tmp(e);
+            swap(*this, tmp);
+        }
+        else
+            expr_assign(mem.data(), e.self());
+        return *this;
+    }
+
+    size_t size() const noexcept { return sz; }
+    size_t count() const noexcept { return kernels::upper_count(sz); }
+    const T& elem(size_t i) const { return mem.data()[i]; }
+
+    // непосредственный доступ к упакованному буферу
+    T* data() noexcept { return mem.data(); }
+    const T* data() const noexcept { return mem.data(); }
+
+    void fill(const T& val) { mem.fill(val); }
+
+    // индексация
+    TUpperRow<T> operator[](size_t ind)
+    {
+        return TUpperRow<T>(mem.data() + kernels::upper_offset(sz, ind), ind, sz);
+    }
+    TUpperRow<const T> operator[](size_t ind) const
+    {
+        return TUpperRow<const T>(mem.data() + kernels::upper_offset(sz, ind), ind, sz);
+    }
+    // индексация с контролем
+    TUpperRow<T> at(size_t ind)
+    {
+        if (ind >= sz) throw out_of_range("out of range");
+        return (*this)[ind];
+    }
+    TUpperRow<const T> at(size_t ind) const
+    {
+        if (ind >= sz) throw out_of_range("out of range");
+        return (*this)[ind];
+    }
+    // значение любого элемента, включая нули под диагональю
+    T get(size_t i, size_t j) const
+    {
+        if (i >= sz || j >= sz) throw out_of_range("out of range");
+        return j < i ? T() : (*this)[i][j];
+    }
+
+    TDynamicMatrix<T, Alloc> dense() const
+    {
+        TDynamicMatrix<T, Alloc> res(sz, mem.get_allocator());
+        for (size_t i = 0; i < sz; i++)
+            mem_copy((*this)[i].data(), sz - i, res.data() + i * sz + i);
+        return res;
+    }
+
+    // поэлементные операции - см. texpr.h, произведения - после
+    // определения класса
+
+    // операции с присваиванием, без выделения памяти
+    template<typename E>
+    TUpperTriangularMatrix& operator+=(const TExpr<E, TUpperTag>& e)
+    {
+        expr_assign(mem.data(), *this + e.self());
+        return *this;
+    }
+    template<typename E>
+    TUpperTriangularMatrix& operator-=(const TExpr<E, TUpperTag>& e)
+    {
+        expr_assign(mem.data(), *this - e.self());
+        return *this;
+    }
+    TUpperTriangularMatrix& operator*=(const T& val)
+    {
+        expr_assign(mem.data(), *this * val);
+        return *this;
+    }
+
+    allocator_type get_allocator() const { return mem.get_allocator(); }
+
+    friend void swap(TUpperTriangularMatrix& lhs, TUpperTriangularMatrix& rhs) noexcept
+    {
+        std::swap(lhs.sz, rhs.sz);
+        swap(lhs.mem, rhs.mem);
+    }
+
+    // ввод/вывод: вводятся только элементы на диагонали и над ней,
+    // выводится вся матрица
+    friend istream& operator>>(istream& istr, TUpperTriangularMatrix& v)
+    {
+        for (size_t i = 0; i < v.count(); i++)
+            istr >> v.mem[i];
+        return istr;
+    }
+    friend ostream& operator<<(ostream& ostr, const TUpperTriangularMatrix& v)
+    {
+        for (size_t i = 0; i < v.sz; i++) {
+            for (size_t j = 0; j < v.sz; j++)
+                ostr << v.get(i, j) << ' ';
+            ostr << endl;
+        }
+        return ostr;
+    }
+};
+
+template<typename T, typename A>
+struct TExprDense<TUpperTriangularMatrix<T, A>> : std::true_type {};
+template<typename T, typename A>
+struct TExprOwner<TUpperTriangularMatrix<T, A>> : std::true_type {};
+
+template<typename T, typename A>
+const TUpperTriangularMatrix<T, A>& materialize(const TUpperTriangularMatrix<T, A>& m) { return m; }
+template<typename E>
+TUpperTriangularMatrix<typename E::value_type> materialize(const TExpr<E, TUpperTag>& e)
+{
+    return TUpperTriangularMatrix<typename E::value_type>(e);
+}
+
+// умножение на вектор
+template<typename L, typename R>
+TDynamicVector<typename L::value_type> operator*(const TExpr<L, TUpperTag>& l, const TExpr<R, TVectorTag>& r)
+{
+    typedef typename L::value_type T;
+    const auto& a = materialize(l.self());
+    const auto& x = materialize(r.self());
+    const size_t sz = a.size();
+    if (sz != x.size()) throw logic_error("different lengths");
+    TDynamicVector<T> res(sz, uninitialized);
+    kernels::trmv_upper(sz, a.data(), x.data(), res.data());
+    return res;
+}
+
+// произведение треугольных матриц - верхнетреугольная матрица
+template<typename L, typename R>
+TUpperTriangularMatrix<typename L::value_type, typename TExprAllocator<L>::type>
+operator*(const TExpr<L, TUpperTag>& l, const TExpr<R, TUpperTag>& r)
+{
+    typedef typename L::value_type T;
+    const auto& a = materialize(l.self());
+    const auto& b = materialize(r.self());
+    const size_t sz = a.size();
+    if (sz != b.size()) throw logic_error("different lengths");
+    TUpperTriangularMatrix<T, typename TExprAllocator<L>::type> res(sz, uninitialized, a.get_allocator());
+    kernels::trmm_upper(sz, T(1), a.data(), b.data(), res.data());
+    return res;
+}
+
+#endif
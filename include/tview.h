@@ -0,0 +1,534 @@
+// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Представления частей матриц и векторов
+//
+// Представление не владеет памятью: это указатель на первый элемент,
+// размеры и шаг. TMatrixView - прямоугольный блок матрицы (строки через
+// stride() элементов), TStridedVector - вектор с шагом (например,
+// столбец матрицы). Представления участвуют в выражениях наравне с
+// TRectMatrix и TDynamicVector, а блочные ядра (gemv, gemm) получают их
+// память напрямую, так что плитки обрабатываются на месте, без копий.
+// Представление нельзя хранить дольше, чем живёт матрица.
+//
+// Представление матрицы - операнд вида TRectTag. С ним смешиваются и
+// квадратные матрицы (A + view(B), A * view(B)): TDynamicMatrix входит в
+// выражение своим представлением, другое выражение вида TMatrixTag -
+// узлом TRectExpr; размеры проверяются при построении выражения, а
+// результат - прямоугольный (TRectMatrix или присваивание в view(A)).
+// TStridedVector - операнд вида TVectorTag и принимается всеми
+// произведениями на вектор; несмежный вектор ядрам, которым нужна
+// непрерывная память (упакованные, ленточные, CSR, BSR), передаётся
+// копией. Матрицы этих форматов хранят свои элементы в собственной
+// упаковке, поэтому представлений плотных блоков они не принимают.
+
+#ifndef __TView_H__
+#define __TView_H__
+
+#include <functional>
+#include "trectmatrix.h"
+#include "tdiag.h"
+
+// Вектор с шагом: элементы p[0], p[inc], p[2 inc], ...
+template<typename T>
+class TStridedVector : public TExpr<TStridedVector<T>, TVectorTag>
+{
+    T* pMem;
+    size_t sz, inc;
+public:
+    typedef typename std::remove_const<T>::type value_type;
+
+    TStridedVector(T* p, size_t size, size_t step = 1) noexcept : pMem(p), sz(size), inc(step) {}
+    TStridedVector(const TStridedVector& v) noexcept = default;
+    // неизменяемое представление из изменяемого
+    template<typename U, typename = typename std::enable_if<std::is_same<const U, T>::value>::type>
+    TStridedVector(const TStridedVector<U>& v) noexcept : pMem(v.data()), sz(v.size()), inc(v.stride()) {}
+
+    // присваивание копирует элементы, а не само представление
+    TStridedVector& operator=(const TStridedVector& v)
+    {
+        return *this = static_cast<const TExpr<TStridedVector, TVectorTag>&>(v);
+    }
+    template<typename E>
+    TStridedVector& operator=(const TExpr<E, TVectorTag>& e)
+    {
+        if (sz != e.self().size()) throw logic_error("vectors have different lengths");
+        // операнд, сдвинутый относительно результата в той же памяти,
+        // сначала копируется (вектор - блок sz x 1 со строками через inc)
+        if (expr_permutes(e.self(), pMem, sz, 1, inc)) {
+            const TDynamicVector<value_type> tmp(e.self());
+            return *this = tmp;
+        }
+        if (inc == 1)
+            expr_assign(pMem, e.self());
+        else
+            for (size_t i = 0; i < sz; i++)
+                pMem[i * inc] = e.self().elem(i);
+        return *this;
+    }
+
+    // операции с присваиванием
+    template<typename E>
+    TStridedVector& operator+=(const TExpr<E, TVectorTag>& e) { return *this = *this + e.self(); }
+    template<typename E>
+    TStridedVector& operator-=(const TExpr<E, TVectorTag>& e) { return *this = *this - e.self(); }
+    TStridedVector& operator*=(value_type val) { return *this = *this * val; }
+
+    size_t size() const noexcept { return sz; }
+    size_t count() const noexcept { return sz; }
+    size_t stride() const noexcept { return inc; }
+    const value_type& elem(size_t i) const { return pMem[i * inc]; }
+    // первый элемент; следующие - через stride()
+    T* data() const noexcept { return pMem; }
+
+    void fill(const value_type& val) const
+    {
+        for (size_t i = 0; i < sz; i++)
+            pMem[i * inc] = val;
+    }
+
+    // индексация
+    T& operator[](size_t ind) const { return pMem[ind * inc]; }
+    // индексация с контролем
+    T& at(size_t ind) const
+    {
+        if (ind >= sz) throw out_of_range("out of range");
+        return pMem[ind * inc];
+    }
+
+    friend ostream& operator<<(ostream& ostr, const TStridedVector& v)
+    {
+        for (size_t i = 0; i < v.sz; i++)
+            ostr << v[i] << ' ';
+        return ostr;
+    }
+};
+
+// Блок матрицы: rows() x cols() элементов, строка i начинается с
+// data() + i * stride()
+template<typename T>
+class TMatrixView : public TExpr<TMatrixView<T>, TRectTag>
+{
+    T* pMem;
+    size_t nr, nc, ld;
+public:
+    typedef typename std::remove_const<T>::type value_type;
+
+    TMatrixView(T* p, size_t rows, size_t cols, size_t step) : pMem(p), nr(rows), nc(cols), ld(step)
+    {
+        if (rows == 0 || cols == 0) throw length_error("Matrix size should be greater than zero");
+        if (step < cols) throw logic_error("rows overlap");
+    }
+    TMatrixView(const TMatrixView& v) noexcept = default;
+    template<typename U, typename = typename std::enable_if<std::is_same<const U, T>::value>::type>
+    TMatrixView(const TMatrixView<U>& v) noexcept : pMem(v.data()), nr(v.rows()), nc(v.cols()), ld(v.stride()) {}
+
+    // присваивание копирует элементы; операнд, частично перекрывающийся
+    // с блоком-результатом, сначала копируется
+    TMatrixView& operator=(const TMatrixView& v)
+    {
+        return *this = static_cast<const TExpr<TMatrixView, TRectTag>&>(v);
+    }
+    template<typename E>
+    TMatrixView& operator=(const TExpr<E, TRectTag>& e);
+
+    // операции с присваиванием
+    template<typename E>
+    TMatrixView& operator+=(const TExpr<E, TRectTag>& e) { return *this = *this + e.self(); }
+    template<typename E>
+    TMatrixView& operator-=(const TExpr<E, TRectTag>& e) { return *this = *this - e.self(); }
+    TMatrixView& operator*=(value_type val) { return *this = *this * val; }
+
+    size_t rows() const noexcept { return nr; }
+    size_t cols() const noexcept { return nc; }
+    size_t stride() const noexcept { return ld; }
+    size_t size() const noexcept { return nr; }
+    size_t count() const noexcept { return nr * nc; }
+    size_t layout() const noexcept { return nc; }
+    const value_type& elem(size_t i) const { return pMem[(i / nc) * ld + i % nc]; }
+    T* data() const noexcept { return pMem; }
+
+    // результат произведения с представлением получает аллокатор по умолчанию
+    TAlignedAllocator<value_type> get_allocator() const { return TAlignedAllocator<value_type>(); }
+
+    void fill(const value_type& val) const
+    {
+        for (size_t i = 0; i < nr; i++)
+            mem_fill<value_type>(pMem + i * ld, nc, val);
+    }
+
+    // индексация
+    TMatrixRow<T> operator[](size_t ind) const
+    {
+        return TMatrixRow<T>(pMem + ind * ld, nc);
+    }
+    // индексация с контролем
+    TMatrixRow<T> at(size_t ind) const
+    {
+        if (ind >= nr) throw out_of_range("out of range");
+        return (*this)[ind];
+    }
+
+    // части представления
+    TMatrixView block(size_t i, size_t j, size_t rows, size_t cols) const
+    {
+        if (i + rows > nr || j + cols > nc || rows > nr || cols > nc) throw out_of_range("out of range");
+        return TMatrixView(pMem + i * ld + j, rows, cols, ld);
+    }
+    TMatrixView row_range(size_t b, size_t e) const
+    {
+        if (b > e) throw out_of_range("out of range");
+        return block(b, 0, e - b, nc);
+    }
+    TMatrixView col_range(size_t b, size_t e) const
+    {
+        if (b > e) throw out_of_range("out of range");
+        return block(0, b, nr, e - b);
+    }
+    TStridedVector<T> column(size_t j) const
+    {
+        if (j >= nc) throw out_of_range("out of range");
+        return TStridedVector<T>(pMem + j, nr, ld);
+    }
+
+    friend ostream& operator<<(ostream& ostr, const TMatrixView& v)
+    {
+        for (size_t i = 0; i < v.nr; i++)
+            ostr << v[i] << endl;
+        return ostr;
+    }
+};
+
+template<typename T>
+const TMatrixView<T>& materialize(const TMatrixView<T>& m) { return m; }
+
+// Представления - лёгкие описатели, поэтому узлы выражений хранят их
+// копии: временное представление можно сразу использовать как операнд
+template<typename T>
+struct TExprStore<TMatrixView<T>>
+{
+    typedef const TMatrixView<T> type;
+};
+template<typename T>
+struct TExprStore<TStridedVector<T>>
+{
+    typedef const TStridedVector<T> type;
+};
+
+// Лист с построчным хранением (data() и stride()): выражения над такими
+// листьями вычисляются по строкам SIMD-ядрами
+template<typename E>
+struct TExprStrided : std::false_type {};
+template<typename T>
+struct TExprStrided<TMatrixView<T>> : std::true_type {};
+template<typename T, typename A>
+struct TExprStrided<TRectMatrix<T, A>> : std::true_type {};
+
+// Вычисление строк [ib, ie) выражения e в dst, строки через ldd.
+// Общий случай - поэлементно; для строчных листьев и одной операции над
+// ними - ядрами из tsimd.h по строкам.
+template<typename E, typename Enable = void>
+struct TRowEval
+{
+    static const bool fast = false;
+    static const bool dense = false;
+    template<typename T>
+    static void run(T* dst, size_t ldd, const E& e, size_t ib, size_t ie)
+    {
+        const size_t n = e.layout();
+        for (size_t i = ib; i < ie; i++)
+            for (size_t j = 0; j < n; j++)
+                dst[i * ldd + j] = e.elem(i * n + j);
+    }
+};
+
+template<typename E>
+struct TRowEval<E, typename std::enable_if<TExprStrided<E>::value>::type>
+{
+    static const bool fast = true;
+    static const bool dense = TExprDense<E>::value;
+    template<typename T>
+    static void run(T* dst, size_t ldd, const E& e, size_t ib, size_t ie)
+    {
+        for (size_t i = ib; i < ie; i++)
+            mem_copy<T>(e.data() + i * e.stride(), e.cols(), dst + i * ldd);
+    }
+};
+
+template<typename L, typename R, typename Op>
+struct TRowEval<TBinaryExpr<L, R, Op>, typename std::enable_if<TExprStrided<L>::value && TExprStrided<R>::value
+    && (std::is_same<Op, TOpAdd>::value || std::is_same<Op, TOpSub>::value)>::type>
+{
+    static const bool fast = true;
+    static const bool dense = TExprDense<L>::value && TExprDense<R>::value;
+    template<typename T>
+    static void run(T* dst, size_t ldd, const TBinaryExpr<L, R, Op>& e, size_t ib, size_t ie)
+    {
+        const L& l = e.lhs();
+        const R& r = e.rhs();
+        for (size_t i = ib; i < ie; i++) {
+            const T* a = l.data() + i * l.stride();
+            const T* b = r.data() + i * r.stride();
+            if (std::is_same<Op, TOpAdd>::value)
+                kernels::add(l.cols(), a, b, dst + i * ldd);
+            else
+                kernels::sub(l.cols(), a, b, dst + i * ldd);
+        }
+    }
+};
+
+template<typename L, typename Op>
+struct TRowEval<TScalarExpr<L, Op>, typename std::enable_if<TExprStrided<L>::value>::type>
+{
+    static const bool fast = true;
+    static const bool dense = TExprDense<L>::value;
+    template<typename T>
+    static void run(T* dst, size_t ldd, const TScalarExpr<L, Op>& e, size_t ib, size_t ie)
+    {
+        const L& l = e.lhs();
+        for (size_t i = ib; i < ie; i++) {
+            const T* a = l.data() + i * l.stride();
+            if (std::is_same<Op, TOpMul>::value)
+                kernels::scale(l.cols(), a, e.value(), dst + i * ldd);
+            else if (std::is_same<Op, TOpAdd>::value)
+                kernels::shift(l.cols(), a, e.value(), dst + i * ldd);
+            else
+                kernels::shift(l.cols(), a, T(-e.value()), dst + i * ldd);
+        }
+    }
+};
+
+template<typename T, typename E>
+void expr_assign_rows(T* dst, size_t ldd, const E& e)
+{
+    kernels::for_rows(e.size(), e.layout(), [&](size_t ib, size_t ie) {
+        TRowEval<E>::run(dst, ldd, e, ib, ie);
+    });
+}
+
+// выражения с представлениями, вычисляемые в непрерывный буфер
+// (непрерывные листья по-прежнему идут одним проходом, см. texpr.h)
+template<typename E>
+struct TExprEval<E, typename std::enable_if<TRowEval<E>::fast && !TRowEval<E>::dense>::type>
+{
+    template<typename T>
+    static void run(T* dst, const E& e)
+    {
+        expr_assign_rows(dst, e.layout(), e);
+    }
+};
+
+template<typename T>
+template<typename E>
+TMatrixView<T>& TMatrixView<T>::operator=(const TExpr<E, TRectTag>& e)
+{
+    if (nr != e.self().size() || nc != e.self().layout()) throw logic_error(TRectTag::mismatch());
+    if (expr_permutes(e.self(), pMem, nr, nc, ld)) {
+        const TRectMatrix<value_type> tmp(e.self());
+        expr_assign_rows(pMem, ld, tmp);
+    }
+    else
+        expr_assign_rows(pMem, ld, e.self());
+    return *this;
+}
+
+// Представления целых матриц и векторов
+template<typename T, typename A>
+TMatrixView<T> view(TDynamicMatrix<T, A>& m) { return TMatrixView<T>(m.data(), m.size(), m.size(), m.size()); }
+template<typename T, typename A>
+TMatrixView<const T> view(const TDynamicMatrix<T, A>& m) { return TMatrixView<const T>(m.data(), m.size(), m.size(), m.size()); }
+template<typename T, typename A>
+TMatrixView<T> view(TRectMatrix<T, A>& m) { return TMatrixView<T>(m.data(), m.rows(), m.cols(), m.stride()); }
+template<typename T, typename A>
+TMatrixView<const T> view(const TRectMatrix<T, A>& m) { return TMatrixView<const T>(m.data(), m.rows(), m.cols(), m.stride()); }
+template<typename T>
+TMatrixView<T> view(const TMatrixView<T>& m) { return m; }
+template<typename T, typename A>
+TStridedVector<T> view(TDynamicVector<T, A>& v) { return TStridedVector<T>(v.data(), v.size()); }
+template<typename T, typename A>
+TStridedVector<const T> view(const TDynamicVector<T, A>& v) { return TStridedVector<const T>(v.data(), v.size()); }
+template<typename T>
+TStridedVector<T> view(const TMatrixRow<T>& r) { return TStridedVector<T>(r.data(), r.size()); }
+template<typename T>
+TStridedVector<T> view(const TStridedVector<T>& v) { return v; }
+
+// Выражение вида TMatrixTag (порядок n) как прямоугольное n x n
+template<typename E>
+class TRectExpr : public TExpr<TRectExpr<E>, TRectTag>, public TExprNode
+{
+    typename TExprStore<E>::type e;
+public:
+    typedef typename E::value_type value_type;
+
+    explicit TRectExpr(const E& ex) : e(ex) {}
+
+    size_t rows() const noexcept { return e.size(); }
+    size_t cols() const noexcept { return e.size(); }
+    size_t size() const noexcept { return e.size(); }
+    size_t count() const noexcept { return e.count(); }
+    size_t layout() const noexcept { return e.size(); }
+    value_type elem(size_t i) const { return e.elem(i); }
+};
+
+// квадратная матрица - без копии, выражение - поэлементно
+template<typename T, typename A>
+TMatrixView<const T> as_rect(const TDynamicMatrix<T, A>& m) { return view(m); }
+template<typename E>
+TRectExpr<E> as_rect(const TExpr<E, TMatrixTag>& e) { return TRectExpr<E>(e.self()); }
+
+// Смешанные операции квадратных и прямоугольных операндов
+template<typename L, typename R>
+auto operator+(const TExpr<L, TMatrixTag>& l, const TExpr<R, TRectTag>& r) -> decltype(as_rect(l.self()) + r.self())
+{
+    return as_rect(l.self()) + r.self();
+}
+template<typename L, typename R>
+auto operator+(const TExpr<L, TRectTag>& l, const TExpr<R, TMatrixTag>& r) -> decltype(l.self() + as_rect(r.self()))
+{
+    return l.self() + as_rect(r.self());
+}
+template<typename L, typename R>
+auto operator-(const TExpr<L, TMatrixTag>& l, const TExpr<R, TRectTag>& r) -> decltype(as_rect(l.self()) - r.self())
+{
+    return as_rect(l.self()) - r.self();
+}
+template<typename L, typename R>
+auto operator-(const TExpr<L, TRectTag>& l, const TExpr<R, TMatrixTag>& r) -> decltype(l.self() - as_rect(r.self()))
+{
+    return l.self() - as_rect(r.self());
+}
+template<typename L, typename R>
+auto operator*(const TExpr<L, TMatrixTag>& l, const TExpr<R, TRectTag>& r) -> decltype(as_rect(l.self()) * r.self())
+{
+    return as_rect(l.self()) * r.self();
+}
+template<typename L, typename R>
+auto operator*(const TExpr<L, TRectTag>& l, const TExpr<R, TMatrixTag>& r) -> decltype(l.self() * as_rect(r.self()))
+{
+    return l.self() * as_rect(r.self());
+}
+template<typename L, typename R>
+bool operator==(const TExpr<L, TMatrixTag>& l, const TExpr<R, TRectTag>& r)
+{
+    return as_rect(l.self()) == r.self();
+}
+template<typename L, typename R>
+bool operator==(const TExpr<L, TRectTag>& l, const TExpr<R, TMatrixTag>& r)
+{
+    return l.self() == as_rect(r.self());
+}
+template<typename L, typename R>
+bool operator!=(const TExpr<L, TMatrixTag>& l, const TExpr<R, TRectTag>& r)
+{
+    return !(l == r);
+}
+template<typename L, typename R>
+bool operator!=(const TExpr<L, TRectTag>& l, const TExpr<R, TMatrixTag>& r)
+{
+    return !(l == r);
+}
+
+// Части матрицы m (TDynamicMatrix, TRectMatrix или представления)
+template<typename M>
+auto block(M& m, size_t i, size_t j, size_t rows, size_t cols) -> decltype(view(m))
+{
+    return view(m).block(i, j, rows, cols);
+}
+template<typename M>
+auto row_range(M& m, size_t b, size_t e) -> decltype(view(m))
+{
+    return view(m).row_range(b, e);
+}
+template<typename M>
+auto col_range(M& m, size_t b, size_t e) -> decltype(view(m))
+{
+    return view(m).col_range(b, e);
+}
+template<typename M>
+auto column(M& m, size_t j) -> decltype(view(m).column(j))
+{
+    return view(m).column(j);
+}
+
+// пересекаются ли области памяти двух блоков
+template<typename T, typename U>
+bool views_overlap(const TMatrixView<T>& a, const TMatrixView<U>& b)
+{
+    std::less<const void*> less;
+    const void* ab = a.data(), *ae = a.data() + (a.rows() - 1) * a.stride() + a.cols();
+    const void* bb = b.data(), *be = b.data() + (b.rows() - 1) * b.stride() + b.cols();
+    return less(ab, be) && less(bb, ae);
+}
+
+// сдвинутый относительно результата блок той же памяти
+template<typename U, typename T>
+bool expr_permutes(const TMatrixView<U>& e, const T* p, size_t rows, size_t cols, size_t ld)
+{
+    return (e.data() != p || e.stride() != ld) && views_overlap(e, TMatrixView<const T>(p, rows, cols, ld));
+}
+
+// пересекается ли участок [b, b + (n - 1) inc] с блоком p (rows x cols,
+// строки через ld)
+template<typename U, typename T>
+bool strided_overlaps(const U* b, size_t n, size_t inc, const T* p, size_t rows, size_t cols, size_t ld)
+{
+    if (n == 0 || rows == 0)
+        return false;
+    std::less<const void*> less;
+    const void* e = b + (n - 1) * inc + 1;
+    const void* pe = p + (rows - 1) * ld + cols;
+    return less(b, pe) && less(p, e);
+}
+
+// сдвинутые относительно результата вектор с шагом или строка той же
+// памяти; результат-вектор передаётся блоком size x 1 со строками через
+// свой шаг
+template<typename U, typename T>
+bool expr_permutes(const TStridedVector<U>& e, const T* p, size_t rows, size_t cols, size_t ld)
+{
+    return (e.data() != p || e.stride() != ld) && strided_overlaps(e.data(), e.size(), e.stride(), p, rows, cols, ld);
+}
+template<typename U, typename T>
+bool expr_permutes(const TMatrixRow<U>& e, const T* p, size_t rows, size_t cols, size_t ld)
+{
+    return (e.data() != p || ld != 1) && strided_overlaps(e.data(), e.size(), 1, p, rows, cols, ld);
+}
+
+// y = alpha A x + beta y над представлениями. Векторы с шагом
+// собираются во временный непрерывный буфер.
+template<typename T, typename TA, typename TX>
+void gemv(T alpha, const TMatrixView<TA>& a, const TStridedVector<TX>& x, T beta, const TStridedVector<T>& y)
+{
+    static_assert(std::is_same<typename std::remove_const<TA>::type, T>::value, "element types differ");
+    if (a.cols() != x.size() || a.rows() != y.size()) throw logic_error("different lengths");
+    if (x.data() == y.data()) throw logic_error("result must not alias an operand");
+    TDynamicVector<T> xs(1), ys(1);
+    const T* px = x.data();
+    T* py = y.data();
+    if (x.stride() != 1) {
+        xs = TDynamicVector<T>(x);
+        px = xs.data();
+    }
+    if (y.stride() != 1) {
+        ys = TDynamicVector<T>(y);
+        py = ys.data();
+    }
+    kernels::gemv(a.rows(), a.cols(), alpha, a.data(), a.stride(), px, beta, py);
+    if (y.stride() != 1) {
+        TStridedVector<T> res(y);
+        res = ys;
+    }
+}
+
+// C = alpha A B + beta C над блоками
+template<typename T, typename TA, typename TB>
+void gemm(T alpha, const TMatrixView<TA>& a, const TMatrixView<TB>& b, T beta, const TMatrixView<T>& c)
+{
+    static_assert(std::is_same<typename std::remove_const<TA>::type, T>::value
+        && std::is_same<typename std::remove_const<TB>::type, T>::value, "element types differ");
+    const size_t m = a.rows(), n = b.cols(), k = a.cols();
+    if (k != b.rows() || m != c.rows() || n != c.cols()) throw logic_error("different lengths");
+    if (views_overlap(a, c) || views_overlap(b, c)) throw logic_error("result must not alias an operand");
+    kernels::gemm(m, n, k, alpha, a.data(), a.stride(), 1, b.data(), b.stride(), 1, beta, c.data(), c.stride());
+}
+
+#endif
@@ -0,0 +1,63 @@
+// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Замеры производительности матричных операций
+//
+// Использование: bench_matrix [n1 n2 ...]
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include "tmatrix.h"
+//---------------------------------------------------------------------------
+
+template<typename T>
+void fill(TDynamicMatrix<T>& m, unsigned seed)
+{
+  for (size_t i = 0; i < m.size(); i++)
+    for (size_t j = 0; j < m.size(); j++)
+    {
+      seed = seed * 1103515245u + 12345u;
+      m[i][j] = T((seed >> 16) % 1000) / T(1000);
+    }
+}
+
+template<typename T>
+double bench_gemm(size_t n)
+{
+  TDynamicMatrix<T> a(n), b(n);
+  fill(a, 1);
+  fill(b, 2);
+  TDynamicMatrix<T> c = a * b; // прогрев
+
+  int reps = 0;
+  double seconds = 0;
+  auto start = chrono::steady_clock::now();
+  do
+  {
+    c = a * b;
+    reps++;
+    seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+  } while (seconds < 1.0);
+  return 2.0 * n * n * n * reps / seconds * 1e-9;
+}
+
+int main(int argc, char** argv)
+{
+  size_t sizes[16] = { 256, 512, 1024, 2000 };
+  int count = 4;
+  if (argc > 1)
+  {
+    count = 0;
+    for (int i = 1; i < argc && count < 16; i++)
+      sizes[count++] = strtoul(argv[i], nullptr, 10);
+  }
+
+  cout << "GEMM, GFLOP/s" << endl;
+  cout << "n\tdouble\tfloat" << endl;
+  for (int i = 0; i < count; i++)
+    cout << sizes[i] << '\t' << bench_gemm<double>(sizes[i])
+      << '\t' << bench_gemm<float>(sizes[i]) << endl;
+
+  return 0;
+}
+//---------------------------------------------------------------------------
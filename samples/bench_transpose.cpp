@@ -0,0 +1,71 @@
+// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Замеры скорости транспонирования в сравнении с копированием памяти
+//
+// Пропускная способность считается как (чтение + запись) / время.
+// Использование: bench_transpose [n1 n2 ...]
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include "ttranspose.h"
+//---------------------------------------------------------------------------
+
+// Повторяет op не меньше секунды, возвращает ГБ/с для n x n элементов T
+template<typename T, typename F>
+double bandwidth(size_t n, const F& op)
+{
+  op(); // прогрев
+
+  int reps = 0;
+  double seconds = 0;
+  auto start = chrono::steady_clock::now();
+  do
+  {
+    op();
+    reps++;
+    seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+  } while (seconds < 1.0);
+  return 2.0 * n * n * sizeof(T) * reps / seconds * 1e-9;
+}
+
+template<typename T>
+void bench(size_t n)
+{
+  TDynamicMatrix<T> a(n), b(n);
+  for (size_t i = 0; i < n; i++)
+    for (size_t j = 0; j < n; j++)
+      a[i][j] = T(i * n + j);
+
+  const double copy = bandwidth<T>(n, [&]() { memcpy(b.data(), a.data(), n * n * sizeof(T)); });
+  const double naive = bandwidth<T>(n, [&]() {
+    for (size_t i = 0; i < n; i++)
+      for (size_t j = 0; j < n; j++)
+        b[j][i] = a[i][j];
+  });
+  const double outOfPlace = bandwidth<T>(n, [&]() { view(b) = transpose(a); });
+  const double inPlace = bandwidth<T>(n, [&]() { transpose_in_place(a); });
+
+  cout << n << '\t' << copy << '\t' << naive << '\t' << outOfPlace << '\t' << inPlace << endl;
+}
+
+int main(int argc, char** argv)
+{
+  size_t sizes[16] = { 1024, 2048, 4096, 8192 };
+  int count = 4;
+  if (argc > 1)
+  {
+    count = 0;
+    for (int i = 1; i < argc && count < 16; i++)
+      sizes[count++] = strtoul(argv[i], nullptr, 10);
+  }
+
+  cout << "Transpose, double, GB/s" << endl;
+  cout << "n\tmemcpy\tnaive\tcopy\tin place" << endl;
+  for (int i = 0; i < count; i++)
+    bench<double>(sizes[i]);
+
+  return 0;
+}
+//---------------------------------------------------------------------------
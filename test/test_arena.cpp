@@ -0,0 +1,67 @@
+#include "tmatrix.h"
+
+#include <gtest.h>
+
+TEST(TArena, allocations_are_aligned_and_counted)
+{
+	TArena arena(1024);
+	void* p = arena.allocate(10);
+	void* q = arena.allocate(100, 8);
+	EXPECT_EQ(0u, reinterpret_cast<size_t>(p) % CACHE_LINE_SIZE);
+	EXPECT_EQ(0u, reinterpret_cast<size_t>(q) % 8);
+	EXPECT_NE(p, q);
+	EXPECT_EQ(2u, arena.allocations());
+	EXPECT_EQ(110u, arena.bytes_allocated());
+	EXPECT_EQ(1024u, arena.bytes_reserved());
+}
+
+TEST(TArena, large_request_gets_its_own_block)
+{
+	TArena arena(256);
+	char* p = static_cast<char*>(arena.allocate(1000));
+	p[999] = 1;
+	EXPECT_GE(arena.bytes_reserved(), 1000u);
+}
+
+TEST(TArena, reset_reuses_memory_without_new_blocks)
+{
+	TArena arena(4096);
+	void* first = arena.allocate(3000);
+	arena.allocate(3000);
+	const size_t reserved = arena.bytes_reserved();
+	arena.reset();
+	EXPECT_EQ(0u, arena.bytes_in_use());
+	EXPECT_EQ(first, arena.allocate(3000));
+	arena.allocate(3000);
+	EXPECT_EQ(reserved, arena.bytes_reserved());
+	EXPECT_EQ(6000u, arena.peak_bytes());
+}
+
+TEST(TArena, scope_releases_its_allocations_on_exit)
+{
+	TArena arena;
+	arena.allocate(64);
+	const size_t used = arena.bytes_in_use();
+	{
+		TArenaScope scope(arena);
+		EXPECT_EQ(&arena, TArena::current());
+		TArenaMatrix<double> a(10), b(10);
+		a.fill(1.0);
+		b.fill(2.0);
+		TArenaMatrix<double> c = a * b + a;
+		EXPECT_EQ(21.0, c[9][9]);
+		EXPECT_EQ(&arena, c.get_allocator().get_arena());
+		EXPECT_GT(arena.bytes_in_use(), used);
+	}
+	EXPECT_EQ(nullptr, TArena::current());
+	EXPECT_EQ(used, arena.bytes_in_use());
+}
+
+TEST(TArena, arena_containers_use_heap_outside_of_scope)
+{
+	TArenaVector<int> v(5);
+	v.fill(3);
+	TArenaVector<int> w = v + v;
+	EXPECT_EQ(nullptr, w.get_allocator().get_arena());
+	EXPECT_EQ(6, w[4]);
+}
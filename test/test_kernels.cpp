@@ -0,0 +1,86 @@
+#include "tmatrix.h"
+
+#include <gtest.h>
+
+template <typename T>
+class TestKernels : public ::testing::Test
+{
+public:
+	// длина не кратна ширине ни одного регистра, чтобы задеть хвосты
+	static const size_t n = 203;
+	T a[n], b[n];
+
+	void SetUp()
+	{
+		for (size_t i = 0; i < n; i++)
+		{
+			a[i] = T(int(i % 13) - 6);
+			b[i] = T(int(i % 7) - 3);
+		}
+	}
+	void TearDown()
+	{
+		kernels::set_simd_level(kernels::detect_simd_level());
+	}
+};
+
+TYPED_TEST_CASE_P(TestKernels);
+
+TYPED_TEST_P(TestKernels, every_simd_level_matches_scalar_vector_kernels)
+{
+	typedef TypeParam T;
+	const size_t n = this->n;
+	for (int level = kernels::SIMD_SCALAR; level <= kernels::detect_simd_level(); level++)
+	{
+		kernels::set_simd_level(kernels::TSimdLevel(level));
+		T c[n], y[n];
+		kernels::add(n, this->a, this->b, c);
+		for (size_t i = 0; i < n; i++)
+			ASSERT_EQ(this->a[i] + this->b[i], c[i]);
+		kernels::sub(n, this->a, this->b, c);
+		for (size_t i = 0; i < n; i++)
+			ASSERT_EQ(this->a[i] - this->b[i], c[i]);
+		kernels::scale(n, this->a, T(3), c);
+		for (size_t i = 0; i < n; i++)
+			ASSERT_EQ(this->a[i] * T(3), c[i]);
+		std::copy(this->b, this->b + n, y);
+		kernels::axpy(n, T(2), this->a, y);
+		for (size_t i = 0; i < n; i++)
+			ASSERT_EQ(this->b[i] + T(2) * this->a[i], y[i]);
+		ASSERT_EQ(kernels::scalar_dot(n, this->a, this->b), kernels::dot(n, this->a, this->b));
+		std::copy(this->b, this->b + n, y);
+		const T d = kernels::kernel_table<T>().dot_axpy(n, this->a, this->b, T(2), y);
+		ASSERT_EQ(kernels::scalar_dot(n, this->a, this->b), d);
+		for (size_t i = 0; i < n; i++)
+			ASSERT_EQ(this->b[i] + T(2) * this->a[i], y[i]);
+	}
+}
+
+TYPED_TEST_P(TestKernels, every_simd_level_gives_same_matrix_product)
+{
+	typedef TypeParam T;
+	const size_t size = 70;
+	TDynamicMatrix<T> a(size), b(size);
+	for (size_t i = 0; i < size; i++)
+		for (size_t j = 0; j < size; j++)
+		{
+			a[i][j] = T(int((i + 2 * j) % 5) - 2);
+			b[i][j] = T(int((3 * i + j) % 7) - 3);
+		}
+	kernels::set_simd_level(kernels::SIMD_SCALAR);
+	TDynamicMatrix<T> expected = a * b;
+	TDynamicVector<T> expectedv = a * TDynamicVector<T>(b[1]);
+	for (int level = kernels::SIMD_AVX2; level <= kernels::detect_simd_level(); level++)
+	{
+		kernels::set_simd_level(kernels::TSimdLevel(level));
+		EXPECT_EQ(expected, a * b);
+		EXPECT_EQ(expectedv, a * TDynamicVector<T>(b[1]));
+	}
+}
+
+REGISTER_TYPED_TEST_CASE_P(TestKernels, every_simd_level_matches_scalar_vector_kernels,
+	every_simd_level_gives_same_matrix_product);
+
+typedef ::testing::Types<float, double, int32_t, int64_t> KernelTypes;
+
+INSTANTIATE_TYPED_TEST_CASE_P(KernelTypesInstantiation, TestKernels, KernelTypes);
@@ -0,0 +1,125 @@
+#include "tanymatrix.h"
+
+#include <gtest.h>
+
+// матрица порядка n, в строке i - элементы в столбцах i, i + step, ...
+static TDynamicMatrix<double> striped(size_t n, size_t step)
+{
+	TDynamicMatrix<double> m(n);
+	for (size_t i = 0; i < n; i++)
+		for (size_t j = i % step; j < n; j += step)
+			m[i][j] = double(int((i + j) % 7) - 3) + 0.5;
+	return m;
+}
+
+// блочно-диагональная матрица с заполненными блоками b x b
+static TCOOBuilder<double> blocks(size_t n, size_t b)
+{
+	TCOOBuilder<double> res(n, n);
+	for (size_t i = 0; i < n; i++)
+		for (size_t j = i / b * b; j < (i / b + 1) * b; j++)
+			res.add(i, j, double(i + j + 1));
+	return res;
+}
+
+TEST(TAnyMatrix, keeps_dense_matrix_dense)
+{
+	TAnyMatrix<double> m(striped(40, 2));
+	EXPECT_EQ(TMatrixFormat::Dense, m.format());
+	EXPECT_DOUBLE_EQ(0.5, m.decision().density);
+	EXPECT_NE(nullptr, m.as_dense());
+	EXPECT_EQ(nullptr, m.as_csr());
+}
+
+TEST(TAnyMatrix, selects_csr_for_scattered_nonzeros)
+{
+	TAnyMatrix<double> m(striped(40, 10));
+	EXPECT_EQ(TMatrixFormat::CSR, m.format());
+	EXPECT_DOUBLE_EQ(0.1, m.decision().density);
+	EXPECT_NE(nullptr, m.as_csr());
+}
+
+TEST(TAnyMatrix, selects_bsr_for_filled_blocks)
+{
+	EXPECT_EQ(TMatrixFormat::BSR4, TAnyMatrix<double>(blocks(120, 4)).format());
+	TAnyMatrix<double> m3(blocks(120, 3));
+	EXPECT_EQ(TMatrixFormat::BSR3, m3.format());
+	EXPECT_DOUBLE_EQ(1.0, m3.decision().fill3);
+}
+
+TEST(TAnyMatrix, thresholds_are_tunable)
+{
+	TFormatPolicy policy;
+	policy.dense_density = 0.05;
+	EXPECT_EQ(TMatrixFormat::Dense, TAnyMatrix<double>(striped(40, 10), policy).format());
+	policy.dense_density = 0.9;
+	policy.block_fill = 1.1;
+	EXPECT_EQ(TMatrixFormat::CSR, TAnyMatrix<double>(blocks(120, 4), policy).format());
+}
+
+TEST(TAnyMatrix, large_matrix_is_never_dense)
+{
+	TCOOBuilder<double> b(MAX_MATRIX_SIZE * 2, MAX_MATRIX_SIZE * 2);
+	for (size_t i = 0; i < MAX_MATRIX_SIZE * 2; i++)
+		b.add(i, i, 1.0);
+	TFormatPolicy policy;
+	policy.dense_density = 0.0;
+	EXPECT_NE(TMatrixFormat::Dense, TAnyMatrix<double>(b, policy).format());
+}
+
+TEST(TAnyMatrix, decision_can_be_logged)
+{
+	std::ostringstream os;
+	os << TAnyMatrix<double>(striped(40, 10)).decision();
+	EXPECT_EQ(0u, os.str().find("csr (density 0.1"));
+}
+
+TEST(TAnyMatrix, product_with_vector_does_not_depend_on_format)
+{
+	const size_t steps[] = { 1, 3, 10 };
+	TDynamicVector<double> x(60);
+	for (size_t i = 0; i < 60; i++)
+		x[i] = double(i % 5) - 2.0;
+	for (size_t step : steps) {
+		TDynamicMatrix<double> d = striped(60, step);
+		EXPECT_EQ(d * x, TAnyMatrix<double>(d) * x);
+	}
+	TAnyMatrix<double> m(blocks(60, 4));
+	EXPECT_EQ(m.csr() * x, m * x);
+}
+
+TEST(TAnyMatrix, product_reselects_format)
+{
+	TAnyMatrix<double> a(striped(60, 2)), b(striped(60, 10));
+	TAnyMatrix<double> c = a * a;
+	EXPECT_EQ(TMatrixFormat::Dense, c.format());
+	EXPECT_EQ(TDynamicMatrix<double>(striped(60, 2) * striped(60, 2)), *c.as_dense());
+	TAnyMatrix<double> s = b * b;
+	EXPECT_EQ(TMatrixFormat::CSR, s.format());
+	EXPECT_EQ(TDynamicMatrix<double>(striped(60, 10) * striped(60, 10)), s.csr().dense());
+	TAnyMatrix<double> d(blocks(60, 4));
+	TAnyMatrix<double> e = d * d;
+	EXPECT_EQ(TMatrixFormat::BSR4, e.format());
+	EXPECT_EQ(TDynamicMatrix<double>(d.csr().dense() * d.csr().dense()), e.as_bsr4()->dense());
+}
+
+TEST(TAnyMatrix, moved_from_matrix_is_empty)
+{
+	TAnyMatrix<double> a(striped(20, 10));
+	EXPECT_EQ(TMatrixFormat::CSR, a.format());
+	TAnyMatrix<double> b(std::move(a));
+	EXPECT_EQ(TMatrixFormat::CSR, b.format());
+	EXPECT_TRUE(a.empty());
+	EXPECT_EQ(TMatrixFormat::Dense, a.format());
+	EXPECT_EQ(nullptr, a.as_dense());
+	TDynamicVector<double> x(20), y(20);
+	ASSERT_ANY_THROW(a.get(0, 0));
+	ASSERT_ANY_THROW(a.gemv(1.0, x, 0.0, y));
+	ASSERT_ANY_THROW(a * x);
+	ASSERT_ANY_THROW(a * b);
+	ASSERT_ANY_THROW(a.csr());
+	a = std::move(b);
+	EXPECT_EQ(TMatrixFormat::CSR, a.format());
+	EXPECT_TRUE(b.empty());
+	EXPECT_EQ(striped(20, 10)[3][13], a.get(3, 13));
+}
@@ -0,0 +1,169 @@
+#include "tbandmatrix.h"
+
+#include <sstream>
+#include <gtest.h>
+
+static TBandMatrix<double> band(size_t n, size_t kl, size_t ku, int seed)
+{
+	TBandMatrix<double> m(n, kl, ku);
+	for (size_t i = 0; i < n; i++)
+		for (size_t j = kernels::band_first(i, kl); j < kernels::band_last(n, i, ku); j++)
+			m[i][j] = double(int((i * 3 + j * 5 + seed) % 9) - 4);
+	return m;
+}
+
+TEST(TBandMatrix, can_create_band_matrix)
+{
+	ASSERT_NO_THROW(TBandMatrix<int> m(10, 2, 1));
+}
+
+TEST(TBandMatrix, cant_create_matrix_with_too_wide_band)
+{
+	ASSERT_ANY_THROW(TBandMatrix<int> m(3, 3, 0));
+	ASSERT_ANY_THROW(TBandMatrix<int> m(0, 0, 0));
+	ASSERT_ANY_THROW(TBandMatrix<int> m(MAX_VECTOR_SIZE, 1, 1));
+}
+
+TEST(TBandMatrix, can_be_larger_than_dense_matrix_limit)
+{
+	TBandMatrix<double> m(3 * MAX_MATRIX_SIZE, 1, 1);
+	EXPECT_EQ(9u * MAX_MATRIX_SIZE, m.count());
+}
+
+TEST(TBandMatrix, stores_only_band)
+{
+	TBandMatrix<int> m(5, 1, 2);
+	m[2][4] = 3;
+	m[3][2] = 4;
+	EXPECT_EQ(3, m.data()[2 * 4 + 3]);
+	EXPECT_EQ(4, m.data()[3 * 4 + 0]);
+	EXPECT_EQ(0, m.get(4, 0));
+	ASSERT_ANY_THROW(m.at(0).at(3));
+	ASSERT_ANY_THROW(m.at(3).at(1));
+}
+
+TEST(TBandMatrix, can_fill_and_read_band)
+{
+	TBandMatrix<int> m(4, 1, 1);
+	m.fill(5);
+	EXPECT_EQ(5, m.get(3, 2));
+	EXPECT_EQ(0, m.get(3, 1));
+	EXPECT_EQ(0, m.data()[0]);
+	std::istringstream in("1 2 3 4 5 6 7 8 9 10");
+	in >> m;
+	EXPECT_EQ(1, m[0][0]);
+	EXPECT_EQ(2, m[0][1]);
+	EXPECT_EQ(6, m[2][1]);
+	EXPECT_EQ(10, m[3][3]);
+	EXPECT_EQ(0, m.data()[0]);
+}
+
+TEST(TBandMatrix, uninitialized_matrix_has_zero_padding)
+{
+	const size_t n = 6, kl = 2, ku = 3;
+	{
+		// память, которую, вероятно, получит следующая матрица того же размера
+		TBandMatrix<double> g(n, kl, ku);
+		for (size_t k = 0; k < g.count(); k++)
+			g.data()[k] = 99.0;
+	}
+	TBandMatrix<double> a = band(n, kl, ku, 1), m(n, kl, ku, uninitialized);
+	for (size_t i = 0; i < n; i++)
+		for (size_t j = kernels::band_first(i, kl); j < kernels::band_last(n, i, ku); j++)
+			m[i][j] = a[i][j];
+	EXPECT_EQ(a, m);
+	EXPECT_EQ(0.0, m.data()[0]);
+	EXPECT_EQ(0.0, m.data()[(n - 1) * (kl + ku + 1) + kl + ku]);
+}
+
+TEST(TBandMatrix, converts_to_and_from_dense_matrix)
+{
+	TBandMatrix<double> m = band(12, 2, 3, 1);
+	TBandMatrix<double> copy(m.dense(), 2, 3);
+	EXPECT_EQ(m, copy);
+}
+
+TEST(TBandMatrix, can_add_and_scale)
+{
+	TBandMatrix<double> a = band(20, 2, 1, 1), b = band(20, 2, 1, 2);
+	TBandMatrix<double> c = a * 2.0 - b;
+	EXPECT_EQ(TDynamicMatrix<double>(a.dense() * 2.0 - b.dense()), c.dense());
+	c += b;
+	EXPECT_EQ(TDynamicMatrix<double>(a.dense() * 2.0), c.dense());
+}
+
+TEST(TBandMatrix, cant_combine_matrices_with_different_bands)
+{
+	TBandMatrix<double> a(10, 1, 2), b(10, 2, 1), c(10, 1, 1);
+	ASSERT_ANY_THROW(a + b);
+	ASSERT_ANY_THROW(a - c);
+}
+
+TEST(TBandMatrix, product_with_vector_matches_dense_one)
+{
+	const size_t bands[][2] = { { 0, 0 }, { 1, 1 }, { 2, 3 }, { 20, 9 } };
+	for (auto& kb : bands)
+	{
+		TBandMatrix<double> m = band(100, kb[0], kb[1], 3);
+		TDynamicVector<double> x(100);
+		for (size_t i = 0; i < 100; i++)
+			x[i] = double(int(i % 7) - 3);
+		EXPECT_EQ(m.dense() * x, m * x);
+	}
+}
+
+TEST(TBandMatrix, lu_solves_system_with_pivoting)
+{
+	const size_t n = 200;
+	TBandMatrix<double> m = band(n, 2, 3, 4);
+	// нулевая диагональ требует перестановок
+	for (size_t i = 0; i < n; i++)
+		m[i][i] = 0.0;
+	TDynamicVector<double> x(n);
+	for (size_t i = 0; i < n; i++)
+		x[i] = double(i % 5) + 1.0;
+	TDynamicVector<double> b = m * x;
+	TDynamicVector<double> res = solve(m, b);
+	for (size_t i = 0; i < n; i++)
+		ASSERT_NEAR(x[i], res[i], 1e-8);
+}
+
+TEST(TBandMatrix, lu_checks_size_of_factors)
+{
+	// лента помещается в MAX_VECTOR_SIZE, а расширенная для разложения - нет;
+	// элементы ленты не инициализируются (обнуляются только углы хранения)
+	const size_t kl = 999, n = MAX_VECTOR_SIZE / (kl + 1);
+	TBandMatrix<float> m(n, kl, 0, uninitialized);
+	ASSERT_THROW(TBandLU<float> lu(m), length_error);
+}
+
+TEST(TBandMatrix, lu_detects_singular_matrix)
+{
+	TBandMatrix<double> m(4, 1, 1);
+	ASSERT_ANY_THROW(TBandLU<double> lu(m));
+}
+
+TEST(TBandMatrix, thomas_solves_large_tridiagonal_system)
+{
+	const size_t n = 1000000;
+	TBandMatrix<double> m(n, 1, 1);
+	TDynamicVector<double> x(n);
+	for (size_t i = 0; i < n; i++)
+	{
+		if (i > 0)
+			m[i][i - 1] = -1.0;
+		m[i][i] = 4.0;
+		if (i + 1 < n)
+			m[i][i + 1] = -1.0;
+		x[i] = double(i % 10);
+	}
+	TDynamicVector<double> b = m * x;
+	TDynamicVector<double> res = thomas_solve(m, b);
+	TDynamicVector<double> lu = solve(m, b);
+	for (size_t i = 0; i < n; i++)
+	{
+		ASSERT_NEAR(x[i], res[i], 1e-9);
+		ASSERT_NEAR(x[i], lu[i], 1e-9);
+	}
+	ASSERT_ANY_THROW(thomas_solve(TBandMatrix<double>(5, 1, 2), TDynamicVector<double>(5)));
+}
@@ -0,0 +1,208 @@
+#include "tbinary.h"
+
+#include <cstdio>
+#include <gtest.h>
+
+static const char* const FILE_NAME = "test_tbinary.bin";
+
+static TRectMatrix<double> rect(size_t m, size_t n)
+{
+	TRectMatrix<double> a(m, n);
+	for (size_t i = 0; i < m; i++)
+		for (size_t j = 0; j < n; j++)
+			a[i][j] = double(i * n + j) / 4;
+	return a;
+}
+
+// изменение одного байта файла по смещению offset
+static void corrupt(size_t offset)
+{
+	TMappedFile f(FILE_NAME, MAPPED_READ_WRITE);
+	f.data()[offset] ^= 1;
+	f.sync();
+}
+
+TEST(TBinary, rect_matrix_round_trip)
+{
+	TRectMatrix<double> a = rect(37, 53);
+	save_binary(FILE_NAME, a);
+	EXPECT_EQ(a, load_rect_matrix<double>(FILE_NAME));
+	ASSERT_ANY_THROW(load_matrix<double>(FILE_NAME));
+	ASSERT_ANY_THROW(load_vector<double>(FILE_NAME));
+	std::remove(FILE_NAME);
+}
+
+TEST(TBinary, vector_and_square_matrix_round_trip)
+{
+	TDynamicVector<int32_t> v(1000);
+	for (size_t i = 0; i < v.size(); i++)
+		v[i] = int32_t(i) - 500;
+	save_binary(FILE_NAME, v);
+	EXPECT_EQ(v, load_vector<int32_t>(FILE_NAME));
+
+	TDynamicMatrix<float> m(20);
+	for (size_t i = 0; i < 20; i++)
+		for (size_t j = 0; j < 20; j++)
+			m[i][j] = float(i) - float(j) / 2;
+	save_binary(FILE_NAME, m, 64);
+	EXPECT_EQ(m, load_matrix<float>(FILE_NAME));
+	std::remove(FILE_NAME);
+}
+
+TEST(TBinary, header_describes_data)
+{
+	save_binary(FILE_NAME, rect(3, 5));
+	TMappedFile f(FILE_NAME);
+	const TBinaryHeader h = binary_header<double>(f, true);
+	EXPECT_EQ(BINARY_VERSION, h.version);
+	EXPECT_EQ(uint32_t(BINARY_FLOAT64), h.type);
+	EXPECT_EQ(uint32_t(BINARY_ROW_MAJOR), h.layout);
+	EXPECT_EQ(3u, h.rows);
+	EXPECT_EQ(5u, h.cols);
+	EXPECT_EQ(BINARY_ALIGNMENT, h.dataOffset);
+	EXPECT_EQ(h.dataOffset + 15 * sizeof(double), f.size());
+	ASSERT_ANY_THROW(save_binary(FILE_NAME, rect(3, 5), 100));
+	std::remove(FILE_NAME);
+}
+
+TEST(TBinary, cant_save_empty_data)
+{
+	const double x = 1.0;
+	ASSERT_ANY_THROW(save_binary(FILE_NAME, &x, 0, 1));
+	ASSERT_ANY_THROW(save_binary(FILE_NAME, &x, 1, 0));
+	std::remove(FILE_NAME);
+}
+
+TEST(TBinary, rejects_bad_alignment_in_header)
+{
+	const uint32_t bad[] = { 0, 96, 8192 };
+	for (uint32_t a : bad) {
+		save_binary(FILE_NAME, rect(4, 4));
+		{
+			TMappedFile f(FILE_NAME, MAPPED_READ_WRITE);
+			reinterpret_cast<TBinaryHeader*>(f.data())->alignment = a;
+			f.sync();
+		}
+		try {
+			load_matrix<double>(FILE_NAME, false);
+			ADD_FAILURE() << "alignment " << a << " is accepted";
+		}
+		catch (const std::runtime_error& e) {
+			EXPECT_STREQ("corrupted header", e.what());
+		}
+	}
+	std::remove(FILE_NAME);
+}
+
+TEST(TBinary, mapped_load_is_zero_copy)
+{
+	TRectMatrix<double> a = rect(40, 30);
+	save_binary(FILE_NAME, a);
+	{
+		auto f = std::make_shared<TMappedFile>(FILE_NAME, MAPPED_COPY_ON_WRITE);
+		const TRectMatrix<double, TMappedAllocator<double>> m = map_binary_matrix<double>(f, true);
+		EXPECT_EQ(reinterpret_cast<const double*>(f->data() + BINARY_ALIGNMENT), m.data());
+		EXPECT_EQ(a[39][29], m[39][29]);
+		TMatrixView<const double> v = map_binary_view<const double>(*f);
+		EXPECT_EQ(m.data(), v.data());
+		EXPECT_TRUE(v == a);
+		ASSERT_ANY_THROW(map_binary_view<double>(TMappedFile(FILE_NAME)));
+	}
+	std::remove(FILE_NAME);
+}
+
+TEST(TBinary, mapped_matrix_needs_writable_mapping)
+{
+	TRectMatrix<double> a = rect(8, 6);
+	save_binary(FILE_NAME, a);
+	ASSERT_THROW(map_binary_matrix<double>(std::make_shared<TMappedFile>(FILE_NAME)), logic_error);
+	{
+		// копирование при записи: изменения не попадают в файл
+		TRectMatrix<double, TMappedAllocator<double>> m = map_binary_matrix<double>(FILE_NAME, true);
+		m *= 2.0;
+		EXPECT_EQ(2.0 * a[7][5], m[7][5]);
+	}
+	EXPECT_EQ(a, load_rect_matrix<double>(FILE_NAME));
+	std::remove(FILE_NAME);
+}
+
+TEST(TBinary, rejects_wrong_type_and_corrupted_files)
+{
+	save_binary(FILE_NAME, rect(10, 10));
+	ASSERT_ANY_THROW(load_matrix<float>(FILE_NAME));
+	ASSERT_ANY_THROW(load_matrix<int64_t>(FILE_NAME));
+	EXPECT_NO_THROW(load_matrix<double>(FILE_NAME));
+
+	corrupt(BINARY_ALIGNMENT + 17);
+	ASSERT_ANY_THROW(load_matrix<double>(FILE_NAME));
+	EXPECT_NO_THROW(load_matrix<double>(FILE_NAME, false));
+	{
+		auto f = std::make_shared<TMappedFile>(FILE_NAME, MAPPED_COPY_ON_WRITE);
+		EXPECT_NO_THROW(map_binary_matrix<double>(f));
+		ASSERT_ANY_THROW(map_binary_matrix<double>(f, true));
+	}
+
+	corrupt(offsetof(TBinaryHeader, version));
+	ASSERT_ANY_THROW(load_matrix<double>(FILE_NAME, false));
+	corrupt(offsetof(TBinaryHeader, version));
+	corrupt(0);
+	ASSERT_ANY_THROW(load_matrix<double>(FILE_NAME, false));
+	std::remove(FILE_NAME);
+	ASSERT_ANY_THROW(load_matrix<double>(FILE_NAME));
+}
+
+TEST(TBinary, checksum_covers_tail_of_data)
+{
+	// 7 чисел - 56 байт: 24 байта за последним полным 32-байтовым блоком
+	TDynamicVector<double> v(7);
+	for (size_t i = 0; i < v.size(); i++)
+		v[i] = double(i + 1);
+	TDynamicVector<double> r(7);
+	for (size_t i = 0; i < r.size(); i++)
+		r[i] = v[6 - i];
+	EXPECT_NE(kernels::checksum(v.data(), 56), kernels::checksum(r.data(), 56));
+	const double a[3] = { 1.0, 0.0, 0.0 }, b[3] = { 0.0, 0.0, 1.0 };
+	EXPECT_NE(kernels::checksum(a, sizeof(a)), kernels::checksum(b, sizeof(b)));
+
+	save_binary(FILE_NAME, v);
+	corrupt(BINARY_ALIGNMENT + 32 + 9);
+	try {
+		load_vector<double>(FILE_NAME);
+		ADD_FAILURE() << "corrupted tail is not detected";
+	}
+	catch (const std::runtime_error& e) {
+		EXPECT_STREQ("checksum mismatch", e.what());
+	}
+	std::remove(FILE_NAME);
+}
+
+TEST(TBinary, rejects_truncated_file)
+{
+	save_binary(FILE_NAME, rect(10, 10));
+	{
+		TMappedFile f(FILE_NAME, MAPPED_READ_WRITE);
+		TBinaryHeader* h = reinterpret_cast<TBinaryHeader*>(f.data());
+		h->rows = 11;
+		f.sync();
+	}
+	ASSERT_ANY_THROW(load_rect_matrix<double>(FILE_NAME, false));
+	std::remove(FILE_NAME);
+}
+
+TEST(TBinary, checksum_does_not_depend_on_threads)
+{
+	TThreadPool& pool = TThreadPool::instance();
+	const size_t saved = pool.num_threads();
+	std::vector<unsigned char> data(5 * kernels::CHECKSUM_BLOCK + 123);
+	for (size_t i = 0; i < data.size(); i++)
+		data[i] = static_cast<unsigned char>(i * 31 + i / 7);
+	pool.set_num_threads(1);
+	const uint64_t s1 = kernels::checksum(data.data(), data.size());
+	pool.set_num_threads(4);
+	const uint64_t s4 = kernels::checksum(data.data(), data.size());
+	pool.set_num_threads(saved);
+	EXPECT_EQ(s1, s4);
+	data[3 * kernels::CHECKSUM_BLOCK] ^= 0x80;
+	EXPECT_NE(s1, kernels::checksum(data.data(), data.size()));
+	EXPECT_NE(kernels::checksum(data.data(), 8), kernels::checksum(data.data(), 9));
+}
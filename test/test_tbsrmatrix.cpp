@@ -0,0 +1,82 @@
+#include "tbsrmatrix.h"
+
+#include <gtest.h>
+
+// блочно-трёхдиагональная матрица с заполненными блоками 3 x 3
+static TDynamicMatrix<double> fem(size_t nb)
+{
+	TDynamicMatrix<double> m(nb * 3);
+	for (size_t i = 0; i < nb; i++)
+		for (size_t j = i > 0 ? i - 1 : 0; j < nb && j <= i + 1; j++)
+			for (size_t r = 0; r < 3; r++)
+				for (size_t c = 0; c < 3; c++)
+					m[i * 3 + r][j * 3 + c] = double(int((i * 7 + j * 3 + r * 5 + c) % 9) - 4);
+	return m;
+}
+
+TEST(TBSRMatrix, size_should_be_multiple_of_block_size)
+{
+	ASSERT_NO_THROW((TBSRMatrix<double, 4>(8, 12)));
+	ASSERT_ANY_THROW((TBSRMatrix<double, 4>(8, 10)));
+	ASSERT_ANY_THROW((TBSRMatrix<double, 3>(0)));
+}
+
+TEST(TBSRMatrix, keeps_only_nonzero_blocks)
+{
+	TDynamicMatrix<double> d = fem(10);
+	TBSRMatrix<double, 3> m(d);
+	EXPECT_EQ(28u, m.nonzero_blocks());
+	EXPECT_EQ(d, m.dense());
+	for (size_t i = 0; i < 30; i++)
+		for (size_t j = 0; j < 30; j++)
+			ASSERT_EQ(d[i][j], m.get(i, j));
+}
+
+TEST(TBSRMatrix, converts_to_and_from_csr)
+{
+	TDynamicMatrix<double> d = fem(8);
+	TCSRMatrix<double> csr(d);
+	TBSRMatrix<double, 3> m(csr);
+	EXPECT_EQ(d, m.dense());
+	EXPECT_EQ(csr, m.csr());
+	// блоки 4 x 4 по той же матрице захватывают соседние блоки 3 x 3
+	TBSRMatrix<double, 4> m4(csr);
+	EXPECT_EQ(d, m4.dense());
+}
+
+TEST(TBSRMatrix, product_with_vector_matches_dense_one)
+{
+	TDynamicMatrix<double> d = fem(20);
+	TBSRMatrix<double, 3> m(d);
+	TDynamicVector<double> x(60), y(60);
+	for (size_t i = 0; i < 60; i++) {
+		x[i] = double(i % 7) - 3.0;
+		y[i] = 1.0;
+	}
+	EXPECT_EQ(d * x, m * x);
+	TDynamicVector<double> ref = d * x * 2.0 + y;
+	spmv(2.0, m, x, 1.0, y);
+	EXPECT_EQ(ref, y);
+	ASSERT_ANY_THROW(m * TDynamicVector<double>(59));
+}
+
+TEST(TBSRMatrix, parallel_product_matches_csr_one)
+{
+	const size_t saved = TThreadPool::instance().num_threads();
+	const size_t nb = 30000;
+	TCOOBuilder<double> b(nb * 4, nb * 4);
+	for (size_t i = 0; i < nb; i++)
+		for (size_t j = i > 0 ? i - 1 : 0; j < nb && j <= i + 1; j++)
+			for (size_t r = 0; r < 4; r++)
+				for (size_t c = 0; c < 4; c++)
+					b.add(i * 4 + r, j * 4 + c, double(int((i + j * 3 + r * 5 + c) % 9) - 4));
+	TCSRMatrix<double> csr(b);
+	TBSRMatrix<double, 4> m(csr);
+	TDynamicVector<double> x(nb * 4);
+	for (size_t i = 0; i < nb * 4; i++)
+		x[i] = double(i % 5) - 2.0;
+	TThreadPool::instance().set_num_threads(4);
+	TDynamicVector<double> res = m * x;
+	TThreadPool::instance().set_num_threads(saved);
+	EXPECT_EQ(csr * x, res);
+}
@@ -0,0 +1,213 @@
+#include "tcsrmatrix.h"
+
+#include <gtest.h>
+
+// разреженная матрица: в строке i около i % 7 элементов, строка 3 - плотная
+static TCOOBuilder<double> sparse(size_t rows, size_t cols)
+{
+	TCOOBuilder<double> b(rows, cols);
+	for (size_t i = 0; i < rows; i++) {
+		const size_t cnt = i == 3 ? cols : i % 7;
+		for (size_t k = 0; k < cnt; k++)
+			b.add(i, (i * 13 + k * 101) % cols, double(int((i + k) % 9) - 4));
+	}
+	return b;
+}
+
+TEST(TCSRMatrix, can_create_rectangular_matrix)
+{
+	TCSRMatrix<double> m(3, 5);
+	EXPECT_EQ(3u, m.rows());
+	EXPECT_EQ(5u, m.cols());
+	EXPECT_EQ(0u, m.nonzeros());
+	EXPECT_EQ(0.0, m.get(2, 4));
+}
+
+TEST(TCSRMatrix, can_be_larger_than_dense_matrix_limit)
+{
+	TCOOBuilder<double> b(MAX_MATRIX_SIZE * 100, MAX_MATRIX_SIZE * 100);
+	b.add(MAX_MATRIX_SIZE * 100 - 1, 5, 1.0);
+	TCSRMatrix<double> m(b);
+	EXPECT_EQ(1u, m.nonzeros());
+	EXPECT_EQ(1.0, m.get(MAX_MATRIX_SIZE * 100 - 1, 5));
+}
+
+TEST(TCSRMatrix, builder_checks_indices)
+{
+	TCOOBuilder<int> b(3, 4);
+	ASSERT_ANY_THROW(b.add(3, 0, 1));
+	ASSERT_ANY_THROW(b.add(0, 4, 1));
+	ASSERT_ANY_THROW(TCOOBuilder<int>(0, 4));
+}
+
+TEST(TCSRMatrix, builder_sorts_and_sums_duplicates)
+{
+	TCOOBuilder<int> b(3, 4);
+	b.add(2, 3, 1);
+	b.add(0, 2, 5);
+	b.add(2, 0, 7);
+	b.add(0, 2, -2);
+	b.add(2, 3, 4);
+	TCSRMatrix<int> m(b);
+	EXPECT_EQ(3u, m.nonzeros());
+	const size_t ptr[] = { 0, 1, 1, 3 };
+	const uint32_t ind[] = { 2, 0, 3 };
+	const int val[] = { 3, 7, 5 };
+	for (size_t i = 0; i < 4; i++)
+		EXPECT_EQ(ptr[i], m.row_ptr()[i]);
+	for (size_t k = 0; k < 3; k++) {
+		EXPECT_EQ(ind[k], m.col_index()[k]);
+		EXPECT_EQ(val[k], m.values()[k]);
+	}
+}
+
+TEST(TCSRMatrix, converts_to_and_from_dense_matrix)
+{
+	TCSRMatrix<double> m(sparse(50, 50));
+	TDynamicMatrix<double> d = m.dense();
+	for (size_t i = 0; i < 50; i++)
+		for (size_t j = 0; j < 50; j++)
+			EXPECT_EQ(d[i][j], m.get(i, j));
+	TCSRMatrix<double> copy(d);
+	EXPECT_EQ(d, copy.dense());
+	EXPECT_EQ(copy, TCSRMatrix<double>(copy.dense()));
+	ASSERT_ANY_THROW(TCSRMatrix<double>(3, 4).dense());
+}
+
+TEST(TCSRMatrix, product_with_vector_matches_dense_one)
+{
+	TCSRMatrix<double> m(sparse(60, 60));
+	TDynamicVector<double> x(60);
+	for (size_t i = 0; i < 60; i++)
+		x[i] = double(i % 5) - 2.0;
+	EXPECT_EQ(m.dense() * x, m * x);
+}
+
+TEST(TCSRMatrix, rectangular_product_with_vector)
+{
+	TCOOBuilder<int> b(2, 3);
+	b.add(0, 0, 1);
+	b.add(0, 2, 2);
+	b.add(1, 1, 3);
+	TCSRMatrix<int> m(b);
+	TDynamicVector<int> x(3), y(2);
+	x[0] = 1; x[1] = 2; x[2] = 3;
+	y[0] = 7; y[1] = 8;
+	TDynamicVector<int> res = m * x;
+	EXPECT_EQ(7, res[0]);
+	EXPECT_EQ(6, res[1]);
+	spmv(2, m, x, -1, y);
+	EXPECT_EQ(7, y[0]);
+	EXPECT_EQ(4, y[1]);
+	ASSERT_ANY_THROW(m * y);
+}
+
+TEST(TCSRMatrix, can_scale)
+{
+	TCSRMatrix<double> m(sparse(20, 30));
+	TCSRMatrix<double> s(m);
+	s *= 2.0;
+	for (size_t k = 0; k < m.nonzeros(); k++)
+		EXPECT_EQ(2.0 * m.values()[k], s.values()[k]);
+}
+
+TEST(TCSRMatrix, partition_balances_nonzeros)
+{
+	// одна строка содержит почти все элементы
+	std::vector<size_t> ptr(1001);
+	for (size_t i = 0; i <= 1000; i++)
+		ptr[i] = i <= 500 ? i : i + 100000;
+	size_t bound[5];
+	kernels::csr_partition(1000, ptr.data(), 4, bound);
+	EXPECT_EQ(0u, bound[0]);
+	EXPECT_EQ(1000u, bound[4]);
+	for (size_t p = 0; p < 4; p++)
+		EXPECT_LE(bound[p], bound[p + 1]);
+	// тяжёлая строка 500 - граница, части вне её малы
+	EXPECT_EQ(501u, bound[1]);
+}
+
+TEST(TCSRMatrix, parallel_product_matches_serial_one)
+{
+	const size_t saved = TThreadPool::instance().num_threads();
+	TCSRMatrix<double> m(sparse(100000, 3000));
+	TDynamicVector<double> x(3000);
+	for (size_t i = 0; i < 3000; i++)
+		x[i] = double(i % 11) - 5.0;
+	TThreadPool::instance().set_num_threads(1);
+	TDynamicVector<double> serial = m * x;
+	TThreadPool::instance().set_num_threads(4);
+	TDynamicVector<double> parallel = m * x;
+	TThreadPool::instance().set_num_threads(saved);
+	EXPECT_EQ(serial, parallel);
+	double s = 0.0;
+	for (size_t k = m.row_ptr()[3]; k < m.row_ptr()[4]; k++)
+		s += m.values()[k] * x[m.col_index()[k]];
+	EXPECT_EQ(s, serial[3]);
+}
+
+TEST(TCSRMatrix, sparse_product_matches_dense_one)
+{
+	TCSRMatrix<double> a(sparse(70, 70)), b(sparse(70, 70));
+	TCSRMatrix<double> c = a * b;
+	EXPECT_EQ(TDynamicMatrix<double>(a.dense() * b.dense()), c.dense());
+	for (size_t i = 0; i < c.rows(); i++)
+		for (size_t k = c.row_ptr()[i] + 1; k < c.row_ptr()[i + 1]; k++)
+			ASSERT_LT(c.col_index()[k - 1], c.col_index()[k]);
+}
+
+TEST(TCSRMatrix, rectangular_sparse_product)
+{
+	TCOOBuilder<int> ba(2, 3), bb(3, 4);
+	ba.add(0, 0, 1);
+	ba.add(0, 2, 2);
+	ba.add(1, 1, 3);
+	bb.add(0, 3, 4);
+	bb.add(2, 3, 5);
+	bb.add(2, 0, 6);
+	TCSRMatrix<int> c = TCSRMatrix<int>(ba) * TCSRMatrix<int>(bb);
+	EXPECT_EQ(2u, c.rows());
+	EXPECT_EQ(4u, c.cols());
+	EXPECT_EQ(2u, c.nonzeros());
+	EXPECT_EQ(12, c.get(0, 0));
+	EXPECT_EQ(14, c.get(0, 3));
+	EXPECT_EQ(0, c.get(1, 3));
+	ASSERT_ANY_THROW(TCSRMatrix<int>(bb) * TCSRMatrix<int>(bb));
+}
+
+TEST(TCSRMatrix, hash_accumulator_gives_same_product)
+{
+	// столбцов больше порога плотного аккумулятора
+	const size_t n = kernels::TSpAccumulator<double, uint32_t>::DENSE_COLUMNS + 5;
+	TCOOBuilder<double> ba(200, 200), bb(200, n), bd(200, 200);
+	for (size_t i = 0; i < 200; i++)
+		for (size_t k = 0; k < 5; k++) {
+			ba.add(i, (i * 7 + k * 31) % 200, double(k + 1));
+			bb.add(i, (i * 1009 + k * 65537) % n, double(int(i % 5) - 2));
+			bd.add(i, (i * 1009 + k * 65537) % n % 200, double(int(i % 5) - 2));
+		}
+	TCSRMatrix<double> a(ba), b(bb);
+	TCSRMatrix<double> c = a * b;
+	// та же задача со сжатыми столбцами считается плотным аккумулятором
+	TCSRMatrix<double> d = a * TCSRMatrix<double>(bd);
+	TDynamicMatrix<double> ref(a.dense() * TCSRMatrix<double>(bd).dense());
+	EXPECT_EQ(ref, d.dense());
+	// свёртка столбцов результата даёт тот же ответ
+	TDynamicMatrix<double> folded(200);
+	for (size_t i = 0; i < 200; i++)
+		for (size_t k = c.row_ptr()[i]; k < c.row_ptr()[i + 1]; k++)
+			folded[i][c.col_index()[k] % 200] += c.values()[k];
+	EXPECT_EQ(ref, folded);
+}
+
+TEST(TCSRMatrix, parallel_sparse_product_matches_serial_one)
+{
+	const size_t saved = TThreadPool::instance().num_threads();
+	TCSRMatrix<double> a(sparse(20000, 20000)), b(sparse(20000, 20000));
+	TThreadPool::instance().set_num_threads(1);
+	TCSRMatrix<double> serial = a * b;
+	TThreadPool::instance().set_num_threads(4);
+	TCSRMatrix<double> parallel = a * b;
+	TThreadPool::instance().set_num_threads(saved);
+	EXPECT_EQ(serial, parallel);
+}
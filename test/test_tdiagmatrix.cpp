@@ -0,0 +1,93 @@
+#include "tdiagmatrix.h"
+
+#include <gtest.h>
+
+static TDynamicMatrix<double> full(size_t n, int seed)
+{
+	TDynamicMatrix<double> m(n);
+	for (size_t i = 0; i < n; i++)
+		for (size_t j = 0; j < n; j++)
+			m[i][j] = double(int((i * 7 + j * 3 + seed) % 11) - 5);
+	return m;
+}
+
+static TDiagonalMatrix<double> diag(size_t n, int seed)
+{
+	TDiagonalMatrix<double> d(n);
+	for (size_t i = 0; i < n; i++)
+		d[i] = double(int((i + seed) % 5) - 2);
+	return d;
+}
+
+TEST(TDiagonalMatrix, stores_only_diagonal)
+{
+	TDiagonalMatrix<int> d(4);
+	d[2] = 5;
+	EXPECT_EQ(4u, d.count());
+	EXPECT_EQ(5, d.get(2, 2));
+	EXPECT_EQ(0, d.get(2, 3));
+	ASSERT_ANY_THROW(d.get(4, 0));
+	ASSERT_ANY_THROW(d.at(4));
+}
+
+TEST(TDiagonalMatrix, can_add_and_scale)
+{
+	TDiagonalMatrix<double> a = diag(10, 1), b = diag(10, 2);
+	TDiagonalMatrix<double> c = a * 3.0 - b;
+	EXPECT_EQ(TDynamicMatrix<double>(a.dense() * 3.0 - b.dense()), c.dense());
+	ASSERT_ANY_THROW(a + diag(11, 0));
+}
+
+TEST(TDiagonalMatrix, products_match_dense_ones)
+{
+	const size_t n = 30;
+	TDiagonalMatrix<double> d = diag(n, 3), e = diag(n, 4);
+	TDynamicMatrix<double> a = full(n, 1);
+	TDynamicVector<double> x(n);
+	for (size_t i = 0; i < n; i++)
+		x[i] = double(i % 4) + 1.0;
+	EXPECT_EQ(d.dense() * x, d * x);
+	EXPECT_EQ(TDynamicMatrix<double>(d.dense() * a), d * a);
+	EXPECT_EQ(TDynamicMatrix<double>(a * d.dense()), a * d);
+	EXPECT_EQ(TDynamicMatrix<double>(d.dense() * e.dense()), (d * e).dense());
+	EXPECT_EQ(TDynamicMatrix<double>((a + a) * d.dense()), (a + a) * d);
+	ASSERT_ANY_THROW(d * full(n + 1, 0));
+}
+
+TEST(TDiagonalMatrix, parallel_scaling_matches_serial_one)
+{
+	const size_t saved = TThreadPool::instance().num_threads();
+	TDiagonalMatrix<double> d = diag(600, 1);
+	TDynamicMatrix<double> a = full(600, 2);
+	TThreadPool::instance().set_num_threads(1);
+	TDynamicMatrix<double> r1 = d * a, c1 = a * d;
+	TThreadPool::instance().set_num_threads(4);
+	TDynamicMatrix<double> r4 = d * a, c4 = a * d;
+	TThreadPool::instance().set_num_threads(saved);
+	EXPECT_EQ(r1, r4);
+	EXPECT_EQ(c1, c4);
+}
+
+TEST(TIdentityMatrix, product_returns_copy_of_operand)
+{
+	TIdentityMatrix e(20);
+	TDynamicMatrix<double> a = full(20, 3);
+	TDynamicVector<double> x(20);
+	x[7] = 2.0;
+	EXPECT_EQ(a, e * a);
+	EXPECT_EQ(a, a * e);
+	EXPECT_EQ(TDynamicMatrix<double>(a + a), e * (a + a));
+	EXPECT_EQ(x, e * x);
+	EXPECT_EQ(e.dense<double>(), e.diagonal<double>().dense());
+	ASSERT_ANY_THROW(TIdentityMatrix(3) * x);
+}
+
+TEST(TIdentityMatrix, get_returns_element_type)
+{
+	TIdentityMatrix e(4);
+	EXPECT_EQ(1.0, e.get(2, 2));
+	EXPECT_EQ(0.0, e.get(2, 3));
+	EXPECT_TRUE((std::is_same<float, decltype(e.get<float>(0, 0))>::value));
+	EXPECT_EQ(1.0f, e.get<float>(3, 3));
+	ASSERT_ANY_THROW(e.get(4, 0));
+}
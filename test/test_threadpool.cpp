@@ -0,0 +1,90 @@
+#include "tmatrix.h"
+
+#include <gtest.h>
+
+class TestThreadPool : public ::testing::Test
+{
+public:
+	size_t saved;
+	void SetUp()
+	{
+		saved = TThreadPool::instance().num_threads();
+		TThreadPool::instance().set_num_threads(4);
+	}
+	void TearDown()
+	{
+		TThreadPool::instance().set_num_threads(saved);
+	}
+};
+
+TEST_F(TestThreadPool, parallel_for_covers_range_exactly_once)
+{
+	const size_t n = 10007;
+	std::vector<std::atomic<int>> hits(n);
+	for (size_t i = 0; i < n; i++)
+		hits[i] = 0;
+	TThreadPool::instance().parallel_for(0, n, 64, [&](size_t b, size_t e) {
+		EXPECT_EQ(0u, b % 64);
+		for (size_t i = b; i < e; i++)
+			hits[i]++;
+	});
+	for (size_t i = 0; i < n; i++)
+		ASSERT_EQ(1, hits[i]);
+}
+
+TEST_F(TestThreadPool, nested_parallel_for_does_not_deadlock)
+{
+	std::atomic<size_t> total(0);
+	TThreadPool::instance().parallel_for(0, 16, 1, [&](size_t b, size_t e) {
+		for (size_t i = b; i < e; i++)
+			TThreadPool::instance().parallel_for(0, 1000, 10, [&](size_t ib, size_t ie) {
+				total += ie - ib;
+			});
+	});
+	EXPECT_EQ(16000u, total);
+}
+
+TEST_F(TestThreadPool, exception_in_task_is_rethrown_to_caller)
+{
+	ASSERT_ANY_THROW(TThreadPool::instance().parallel_for(0, 1000, 1, [](size_t b, size_t) {
+		if (b == 500)
+			throw logic_error("task failed");
+	}));
+}
+
+TEST_F(TestThreadPool, parallel_vector_operations_match_serial_ones)
+{
+	const size_t n = PARALLEL_MIN_ELEMENTS * 3 + 5;
+	TDynamicVector<int> a(n), b(n);
+	for (size_t i = 0; i < n; i++)
+	{
+		a[i] = int(i % 17) - 8;
+		b[i] = int(i % 5) - 2;
+	}
+	TDynamicVector<int> sum = a + b;
+	int dot = 0;
+	for (size_t i = 0; i < n; i++)
+	{
+		ASSERT_EQ(a[i] + b[i], sum[i]);
+		dot += a[i] * b[i];
+	}
+	EXPECT_EQ(dot, a * b);
+}
+
+TEST_F(TestThreadPool, parallel_matrix_product_matches_serial_one)
+{
+	const size_t size = 200;
+	TDynamicMatrix<double> a(size), b(size);
+	for (size_t i = 0; i < size; i++)
+		for (size_t j = 0; j < size; j++)
+		{
+			a[i][j] = double(int((i + j) % 7) - 3);
+			b[i][j] = double(int((i * j) % 5) - 2);
+		}
+	TThreadPool::instance().set_num_threads(1);
+	TDynamicMatrix<double> expected = a * b;
+	TDynamicVector<double> expectedv = a * TDynamicVector<double>(b[0]);
+	TThreadPool::instance().set_num_threads(4);
+	EXPECT_EQ(expected, a * b);
+	EXPECT_EQ(expectedv, a * TDynamicVector<double>(b[0]));
+}
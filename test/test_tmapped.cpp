@@ -0,0 +1,167 @@
+#include "tmapped.h"
+
+#include <cstdio>
+#include <gtest.h>
+
+static const char* const FILE_NAME = "test_tmapped.bin";
+
+// файл из n элементов double со значениями 0, 1, ..., n - 1
+static void write_file(size_t n)
+{
+	TMappedFile f(FILE_NAME, n * sizeof(double));
+	double* p = reinterpret_cast<double*>(f.data());
+	for (size_t i = 0; i < n; i++)
+		p[i] = double(i);
+	f.sync();
+}
+
+TEST(TMappedFile, can_create_and_reopen_file)
+{
+	write_file(100);
+	{
+		TMappedFile f(FILE_NAME);
+		EXPECT_EQ(100 * sizeof(double), f.size());
+		EXPECT_EQ(MAPPED_READ_ONLY, f.mode());
+		EXPECT_EQ(42.0, reinterpret_cast<const double*>(f.data())[42]);
+		f.advise(ADVICE_SEQUENTIAL);
+		f.advise(ADVICE_WILL_NEED, 100, 200);
+		ASSERT_ANY_THROW(f.advise(ADVICE_RANDOM, f.size()));
+	}
+	std::remove(FILE_NAME);
+}
+
+TEST(TMappedFile, throws_when_file_is_missing)
+{
+	ASSERT_ANY_THROW(TMappedFile("no_such_file_for_tmapped.bin"));
+}
+
+TEST(TMappedFile, rejected_size_keeps_existing_file)
+{
+	write_file(10);
+	ASSERT_THROW(TMappedFile(FILE_NAME, size_t(0)), std::length_error);
+	{
+		TMappedFile f(FILE_NAME);
+		EXPECT_EQ(10 * sizeof(double), f.size());
+		EXPECT_EQ(9.0, reinterpret_cast<const double*>(f.data())[9]);
+	}
+	std::remove(FILE_NAME);
+}
+
+TEST(TMappedFile, vector_uses_file_memory)
+{
+	write_file(64);
+	{
+		auto f = std::make_shared<TMappedFile>(FILE_NAME, MAPPED_READ_WRITE, true);
+		TDynamicVector<double, TMappedAllocator<double>> v = map_vector<double>(f, 32, 16 * sizeof(double));
+		EXPECT_EQ(reinterpret_cast<double*>(f->data()) + 16, v.data());
+		EXPECT_EQ(16.0, v[0]);
+		EXPECT_EQ(47.0, v[31]);
+		v *= 2.0;
+		// копия получает обычную память
+		TDynamicVector<double, TMappedAllocator<double>> c(v);
+		EXPECT_NE(v.data(), c.data());
+		c[0] = -1.0;
+		EXPECT_EQ(32.0, v[0]);
+		ASSERT_ANY_THROW(map_vector<double>(f, 65));
+		f->sync();
+	}
+	{
+		auto f = std::make_shared<TMappedFile>(FILE_NAME, MAPPED_COPY_ON_WRITE);
+		const TDynamicVector<double, TMappedAllocator<double>> v = map_vector<double>(f, 64);
+		EXPECT_EQ(15.0, v[15]);
+		EXPECT_EQ(32.0, v[16]);
+		EXPECT_EQ(94.0, v[47]);
+		EXPECT_EQ(48.0, v[48]);
+	}
+	std::remove(FILE_NAME);
+}
+
+TEST(TMappedFile, containers_need_writable_mapping)
+{
+	write_file(16);
+	{
+		auto f = std::make_shared<TMappedFile>(FILE_NAME);
+		ASSERT_THROW(map_vector<double>(f, 16), logic_error);
+		ASSERT_THROW(map_matrix<double>(f, 4), logic_error);
+		ASSERT_THROW(map_rect_matrix<double>(f, 2, 8), logic_error);
+		ASSERT_THROW(TMappedAllocator<double> a(f), logic_error);
+		EXPECT_NO_THROW(map_view<const double>(*f, 4, 4));
+	}
+	std::remove(FILE_NAME);
+}
+
+TEST(TMappedFile, copies_never_reach_file)
+{
+	write_file(16);
+	{
+		auto f = std::make_shared<TMappedFile>(FILE_NAME, MAPPED_READ_WRITE);
+		const double* file = reinterpret_cast<const double*>(f->data());
+		TDynamicVector<double, TMappedAllocator<double>>* v =
+			new TDynamicVector<double, TMappedAllocator<double>>(map_vector<double>(f, 16));
+		TDynamicVector<double, TMappedAllocator<double>> c(*v);
+		EXPECT_EQ(nullptr, c.get_allocator().file());
+		// участок файла освобождён, но больше не выдаётся
+		TMappedAllocator<double> a = v->get_allocator();
+		delete v;
+		TDynamicVector<double, TMappedAllocator<double>> w(8, a);
+		EXPECT_NE(file, w.data());
+		w.fill(-1.0);
+		EXPECT_EQ(3.0, file[3]);
+	}
+	std::remove(FILE_NAME);
+}
+
+TEST(TMappedFile, copy_on_write_does_not_change_file)
+{
+	write_file(16);
+	{
+		auto f = std::make_shared<TMappedFile>(FILE_NAME, MAPPED_COPY_ON_WRITE);
+		TDynamicVector<double, TMappedAllocator<double>> v = map_vector<double>(f, 16);
+		v.fill(7.0);
+		EXPECT_EQ(7.0, v[3]);
+	}
+	{
+		TMappedFile f(FILE_NAME);
+		EXPECT_EQ(3.0, reinterpret_cast<const double*>(f.data())[3]);
+	}
+	std::remove(FILE_NAME);
+}
+
+TEST(TMappedFile, matrices_over_file_take_part_in_products)
+{
+	const size_t n = 20;
+	write_file(2 * n * n);
+	{
+		auto f = std::make_shared<TMappedFile>(FILE_NAME, MAPPED_COPY_ON_WRITE);
+		const TDynamicMatrix<double, TMappedAllocator<double>> a = map_matrix<double>(f, n);
+		const TRectMatrix<double, TMappedAllocator<double>> r = map_rect_matrix<double>(f, n, 2 * n);
+		TDynamicMatrix<double> b(n);
+		for (size_t i = 0; i < n; i++)
+			for (size_t j = 0; j < n; j++)
+				b[i][j] = double(i * n + j);
+		EXPECT_EQ(b * b, TDynamicMatrix<double>(a * a));
+		EXPECT_EQ(double(n + 1), r[0][n + 1]);
+		EXPECT_EQ(double(2 * n * n - 1), r[n - 1][2 * n - 1]);
+		ASSERT_ANY_THROW(map_matrix<double>(f, 2 * n));
+	}
+	std::remove(FILE_NAME);
+}
+
+TEST(TMappedFile, view_over_file_is_zero_copy)
+{
+	write_file(1000);
+	{
+		TMappedFile f(FILE_NAME);
+		TMatrixView<const double> v = map_view<const double>(f, 30, 30, 100 * sizeof(double));
+		EXPECT_EQ(reinterpret_cast<const double*>(f.data()) + 100, v.data());
+		EXPECT_EQ(100.0 + 31.0, v[1][1]);
+		TRectMatrix<double> x(30, 2), y(30, 2);
+		x.fill(1.0);
+		gemm(1.0, v, view(x), 0.0, view(y));
+		EXPECT_EQ(30 * 100.0 + 30 * 29 / 2, y[0][0]);
+		EXPECT_EQ(30 * 130.0 + 30 * 29 / 2, y[1][1]);
+		ASSERT_ANY_THROW(map_view<double>(f, 30, 30));
+		ASSERT_ANY_THROW(map_view<const double>(f, 40, 25, 100 * sizeof(double)));
+	}
+	std::remove(FILE_NAME);
+}
@@ -401,3 +401,179 @@ TEST(TDynamicMatrix, cant_multiply_matrix_by_matrix_with_incorrect_size)
     multiplier_matrix[4] = multiplier_vector_row5;
     ASSERT_ANY_THROW(original_matrix * multiplier_matrix);
 }
+TEST(TDynamicMatrix, rows_are_stored_contiguously)
+{
+    const int size = 4;
+    TDynamicMatrix<int> m(size);
+    for (int i = 1; i < size; i++)
+        EXPECT_EQ(&m[i - 1][0] + size, &m[i][0]);
+}
+
+TEST(TDynamicMatrix, row_view_writes_through_to_matrix)
+{
+    TDynamicMatrix<int> m(3);
+    TDynamicVector<int> v(3);
+    v[0] = 1;
+    v[1] = 2;
+    v[2] = 3;
+    m[1] = v;
+    EXPECT_EQ(m[1][2], 3);
+    m[2] = m[1];
+    EXPECT_EQ(m[2], v);
+    TDynamicVector<int> copy = m[2];
+    copy[0] = 10;
+    EXPECT_EQ(m[2][0], 1);
+}
+
+TEST(TDynamicMatrix, cant_assign_row_of_different_length)
+{
+    TDynamicMatrix<int> m(3);
+    TDynamicVector<int> v(4);
+    ASSERT_ANY_THROW(m[0] = v);
+}
+
+TEST(TDynamicMatrix, blocked_product_matches_naive_product)
+{
+    // размер больше блоков MC и KC, чтобы задеть все краевые плитки
+    const size_t size = 300;
+    TDynamicMatrix<int> a(size), b(size), expected(size);
+    for (size_t i = 0; i < size; i++)
+        for (size_t j = 0; j < size; j++) {
+            a[i][j] = int((i * 7 + j * 3) % 11) - 5;
+            b[i][j] = int((i * 5 + j * 13) % 9) - 4;
+        }
+    for (size_t i = 0; i < size; i++)
+        for (size_t j = 0; j < size; j++) {
+            int s = 0;
+            for (size_t k = 0; k < size; k++)
+                s += a[i][k] * b[k][j];
+            expected[i][j] = s;
+        }
+    EXPECT_EQ(a * b, expected);
+}
+
+TEST(TDynamicMatrix, can_evaluate_compound_expression)
+{
+    TDynamicMatrix<int> a(2), b(2), c(2);
+    for (int i = 0; i < 2; i++)
+        for (int j = 0; j < 2; j++)
+        {
+            a[i][j] = i + j;
+            b[i][j] = 10;
+            c[i][j] = i * j;
+        }
+    TDynamicMatrix<int> res = a + b - c * 3;
+    ASSERT_EQ(res[0][0], 10);
+    ASSERT_EQ(res[1][1], 9);
+    ASSERT_EQ((a + b) * c, (a + b) * TDynamicMatrix<int>(c));
+}
+
+TEST(TDynamicMatrix, rows_take_part_in_vector_expressions)
+{
+    TDynamicMatrix<int> m(2);
+    m[0][0] = 1;
+    m[0][1] = 2;
+    m[1][0] = 3;
+    m[1][1] = 4;
+    TDynamicVector<int> sum = m[0] + m[1];
+    ASSERT_EQ(sum[0], 4);
+    ASSERT_EQ(sum[1], 6);
+    m[1] = m[0] * 5;
+    ASSERT_EQ(m[1][1], 10);
+    ASSERT_EQ(m[0] * m[1], 25);
+}
+
+TEST(TDynamicMatrix, compound_operators_update_in_place)
+{
+    TDynamicMatrix<int> a(2), b(2);
+    for (int i = 0; i < 2; i++)
+        for (int j = 0; j < 2; j++)
+        {
+            a[i][j] = i + j;
+            b[i][j] = 1;
+        }
+    const int* mem = a.data();
+    a += b;
+    a *= 2;
+    a -= b;
+    a[0] += a[1];
+    ASSERT_EQ(mem, a.data());
+    ASSERT_EQ(a[0][0], 4);
+    ASSERT_EQ(a[1][1], 5);
+    ASSERT_ANY_THROW(a += TDynamicMatrix<int>(3));
+}
+
+TEST(TDynamicMatrix, gemv_computes_scaled_product_into_result)
+{
+    const size_t size = 37;
+    TDynamicMatrix<double> a(size);
+    TDynamicVector<double> x(size), y(size);
+    for (size_t i = 0; i < size; i++)
+    {
+        x[i] = double(i % 3);
+        y[i] = 1.0;
+        for (size_t j = 0; j < size; j++)
+            a[i][j] = double(int(i + 2 * j) % 5 - 2);
+    }
+    TDynamicVector<double> expected = (a * x) * 2.0 + y * 3.0;
+    gemv(2.0, a, x, 3.0, y);
+    EXPECT_EQ(expected, y);
+    ASSERT_ANY_THROW(gemv(1.0, a, y, 0.0, y));
+}
+
+TEST(TDynamicMatrix, gemm_computes_scaled_product_into_result)
+{
+    const size_t size = 70;
+    TDynamicMatrix<double> a(size), b(size), c(size);
+    for (size_t i = 0; i < size; i++)
+        for (size_t j = 0; j < size; j++)
+        {
+            a[i][j] = double(int(i + j) % 7 - 3);
+            b[i][j] = double(int(i * j) % 5 - 2);
+            c[i][j] = double(i);
+        }
+    TDynamicMatrix<double> expected = (a * b) * 2.0 - c;
+    gemm(2.0, a, b, -1.0, c);
+    EXPECT_EQ(expected, c);
+    ASSERT_ANY_THROW(gemm(1.0, a, c, 0.0, c));
+}
+
+TEST(TDynamicMatrix, gemm_with_zero_beta_ignores_result_contents)
+{
+    TDynamicMatrix<double> a(3), c(3);
+    for (size_t i = 0; i < 3; i++)
+    {
+        a[i][i] = 1.0;
+        for (size_t j = 0; j < 3; j++)
+            c[i][j] = std::numeric_limits<double>::quiet_NaN();
+    }
+    gemm(1.0, a, a, 0.0, c);
+    EXPECT_EQ(a, c);
+}
+
+TEST(TDynamicMatrix, product_result_is_reused_by_following_operations)
+{
+    TDynamicMatrix<int> a(2), b(2);
+    for (int i = 0; i < 2; i++)
+        for (int j = 0; j < 2; j++)
+        {
+            a[i][j] = i + j;
+            b[i][j] = 1;
+        }
+    TDynamicMatrix<int> ab = a * b;
+    TDynamicMatrix<int> res = b - (a * b) * 2 + a;
+    ASSERT_EQ(res, TDynamicMatrix<int>(b - ab * 2 + a));
+    ASSERT_EQ(res[1][1], -3);
+    ASSERT_ANY_THROW(a * b + TDynamicMatrix<int>(3));
+}
+
+TEST(TDynamicMatrix, can_fill_matrix_and_its_row)
+{
+    TDynamicMatrix<int> m(3, uninitialized);
+    m.fill(0);
+    m[1].fill(4);
+    ASSERT_EQ(m[0][2], 0);
+    ASSERT_EQ(m[1][2], 4);
+    TDynamicMatrix<int> copy(m);
+    ASSERT_EQ(m, copy);
+}
@@ -0,0 +1,74 @@
+#include "tpermmatrix.h"
+
+#include <gtest.h>
+
+static TDynamicMatrix<int> full(size_t n)
+{
+	TDynamicMatrix<int> m(n);
+	for (size_t i = 0; i < n; i++)
+		for (size_t j = 0; j < n; j++)
+			m[i][j] = int(i * n + j);
+	return m;
+}
+
+static TPermutationMatrix shuffled(size_t n, size_t step)
+{
+	std::vector<size_t> p(n);
+	for (size_t i = 0; i < n; i++)
+		p[i] = i * step % n;
+	return TPermutationMatrix(p);
+}
+
+TEST(TPermutationMatrix, checks_permutation)
+{
+	ASSERT_NO_THROW(TPermutationMatrix(std::vector<size_t>{ 2, 0, 1 }));
+	ASSERT_ANY_THROW(TPermutationMatrix(std::vector<size_t>{ 2, 0, 2 }));
+	ASSERT_ANY_THROW(TPermutationMatrix(std::vector<size_t>{ 0, 3, 1 }));
+	ASSERT_ANY_THROW(TPermutationMatrix(std::vector<size_t>()));
+}
+
+TEST(TPermutationMatrix, permutes_vector_elements)
+{
+	TPermutationMatrix p(std::vector<size_t>{ 2, 0, 1 });
+	TDynamicVector<int> x(3);
+	x[0] = 10; x[1] = 20; x[2] = 30;
+	TDynamicVector<int> y = p * x;
+	EXPECT_EQ(30, y[0]);
+	EXPECT_EQ(10, y[1]);
+	EXPECT_EQ(20, y[2]);
+	EXPECT_EQ(1.0, p.get(0, 2));
+	EXPECT_EQ(0.0, p.get(0, 0));
+	EXPECT_TRUE((std::is_same<int, decltype(p.get<int>(0, 2))>::value));
+	EXPECT_EQ(1, p.get<int>(0, 2));
+}
+
+TEST(TPermutationMatrix, products_match_dense_ones)
+{
+	const size_t n = 31;
+	TPermutationMatrix p = shuffled(n, 7);
+	TDynamicMatrix<int> a = full(n);
+	TDynamicMatrix<int> d = p.dense<int>();
+	EXPECT_EQ(TDynamicMatrix<int>(d * a), p * a);
+	EXPECT_EQ(TDynamicMatrix<int>(a * d), a * p);
+	EXPECT_EQ(TDynamicMatrix<int>(d * a * 2), p * (a * 2));
+	ASSERT_ANY_THROW(p * full(n + 1));
+}
+
+TEST(TPermutationMatrix, inverse_and_composition)
+{
+	TPermutationMatrix p = shuffled(31, 7), q = shuffled(31, 5);
+	EXPECT_EQ(TPermutationMatrix(31), p * p.inverse());
+	EXPECT_EQ(TDynamicMatrix<int>(p.dense<int>() * q.dense<int>()), (p * q).dense<int>());
+	TDynamicMatrix<int> a = full(31);
+	EXPECT_EQ(a, p.inverse() * (p * a));
+}
+
+TEST(TPermutationMatrix, swap_rows_swaps_matrix_rows)
+{
+	TPermutationMatrix p(4);
+	p.swap_rows(1, 3);
+	TDynamicMatrix<int> a = full(4), b = p * a;
+	EXPECT_EQ(a[3], b[1]);
+	EXPECT_EQ(a[1], b[3]);
+	EXPECT_EQ(a[0], b[0]);
+}
@@ -0,0 +1,121 @@
+#include "trectmatrix.h"
+
+#include <gtest.h>
+
+static TRectMatrix<double> rect(size_t m, size_t n, int seed)
+{
+	TRectMatrix<double> a(m, n);
+	for (size_t i = 0; i < m; i++)
+		for (size_t j = 0; j < n; j++)
+			a[i][j] = double(int((i * 7 + j * 3 + seed) % 11) - 5);
+	return a;
+}
+
+TEST(TRectMatrix, can_create_tall_skinny_matrix)
+{
+	TRectMatrix<double> a(1000000, 16);
+	EXPECT_EQ(1000000u, a.rows());
+	EXPECT_EQ(16u, a.cols());
+	EXPECT_EQ(16000000u, a.count());
+	EXPECT_EQ(0.0, a[999999][15]);
+}
+
+TEST(TRectMatrix, throws_on_wrong_size)
+{
+	ASSERT_ANY_THROW(TRectMatrix<int>(0, 5));
+	ASSERT_ANY_THROW(TRectMatrix<int>(5, 0));
+	ASSERT_ANY_THROW(TRectMatrix<int>(MAX_VECTOR_SIZE, 2));
+	TRectMatrix<int> a(3, 2);
+	ASSERT_ANY_THROW(a.at(3));
+	ASSERT_ANY_THROW(a.dense());
+}
+
+TEST(TRectMatrix, can_add_and_scale)
+{
+	TRectMatrix<double> a = rect(5, 3, 1), b = rect(5, 3, 2);
+	TRectMatrix<double> c = a * 2.0 - b;
+	for (size_t i = 0; i < 5; i++)
+		for (size_t j = 0; j < 3; j++)
+			EXPECT_EQ(a[i][j] * 2.0 - b[i][j], c[i][j]);
+	c += b;
+	EXPECT_EQ(TRectMatrix<double>(a * 2.0), c);
+	ASSERT_ANY_THROW(a + rect(3, 5, 0));
+}
+
+TEST(TRectMatrix, can_multiply_by_vector)
+{
+	TRectMatrix<double> a = rect(7, 3, 1);
+	TDynamicVector<double> x(3);
+	x[0] = 1.0; x[1] = 2.0; x[2] = -1.0;
+	TDynamicVector<double> y = a * x;
+	ASSERT_EQ(7u, y.size());
+	for (size_t i = 0; i < 7; i++)
+		EXPECT_EQ(a[i][0] + 2.0 * a[i][1] - a[i][2], y[i]);
+	ASSERT_ANY_THROW(a * TDynamicVector<double>(7));
+}
+
+TEST(TRectMatrix, product_has_correct_shape_and_values)
+{
+	const size_t m = 37, k = 11, n = 5;
+	TRectMatrix<double> a = rect(m, k, 1), b = rect(k, n, 2);
+	TRectMatrix<double> c = a * b;
+	ASSERT_EQ(m, c.rows());
+	ASSERT_EQ(n, c.cols());
+	for (size_t i = 0; i < m; i++)
+		for (size_t j = 0; j < n; j++) {
+			double s = 0.0;
+			for (size_t p = 0; p < k; p++)
+				s += a[i][p] * b[p][j];
+			EXPECT_EQ(s, c[i][j]);
+		}
+	ASSERT_ANY_THROW(a * a);
+}
+
+TEST(TRectMatrix, square_product_matches_dynamic_matrix)
+{
+	TRectMatrix<double> a = rect(40, 40, 1), b = rect(40, 40, 2);
+	EXPECT_EQ(a.dense() * b.dense(), (a * b).dense());
+}
+
+TEST(TRectMatrix, tall_skinny_gram_matrix_in_parallel)
+{
+	TThreadPool& pool = TThreadPool::instance();
+	const size_t saved = pool.num_threads();
+	pool.set_num_threads(4);
+	const size_t m = 20000, n = 16;
+	TRectMatrix<double> a = rect(m, n, 3), at(n, m);
+	for (size_t i = 0; i < m; i++)
+		for (size_t j = 0; j < n; j++)
+			at[j][i] = a[i][j];
+	TRectMatrix<double> g = at * a;
+	TRectMatrix<double> h(n, n);
+	gemm(1.0, at, a, 0.0, h);
+	pool.set_num_threads(saved);
+	ASSERT_EQ(n, g.rows());
+	ASSERT_EQ(n, g.cols());
+	for (size_t i = 0; i < n; i++)
+		for (size_t j = 0; j < n; j++) {
+			double s = 0.0;
+			for (size_t p = 0; p < m; p++)
+				s += a[p][i] * a[p][j];
+			EXPECT_EQ(s, g[i][j]);
+			EXPECT_EQ(g[i][j], g[j][i]);
+		}
+	EXPECT_EQ(g, h);
+}
+
+TEST(TRectMatrix, gemv_and_gemm_accumulate)
+{
+	TRectMatrix<double> a = rect(6, 4, 1), b = rect(4, 3, 2);
+	TDynamicVector<double> x(4), y(6);
+	for (size_t i = 0; i < 4; i++)
+		x[i] = double(i) - 1.0;
+	y.fill(1.0);
+	gemv(2.0, a, x, 3.0, y);
+	EXPECT_EQ(TDynamicVector<double>((a * x) * 2.0 + 3.0), y);
+	TRectMatrix<double> c = rect(6, 3, 5), c0 = c;
+	gemm(1.0, a, b, -1.0, c);
+	EXPECT_EQ(TRectMatrix<double>(a * b - c0), c);
+	TRectMatrix<double> s = rect(4, 4, 0);
+	ASSERT_ANY_THROW(gemm(1.0, s, s, 0.0, s));
+}
@@ -0,0 +1,107 @@
+#include "tstaticmatrix.h"
+#include "tmatrix.h"
+
+#include <gtest.h>
+
+// вычисления при компиляции
+constexpr TStaticMatrix<int, 2> rot = { { 0, -1 }, { 1, 0 } };
+static_assert(rot * rot * rot * rot == TStaticMatrix<int, 2>::identity(), "rotation by 360 degrees");
+static_assert((rot * TStaticVector<int, 2>{ 3, 4 })[0] == -4, "matrix-vector product");
+static_assert(TStaticVector<int, 3>{ 1, 2, 3 } * TStaticVector<int, 3>{ 4, 5, 6 } == 32, "dot product");
+static_assert(sizeof(TStaticMatrix<double, 4>) == 16 * sizeof(double), "no overhead");
+static_assert(rot.count() == 4 && rot.elem(1) == -1 && rot.elem(2) == 1, "row-major elements");
+
+// обобщённый код, обходящий элементы построчного хранения
+template<typename M>
+typename M::value_type element_sum(const M& m)
+{
+	typename M::value_type s = 0;
+	for (size_t k = 0; k < m.count(); k++)
+		s += m.elem(k);
+	return s;
+}
+
+// обобщённый код для статических и динамических матриц
+template<typename M, typename V>
+typename V::value_type quadratic_form(const M& m, const V& x)
+{
+	typename V::value_type s = 0;
+	for (size_t i = 0; i < m.size(); i++)
+		for (size_t j = 0; j < m.size(); j++)
+			s += x[i] * m[i][j] * x[j];
+	return s;
+}
+
+TEST(TStaticVector, is_zero_initialized)
+{
+	TStaticVector<double, 5> v;
+	for (size_t i = 0; i < v.size(); i++)
+		EXPECT_EQ(0.0, v[i]);
+}
+
+TEST(TStaticVector, throws_on_too_many_elements_or_bad_index)
+{
+	ASSERT_ANY_THROW((TStaticVector<int, 2>{ 1, 2, 3 }));
+	TStaticVector<int, 2> v;
+	ASSERT_ANY_THROW(v.at(2));
+}
+
+TEST(TStaticVector, arithmetic)
+{
+	TStaticVector<int, 4> a{ 1, 2, 3, 4 }, b{ 4, 3, 2, 1 };
+	EXPECT_EQ((TStaticVector<int, 4>{ 5, 5, 5, 5 }), a + b);
+	EXPECT_EQ((TStaticVector<int, 4>{ -3, -1, 1, 3 }), a - b);
+	EXPECT_EQ((TStaticVector<int, 4>{ 2, 4, 6, 8 }), a * 2);
+	EXPECT_EQ((TStaticVector<int, 4>{ 2, 3, 4, 5 }), a + 1);
+	EXPECT_EQ(20, a * b);
+	a += b;
+	EXPECT_EQ((TStaticVector<int, 4>{ 5, 5, 5, 5 }), a);
+}
+
+TEST(TStaticMatrix, products_match_dynamic_ones)
+{
+	TStaticMatrix<double, 8> a, b;
+	TDynamicMatrix<double> da(8), db(8);
+	TStaticVector<double, 8> x;
+	TDynamicVector<double> dx(8);
+	for (size_t i = 0; i < 8; i++) {
+		x[i] = dx[i] = double(i) - 3.0;
+		for (size_t j = 0; j < 8; j++) {
+			a[i][j] = da[i][j] = double(int((i * 3 + j) % 7) - 3);
+			b[i][j] = db[i][j] = double(int((i + j * 5) % 5) - 2);
+		}
+	}
+	TStaticMatrix<double, 8> c = a * b;
+	TDynamicMatrix<double> dc = da * db;
+	TStaticVector<double, 8> y = a * x;
+	TDynamicVector<double> dy = da * dx;
+	for (size_t i = 0; i < 8; i++) {
+		EXPECT_EQ(dy[i], y[i]);
+		for (size_t j = 0; j < 8; j++)
+			EXPECT_EQ(dc[i][j], c[i][j]);
+	}
+	EXPECT_EQ(quadratic_form(da, dx), quadratic_form(a, x));
+}
+
+TEST(TStaticMatrix, elementwise_operations)
+{
+	TStaticMatrix<int, 2> a{ { 1, 2 }, { 3, 4 } };
+	EXPECT_EQ((TStaticMatrix<int, 2>{ { 2, 4 }, { 6, 8 } }), a + a);
+	EXPECT_EQ((TStaticMatrix<int, 2>{ { 2, 4 }, { 6, 8 } }), a * 2);
+	EXPECT_EQ((TStaticMatrix<int, 2>()), a - a);
+	EXPECT_EQ(a, (a * TStaticMatrix<int, 2>::identity()));
+	ASSERT_ANY_THROW(a.at(2));
+}
+
+TEST(TStaticMatrix, elements_are_stored_row_by_row)
+{
+	TStaticMatrix<double, 3> a;
+	TDynamicMatrix<double> d(3);
+	for (size_t i = 0; i < 3; i++)
+		for (size_t j = 0; j < 3; j++)
+			a[i][j] = d[i][j] = double(i * 3 + j) - 4.0;
+	EXPECT_EQ(element_sum(d), element_sum(a));
+	EXPECT_EQ(&a[2][1], a.data() + 7);
+	a.fill(1.5);
+	EXPECT_EQ(13.5, element_sum(a));
+}
@@ -0,0 +1,115 @@
+#include "tsymmatrix.h"
+
+#include <gtest.h>
+
+static TDynamicMatrix<double> symmetric(size_t n, int seed)
+{
+	TDynamicMatrix<double> m(n);
+	for (size_t i = 0; i < n; i++)
+		for (size_t j = i; j < n; j++)
+			m[i][j] = m[j][i] = double(int((i * 5 + j * 3 + seed) % 11) - 5);
+	return m;
+}
+
+TEST(TSymmetricMatrix, can_create_matrix_with_positive_length)
+{
+	ASSERT_NO_THROW(TSymmetricMatrix<int> m(5));
+}
+
+TEST(TSymmetricMatrix, cant_create_too_large_matrix)
+{
+	ASSERT_ANY_THROW(TSymmetricMatrix<int> m(MAX_MATRIX_SIZE + 1));
+}
+
+TEST(TSymmetricMatrix, mirrored_elements_share_storage)
+{
+	TSymmetricMatrix<int> m(4);
+	EXPECT_EQ(10u, m.count());
+	m[3][1] = 5;
+	EXPECT_EQ(5, m[1][3]);
+	EXPECT_EQ(5, m.data()[6]);
+	ASSERT_ANY_THROW(m.at(1).at(4));
+}
+
+TEST(TSymmetricMatrix, converts_to_and_from_dense_matrix)
+{
+	TDynamicMatrix<double> d = symmetric(9, 1);
+	TSymmetricMatrix<double> m(d);
+	EXPECT_EQ(d, m.dense());
+}
+
+TEST(TSymmetricMatrix, can_add_subtract_and_scale)
+{
+	TDynamicMatrix<double> da = symmetric(6, 1), db = symmetric(6, 2);
+	TSymmetricMatrix<double> a(da), b(db);
+	TSymmetricMatrix<double> c = a - b * 2.0;
+	EXPECT_EQ(TDynamicMatrix<double>(da - db * 2.0), c.dense());
+	c += b;
+	c *= 2.0;
+	EXPECT_EQ(TDynamicMatrix<double>((da - db) * 2.0), c.dense());
+	ASSERT_ANY_THROW(a + TSymmetricMatrix<double>(5));
+}
+
+TEST(TSymmetricMatrix, product_with_vector_matches_dense_one)
+{
+	const size_t sizes[] = { 1, 5, 64, 1000 };
+	for (size_t n : sizes)
+	{
+		TDynamicMatrix<double> d = symmetric(n, 3);
+		TSymmetricMatrix<double> m(d);
+		TDynamicVector<double> x(n);
+		for (size_t i = 0; i < n; i++)
+			x[i] = double(int(i % 5) - 2);
+		EXPECT_EQ(d * x, m * x) << "n = " << n;
+	}
+}
+
+TEST(TSymmetricMatrix, syrk_matches_product_with_transpose)
+{
+	const size_t sizes[] = { 1, 7, 130, 300 };
+	for (size_t n : sizes)
+	{
+		TDynamicMatrix<double> a(n), at(n);
+		for (size_t i = 0; i < n; i++)
+			for (size_t j = 0; j < n; j++)
+				a[i][j] = at[j][i] = double(int((i * 3 + j * j) % 7) - 3);
+		EXPECT_EQ(a * at, syrk(a).dense()) << "n = " << n;
+	}
+}
+
+TEST(TSymmetricMatrix, syrk_accumulates_into_result)
+{
+	const size_t n = 20;
+	TDynamicMatrix<double> a(n), at(n);
+	for (size_t i = 0; i < n; i++)
+		for (size_t j = 0; j < n; j++)
+			a[i][j] = at[j][i] = double(int(i + j) % 3 - 1);
+	TDynamicMatrix<double> d = symmetric(n, 4);
+	TSymmetricMatrix<double> c(d);
+	syrk(2.0, a, -1.0, c);
+	EXPECT_EQ(TDynamicMatrix<double>((a * at) * 2.0 - d), c.dense());
+	TSymmetricMatrix<double> small(3);
+	ASSERT_ANY_THROW(syrk(1.0, a, 0.0, small));
+}
+
+TEST(TSymmetricMatrix, syrk_takes_tall_rectangular_matrix)
+{
+	const size_t n = 37, k = 5;
+	TRectMatrix<double> a(n, k);
+	for (size_t i = 0; i < n; i++)
+		for (size_t j = 0; j < k; j++)
+			a[i][j] = double(int(i * 2 + j * 3) % 5 - 2);
+	TDynamicMatrix<double> g(n);
+	for (size_t i = 0; i < n; i++)
+		for (size_t j = 0; j < n; j++)
+			for (size_t l = 0; l < k; l++)
+				g[i][j] += a[i][l] * a[j][l];
+	EXPECT_EQ(g, syrk(a).dense());
+
+	TDynamicMatrix<double> d = symmetric(n, 2);
+	TSymmetricMatrix<double> c(d);
+	syrk(3.0, a, 1.0, c);
+	EXPECT_EQ(TDynamicMatrix<double>(g * 3.0 + d), c.dense());
+	TSymmetricMatrix<double> small(k);
+	ASSERT_ANY_THROW(syrk(1.0, a, 0.0, small));
+}
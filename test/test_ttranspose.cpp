@@ -0,0 +1,191 @@
+#include "ttranspose.h"
+
+#include <gtest.h>
+
+static TRectMatrix<double> rect(size_t m, size_t n, int seed)
+{
+	TRectMatrix<double> a(m, n);
+	for (size_t i = 0; i < m; i++)
+		for (size_t j = 0; j < n; j++)
+			a[i][j] = double(int((i * 7 + j * 3 + seed) % 11) - 5);
+	return a;
+}
+
+// явное транспонирование для сравнения
+static TRectMatrix<double> copy_transposed(const TRectMatrix<double>& a)
+{
+	TRectMatrix<double> t(a.cols(), a.rows());
+	for (size_t i = 0; i < a.rows(); i++)
+		for (size_t j = 0; j < a.cols(); j++)
+			t[j][i] = a[i][j];
+	return t;
+}
+
+TEST(TTransposeView, reads_matrix_transposed)
+{
+	TRectMatrix<double> a = rect(3, 5, 1);
+	TTransposeView<const double> t = transpose(a);
+	EXPECT_EQ(5u, t.rows());
+	EXPECT_EQ(3u, t.cols());
+	EXPECT_EQ(a[2][4], t.get(4, 2));
+	ASSERT_ANY_THROW(t.get(3, 3));
+	EXPECT_EQ(copy_transposed(a), TRectMatrix<double>(t));
+	EXPECT_TRUE(transpose(t) == a);
+}
+
+TEST(TTransposeView, can_be_used_in_expressions)
+{
+	TRectMatrix<double> a = rect(4, 6, 1), b = rect(6, 4, 2);
+	TRectMatrix<double> c = transpose(a) + b;
+	EXPECT_EQ(TRectMatrix<double>(copy_transposed(a) + b), c);
+	ASSERT_ANY_THROW(transpose(a) + a);
+}
+
+TEST(TTransposeView, transposed_products_match_explicit_transpose)
+{
+	const size_t m = 37, k = 23, n = 19;
+	TRectMatrix<double> a = rect(k, m, 1), b = rect(k, n, 2), c = rect(n, k, 3), d = rect(m, k, 4);
+	TRectMatrix<double> at = copy_transposed(a), ct = copy_transposed(c);
+	EXPECT_EQ(at * b, transpose(a) * b);
+	EXPECT_EQ(d * ct, d * transpose(c));
+	EXPECT_EQ(at * ct, transpose(a) * transpose(c));
+	EXPECT_EQ(block(at, 2, 3, 10, 5) * block(b, 1, 0, 5, 7), transpose(block(a, 3, 2, 5, 10)) * block(b, 1, 0, 5, 7));
+	ASSERT_ANY_THROW(transpose(a) * d);
+}
+
+TEST(TTransposeView, works_with_square_dynamic_matrices)
+{
+	const size_t n = 30;
+	TDynamicMatrix<double> a(n), b(n), at(n);
+	for (size_t i = 0; i < n; i++)
+		for (size_t j = 0; j < n; j++) {
+			a[i][j] = double(int((i * 5 + j) % 7) - 3);
+			b[i][j] = double(int((i + j * 3) % 5) - 2);
+			at[j][i] = a[i][j];
+		}
+	EXPECT_EQ(at * b, transpose(a) * b);
+	EXPECT_EQ(b * at, b * transpose(a));
+	TDynamicMatrix<double> c(n);
+	gemm(1.0, transpose(a), b, 0.0, c);
+	EXPECT_EQ(at * b, c);
+}
+
+TEST(TTransposeView, gemm_accumulates_and_checks_aliasing)
+{
+	TRectMatrix<double> a = rect(8, 5, 1), b = rect(6, 8, 2), c = rect(5, 6, 3), c0 = c;
+	gemm(2.0, transpose(a), transpose(b), 1.0, c);
+	EXPECT_EQ(TRectMatrix<double>(copy_transposed(a) * copy_transposed(b) * 2.0 + c0), c);
+	TRectMatrix<double> s = rect(6, 6, 0);
+	ASSERT_ANY_THROW(gemm(1.0, transpose(s), s, 0.0, s));
+}
+
+TEST(TTransposeView, large_transposed_product_in_parallel)
+{
+	TThreadPool& pool = TThreadPool::instance();
+	const size_t saved = pool.num_threads();
+	pool.set_num_threads(4);
+	TRectMatrix<double> a = rect(300, 200, 1), b = rect(300, 150, 2);
+	TRectMatrix<double> c = transpose(a) * b;
+	TRectMatrix<double> e = copy_transposed(a) * b;
+	pool.set_num_threads(saved);
+	EXPECT_EQ(e, c);
+}
+
+TEST(TTransposeView, transposed_matvec)
+{
+	TRectMatrix<double> a = rect(700, 300, 1);
+	TDynamicVector<double> x(700), y(300);
+	for (size_t i = 0; i < 700; i++)
+		x[i] = double(int(i % 5) - 2);
+	EXPECT_EQ(copy_transposed(a) * x, transpose(a) * x);
+	y.fill(1.0);
+	gemv(2.0, transpose(a), x, -1.0, y);
+	EXPECT_EQ(TDynamicVector<double>((copy_transposed(a) * x) * 2.0 - 1.0), y);
+	ASSERT_ANY_THROW(transpose(a) * y);
+}
+
+TEST(TTransposeView, copy_of_transpose_uses_blocked_kernel)
+{
+	const size_t sizes[][2] = { { 1, 7 }, { 65, 3 }, { 130, 257 }, { 300, 129 } };
+	for (size_t s = 0; s < 4; s++) {
+		TRectMatrix<double> a = rect(sizes[s][0], sizes[s][1], int(s));
+		TRectMatrix<double> t = transpose(a);
+		EXPECT_EQ(copy_transposed(a), t);
+	}
+}
+
+TEST(TTransposeView, can_transpose_into_block)
+{
+	TRectMatrix<double> a = rect(70, 90, 1), b(100, 100);
+	block(b, 5, 3, 90, 70) = transpose(a);
+	for (size_t i = 0; i < 90; i++)
+		for (size_t j = 0; j < 70; j++)
+			EXPECT_EQ(a[j][i], b[i + 5][j + 3]);
+	EXPECT_EQ(0.0, b[4][3]);
+	EXPECT_EQ(0.0, b[5][73]);
+}
+
+TEST(TTransposeView, parallel_transpose_kernel)
+{
+	TThreadPool& pool = TThreadPool::instance();
+	const size_t saved = pool.num_threads();
+	pool.set_num_threads(4);
+	const size_t m = 517, n = 389;
+	TRectMatrix<double> a = rect(m, n, 2), b(n, m);
+	kernels::transpose(m, n, a.data(), n, b.data(), m);
+	pool.set_num_threads(saved);
+	EXPECT_EQ(copy_transposed(a), b);
+}
+
+TEST(TTransposeView, in_place_transpose_of_square_matrix)
+{
+	const size_t sizes[] = { 1, 16, 33, 200, 1100 };
+	TThreadPool& pool = TThreadPool::instance();
+	const size_t saved = pool.num_threads();
+	for (size_t s = 0; s < 5; s++) {
+		const size_t n = sizes[s];
+		TDynamicMatrix<double> a(n), at(n);
+		for (size_t i = 0; i < n; i++)
+			for (size_t j = 0; j < n; j++) {
+				a[i][j] = double(i * n + j);
+				at[j][i] = a[i][j];
+			}
+		pool.set_num_threads(s % 2 ? 1 : 4);
+		transpose_in_place(a);
+		EXPECT_EQ(at, a);
+	}
+	pool.set_num_threads(saved);
+	TRectMatrix<double> r = rect(4, 6, 0), r0 = r;
+	ASSERT_ANY_THROW(transpose_in_place(r));
+	transpose_in_place(block(r, 1, 1, 3, 3));
+	EXPECT_EQ(r0[3][2], r[2][3]);
+	EXPECT_EQ(r0[0][5], r[0][5]);
+}
+
+TEST(TTransposeView, assignment_of_own_transpose_uses_copy)
+{
+	TRectMatrix<double> r = rect(3, 3, 0), r0 = r;
+	r = transpose(r);
+	EXPECT_EQ(copy_transposed(r0), r);
+	r = r0;
+	r += transpose(r);
+	EXPECT_EQ(TRectMatrix<double>(r0 + copy_transposed(r0)), r);
+
+	TRectMatrix<double> big = rect(150, 150, 1), big0 = big;
+	view(big) = transpose(big) * 2.0;
+	EXPECT_EQ(TRectMatrix<double>(copy_transposed(big0) * 2.0), big);
+
+	// транспонированный блок, перекрывающийся с блоком-результатом
+	TRectMatrix<double> a = rect(6, 6, 2), a0 = a;
+	block(a, 1, 1, 4, 4) = transpose(block(a, 0, 0, 4, 4));
+	for (size_t i = 0; i < 4; i++)
+		for (size_t j = 0; j < 4; j++)
+			EXPECT_EQ(a0[j][i], a[i + 1][j + 1]);
+
+	// сдвинутый блок той же матрицы
+	TRectMatrix<double> s = rect(5, 8, 3), s0 = s;
+	block(s, 0, 1, 5, 7) = block(s, 0, 0, 5, 7);
+	for (size_t i = 0; i < 5; i++)
+		for (size_t j = 0; j < 7; j++)
+			EXPECT_EQ(s0[i][j], s[i][j + 1]);
+}
@@ -0,0 +1,103 @@
+#include "tutmatrix.h"
+
+#include <gtest.h>
+
+static TDynamicMatrix<double> upper_part(size_t n, int seed)
+{
+	TDynamicMatrix<double> m(n);
+	for (size_t i = 0; i < n; i++)
+		for (size_t j = i; j < n; j++)
+			m[i][j] = double(int((i * 7 + j * 3 + seed) % 11) - 5);
+	return m;
+}
+
+TEST(TUpperTriangularMatrix, can_create_matrix_with_positive_length)
+{
+	ASSERT_NO_THROW(TUpperTriangularMatrix<int> m(5));
+}
+
+TEST(TUpperTriangularMatrix, cant_create_too_large_matrix)
+{
+	ASSERT_ANY_THROW(TUpperTriangularMatrix<int> m(MAX_MATRIX_SIZE + 1));
+}
+
+TEST(TUpperTriangularMatrix, stores_only_upper_triangle)
+{
+	TUpperTriangularMatrix<int> m(4);
+	EXPECT_EQ(10u, m.count());
+	m[1][3] = 7;
+	m[3][3] = 9;
+	EXPECT_EQ(7, m.data()[6]);
+	EXPECT_EQ(9, m.data()[9]);
+	EXPECT_EQ(0, m.get(3, 1));
+	ASSERT_ANY_THROW(m.at(2).at(1));
+	ASSERT_ANY_THROW(m.at(4));
+}
+
+TEST(TUpperTriangularMatrix, converts_to_and_from_dense_matrix)
+{
+	TDynamicMatrix<double> d = upper_part(9, 1);
+	TUpperTriangularMatrix<double> m(d);
+	EXPECT_EQ(d, m.dense());
+}
+
+TEST(TUpperTriangularMatrix, can_add_subtract_and_scale)
+{
+	TDynamicMatrix<double> da = upper_part(6, 1), db = upper_part(6, 2);
+	TUpperTriangularMatrix<double> a(da), b(db);
+	TUpperTriangularMatrix<double> c = a + b * 2.0 - a;
+	EXPECT_EQ(TDynamicMatrix<double>(db * 2.0), c.dense());
+	c -= b;
+	c *= 3.0;
+	EXPECT_EQ(TDynamicMatrix<double>(db * 3.0), c.dense());
+	ASSERT_ANY_THROW(a + TUpperTriangularMatrix<double>(5));
+}
+
+// есть ли операция M + скаляр
+template<typename M, typename = void>
+struct can_shift : std::false_type {};
+template<typename M>
+struct can_shift<M, decltype(void(std::declval<const M&>() + 1.0), void(std::declval<M>() - 1.0))> : std::true_type {};
+
+TEST(TUpperTriangularMatrix, cant_add_scalar)
+{
+	EXPECT_FALSE(can_shift<TUpperTriangularMatrix<double>>::value);
+	EXPECT_TRUE(can_shift<TDynamicMatrix<double>>::value);
+}
+
+TEST(TUpperTriangularMatrix, product_with_vector_matches_dense_one)
+{
+	const size_t n = 300;
+	TDynamicMatrix<double> d = upper_part(n, 3);
+	TUpperTriangularMatrix<double> m(d);
+	TDynamicVector<double> x(n);
+	for (size_t i = 0; i < n; i++)
+		x[i] = double(int(i % 5) - 2);
+	EXPECT_EQ(d * x, m * x);
+}
+
+TEST(TUpperTriangularMatrix, product_of_triangular_matrices_matches_dense_one)
+{
+	const size_t sizes[] = { 1, 2, 7, 33, 130, 300 };
+	for (size_t n : sizes)
+	{
+		TDynamicMatrix<double> da = upper_part(n, 4), db = upper_part(n, 5);
+		TUpperTriangularMatrix<double> a(da), b(db);
+		TUpperTriangularMatrix<double> c = a * b;
+		EXPECT_EQ(da * db, c.dense()) << "n = " << n;
+	}
+}
+
+TEST(TUpperTriangularMatrix, integer_product_matches_dense_one)
+{
+	const size_t n = 40;
+	TDynamicMatrix<int> da(n), db(n);
+	for (size_t i = 0; i < n; i++)
+		for (size_t j = i; j < n; j++)
+		{
+			da[i][j] = int(i + j) % 4 - 1;
+			db[i][j] = int(i * j) % 3 - 1;
+		}
+	TUpperTriangularMatrix<int> a(da), b(db);
+	EXPECT_EQ(da * db, (a * b).dense());
+}
@@ -320,4 +320,170 @@ v2[2] = 3;
 v2[3] = 4;
 v2[4] = 5;
 ASSERT_ANY_THROW(v1* v2);
-}
\ No newline at end of file
+}
+TEST(TDynamicVector, can_evaluate_compound_expression)
+{
+	const int size = 3;
+	TDynamicVector<int> a(size), b(size), c(size);
+	for (int i = 0; i < size; i++)
+	{
+		a[i] = i;
+		b[i] = 10 * i;
+		c[i] = i + 1;
+	}
+	TDynamicVector<int> res = a + b - c * 2;
+	ASSERT_EQ(res[0], -2);
+	ASSERT_EQ(res[1], 7);
+	ASSERT_EQ(res[2], 16);
+}
+
+TEST(TDynamicVector, expression_may_reference_its_destination)
+{
+	TDynamicVector<int> a(3), b(3);
+	a[0] = 1;
+	a[1] = 2;
+	a[2] = 3;
+	b[0] = b[1] = b[2] = 1;
+	a = a + b + a;
+	ASSERT_EQ(a[0], 3);
+	ASSERT_EQ(a[2], 7);
+}
+
+TEST(TDynamicVector, cant_combine_expressions_of_different_length)
+{
+	TDynamicVector<int> a(3), b(3), c(4);
+	ASSERT_ANY_THROW(a + b - c);
+}
+
+TEST(TDynamicVector, compound_operators_update_in_place)
+{
+	TDynamicVector<int> a(3), b(3);
+	for (int i = 0; i < 3; i++)
+	{
+		a[i] = i;
+		b[i] = 1;
+	}
+	const int* mem = a.data();
+	a += b;
+	a *= 3;
+	a -= b + b;
+	a += 1;
+	ASSERT_EQ(mem, a.data());
+	ASSERT_EQ(a[0], 2);
+	ASSERT_EQ(a[2], 8);
+}
+
+TEST(TDynamicVector, axpy_adds_scaled_vector)
+{
+	TDynamicVector<double> x(5), y(5);
+	for (int i = 0; i < 5; i++)
+	{
+		x[i] = i;
+		y[i] = 1;
+	}
+	axpy(2.0, x, y);
+	ASSERT_EQ(y[0], 1.0);
+	ASSERT_EQ(y[4], 9.0);
+	ASSERT_ANY_THROW(axpy(1.0, TDynamicVector<double>(4), y));
+}
+
+TEST(TDynamicVector, temporary_operand_buffer_is_reused)
+{
+	TDynamicVector<int> a(3), b(3);
+	for (int i = 0; i < 3; i++)
+	{
+		a[i] = i;
+		b[i] = 10;
+	}
+	TDynamicVector<int> t(a);
+	const int* mem = t.data();
+	TDynamicVector<int> res = (std::move(t) + b) * 2 - 1;
+	ASSERT_EQ(mem, res.data());
+	ASSERT_EQ(res[2], 23);
+	TDynamicVector<int> u(a);
+	mem = u.data();
+	res = b - std::move(u);
+	ASSERT_EQ(mem, res.data());
+	ASSERT_EQ(res[1], 9);
+}
+
+TEST(TDynamicVector, can_fill_vector)
+{
+	TDynamicVector<double> v(4);
+	v.fill(2.5);
+	ASSERT_EQ(v[3], 2.5);
+	v.fill(0.0);
+	ASSERT_EQ(v[0], 0.0);
+}
+
+TEST(TDynamicVector, uninitialized_vector_can_be_overwritten)
+{
+	TDynamicVector<int> v(5, uninitialized);
+	ASSERT_EQ(5, v.size());
+	v.fill(7);
+	ASSERT_EQ(v[4], 7);
+	ASSERT_ANY_THROW(TDynamicVector<int>(0, uninitialized));
+}
+
+TEST(TDynamicVector, floating_point_comparison_follows_value_semantics)
+{
+	TDynamicVector<double> a(2), b(2);
+	a[0] = 0.0;
+	b[0] = -0.0;
+	EXPECT_EQ(a, b);
+	a[1] = b[1] = std::numeric_limits<double>::quiet_NaN();
+	EXPECT_NE(a, b);
+}
+
+TEST(TDynamicVector, memory_is_aligned_to_cache_line)
+{
+	for (size_t n = 1; n < 20; n++)
+	{
+		TDynamicVector<double> v(n);
+		ASSERT_EQ(0u, reinterpret_cast<size_t>(v.data()) % CACHE_LINE_SIZE);
+	}
+}
+
+template<typename T>
+struct TCountingAllocator
+{
+	typedef T value_type;
+	size_t* live;
+
+	TCountingAllocator(size_t* counter) : live(counter) {}
+	template<typename U>
+	TCountingAllocator(const TCountingAllocator<U>& a) : live(a.live) {}
+
+	T* allocate(size_t n)
+	{
+		++*live;
+		return std::allocator<T>().allocate(n);
+	}
+	void deallocate(T* p, size_t n)
+	{
+		--*live;
+		std::allocator<T>().deallocate(p, n);
+	}
+	bool operator==(const TCountingAllocator& a) const { return live == a.live; }
+	bool operator!=(const TCountingAllocator& a) const { return live != a.live; }
+};
+
+TEST(TDynamicVector, memory_comes_from_user_allocator)
+{
+	size_t live = 0;
+	{
+		typedef TCountingAllocator<int> A;
+		TDynamicVector<int, A> v(10, A(&live)), w(10, A(&live));
+		v.fill(1);
+		w.fill(2);
+		TDynamicVector<int, A> sum(v + w, A(&live));
+		TDynamicVector<int, A> copy(sum);
+		ASSERT_EQ(4u, live);
+		ASSERT_EQ(3, copy[9]);
+		TDynamicMatrix<int, A> m(3, A(&live));
+		ASSERT_EQ(5u, live);
+		TDynamicMatrix<int, A> p = m * m;
+		ASSERT_EQ(6u, live);
+	}
+	ASSERT_EQ(0u, live);
+}
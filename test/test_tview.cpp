@@ -0,0 +1,190 @@
+#include "tview.h"
+
+#include <gtest.h>
+
+static TRectMatrix<double> rect(size_t m, size_t n, int seed)
+{
+	TRectMatrix<double> a(m, n);
+	for (size_t i = 0; i < m; i++)
+		for (size_t j = 0; j < n; j++)
+			a[i][j] = double(int((i * 7 + j * 3 + seed) % 11) - 5);
+	return a;
+}
+
+TEST(TMatrixView, block_shares_memory_with_matrix)
+{
+	TDynamicMatrix<int> a(5);
+	TMatrixView<int> b = block(a, 1, 2, 3, 2);
+	EXPECT_EQ(3u, b.rows());
+	EXPECT_EQ(2u, b.cols());
+	EXPECT_EQ(5u, b.stride());
+	b[2][1] = 7;
+	EXPECT_EQ(7, a[3][3]);
+	b.fill(1);
+	EXPECT_EQ(1, a[1][2]);
+	EXPECT_EQ(0, a[1][1]);
+	EXPECT_EQ(0, a[4][2]);
+	ASSERT_ANY_THROW(block(a, 3, 0, 3, 1));
+	ASSERT_ANY_THROW(b.at(3));
+}
+
+TEST(TMatrixView, row_and_column_ranges)
+{
+	TRectMatrix<double> a = rect(6, 4, 1);
+	TMatrixView<const double> r = row_range(static_cast<const TRectMatrix<double>&>(a), 2, 5);
+	TMatrixView<double> c = col_range(a, 1, 3);
+	EXPECT_EQ(3u, r.rows());
+	EXPECT_EQ(4u, r.cols());
+	EXPECT_EQ(a[2][0], r[0][0]);
+	EXPECT_EQ(6u, c.rows());
+	EXPECT_EQ(2u, c.cols());
+	EXPECT_EQ(a[5][2], c[5][1]);
+}
+
+TEST(TMatrixView, column_is_strided_vector)
+{
+	TDynamicMatrix<double> a(4);
+	TStridedVector<double> c = column(a, 2);
+	EXPECT_EQ(4u, c.size());
+	EXPECT_EQ(4u, c.stride());
+	TDynamicVector<double> v(4);
+	for (size_t i = 0; i < 4; i++)
+		v[i] = double(i + 1);
+	c = v;
+	c *= 2.0;
+	for (size_t i = 0; i < 4; i++)
+		EXPECT_EQ(2.0 * (i + 1), a[i][2]);
+	EXPECT_EQ(60.0, c * v);
+	EXPECT_EQ(TDynamicVector<double>(v * 3.0), TDynamicVector<double>(c + v));
+	ASSERT_ANY_THROW(c = TDynamicVector<double>(3));
+}
+
+TEST(TMatrixView, assignment_from_shifted_vector_view_uses_copy)
+{
+	TDynamicVector<double> v(10), v0(10);
+	for (size_t i = 0; i < 10; i++)
+		v[i] = v0[i] = double(i);
+	TStridedVector<double> dst(v.data() + 1, 9), src(v.data(), 9);
+	dst = src;
+	EXPECT_EQ(0.0, v[0]);
+	for (size_t i = 1; i < 10; i++)
+		EXPECT_EQ(v0[i - 1], v[i]);
+
+	v = v0;
+	dst += src;
+	for (size_t i = 1; i < 10; i++)
+		EXPECT_EQ(v0[i] + v0[i - 1], v[i]);
+
+	v = v0;
+	TStridedVector<double>(v.data() + 2, 4, 2) = TStridedVector<double>(v.data(), 4, 2);
+	for (size_t i = 0; i < 4; i++)
+		EXPECT_EQ(v0[2 * i], v[2 * i + 2]);
+
+	// столбец из первой строки той же матрицы
+	TDynamicMatrix<double> a(4), a0(4);
+	for (size_t i = 0; i < 4; i++)
+		for (size_t j = 0; j < 4; j++)
+			a[i][j] = a0[i][j] = double(i * 4 + j);
+	column(a, 0) = a[0];
+	for (size_t i = 0; i < 4; i++)
+		EXPECT_EQ(a0[0][i], a[i][0]);
+}
+
+TEST(TMatrixView, arithmetic_on_blocks_in_place)
+{
+	TRectMatrix<double> a = rect(8, 8, 1), b = rect(8, 8, 2), a0 = a;
+	TMatrixView<double> t = block(a, 4, 4, 4, 4);
+	t += block(b, 0, 0, 4, 4);
+	t *= 2.0;
+	for (size_t i = 0; i < 8; i++)
+		for (size_t j = 0; j < 8; j++)
+			if (i >= 4 && j >= 4)
+				EXPECT_EQ(2.0 * (a0[i][j] + b[i - 4][j - 4]), a[i][j]);
+			else
+				EXPECT_EQ(a0[i][j], a[i][j]);
+	ASSERT_ANY_THROW(t += block(b, 0, 0, 4, 3));
+}
+
+TEST(TMatrixView, expressions_over_views_give_matrices)
+{
+	TRectMatrix<double> a = rect(10, 7, 1), b = rect(10, 7, 2);
+	TRectMatrix<double> c = block(a, 2, 1, 5, 4) - block(b, 3, 2, 5, 4);
+	TRectMatrix<double> d = (block(a, 2, 1, 5, 4) + 1.0) * 2.0;
+	TRectMatrix<double> e = block(a, 2, 1, 5, 4);
+	for (size_t i = 0; i < 5; i++)
+		for (size_t j = 0; j < 4; j++) {
+			EXPECT_EQ(a[i + 2][j + 1] - b[i + 3][j + 2], c[i][j]);
+			EXPECT_EQ((a[i + 2][j + 1] + 1.0) * 2.0, d[i][j]);
+			EXPECT_EQ(a[i + 2][j + 1], e[i][j]);
+		}
+	EXPECT_TRUE(block(a, 2, 1, 5, 4) == e);
+}
+
+TEST(TMatrixView, products_use_blocks_without_copies)
+{
+	TRectMatrix<double> a = rect(20, 30, 1), b = rect(30, 20, 2);
+	TRectMatrix<double> ab = TRectMatrix<double>(block(a, 5, 10, 6, 8)) * TRectMatrix<double>(block(b, 2, 3, 8, 9));
+	EXPECT_EQ(ab, block(a, 5, 10, 6, 8) * block(b, 2, 3, 8, 9));
+	TDynamicVector<double> x(8);
+	for (size_t i = 0; i < 8; i++)
+		x[i] = double(i) - 3.0;
+	EXPECT_EQ(TRectMatrix<double>(block(a, 5, 10, 6, 8)) * x, block(a, 5, 10, 6, 8) * x);
+}
+
+TEST(TMatrixView, mixes_with_square_matrices)
+{
+	const size_t n = 6;
+	TDynamicMatrix<double> a(n), b(n);
+	for (size_t i = 0; i < n; i++)
+		for (size_t j = 0; j < n; j++) {
+			a[i][j] = double(int((i * 5 + j) % 7) - 3);
+			b[i][j] = double(int((i + j * 3) % 5) - 2);
+		}
+	TRectMatrix<double> ra(a), rb(b);
+	EXPECT_EQ(TRectMatrix<double>(ra + rb), TRectMatrix<double>(a + view(b)));
+	EXPECT_EQ(TRectMatrix<double>(ra - rb), TRectMatrix<double>(view(a) - b));
+	EXPECT_EQ(TRectMatrix<double>(ra + rb + ra), TRectMatrix<double>((a + b) + view(a)));
+	EXPECT_EQ(ra * rb, a * view(b));
+	EXPECT_EQ(ra * rb, view(a) * b);
+	EXPECT_EQ(ra * rb, ra * b);
+	EXPECT_EQ(TRectMatrix<double>(ra * rb * 2.0), (a * 2.0) * rb);
+	EXPECT_TRUE(a == view(a));
+	EXPECT_TRUE(view(b) != a);
+	view(a) = a + view(b);
+	EXPECT_EQ(TDynamicMatrix<double>(ra.dense() + b), a);
+	ASSERT_ANY_THROW(a + block(b, 0, 0, 5, 6));
+	ASSERT_ANY_THROW(a * block(rb, 0, 0, 5, 6));
+	EXPECT_FALSE(a == block(b, 0, 0, 6, 5));
+}
+
+TEST(TMatrixView, blocked_gemm_on_tiles_matches_full_product)
+{
+	const size_t n = 64, t = 16;
+	TDynamicMatrix<double> a(n), b(n), c(n);
+	for (size_t i = 0; i < n; i++)
+		for (size_t j = 0; j < n; j++) {
+			a[i][j] = double(int((i * 5 + j) % 7) - 3);
+			b[i][j] = double(int((i + j * 3) % 5) - 2);
+		}
+	for (size_t i = 0; i < n; i += t)
+		for (size_t j = 0; j < n; j += t)
+			for (size_t k = 0; k < n; k += t)
+				gemm(1.0, block(static_cast<const TDynamicMatrix<double>&>(a), i, k, t, t),
+					block(static_cast<const TDynamicMatrix<double>&>(b), k, j, t, t), 1.0, block(c, i, j, t, t));
+	EXPECT_EQ(a * b, c);
+	ASSERT_ANY_THROW(gemm(1.0, block(c, 0, 0, t, t), block(b, 0, 0, t, t), 0.0, block(c, 8, 8, t, t)));
+}
+
+TEST(TMatrixView, gemv_with_strided_vectors)
+{
+	TRectMatrix<double> a = rect(6, 5, 1), xs = rect(5, 3, 2), ys = rect(6, 4, 3), y0 = ys;
+	gemv(2.0, view(a), column(xs, 1), 1.0, column(ys, 3));
+	TDynamicVector<double> x(5);
+	for (size_t i = 0; i < 5; i++)
+		x[i] = xs[i][1];
+	TDynamicVector<double> y = a * x;
+	for (size_t i = 0; i < 6; i++) {
+		EXPECT_EQ(2.0 * y[i] + y0[i][3], ys[i][3]);
+		EXPECT_EQ(y0[i][0], ys[i][0]);
+	}
+}